@@ -119,6 +119,7 @@ endif()
 check_function_exists("getifaddrs"       HAVE_GETIFADDRS)
 check_function_exists("issetugid"        HAVE_ISSETUGID)
 check_function_exists("mkstemps"         HAVE_MKSTEMPS)
+check_function_exists("posix_fadvise"    HAVE_POSIX_FADVISE)
 check_function_exists("setresgid"        HAVE_SETRESGID)
 check_function_exists("setresuid"        HAVE_SETRESUID)
 check_function_exists("strptime"         HAVE_STRPTIME)
@@ -135,6 +136,8 @@ check_struct_has_member("struct sockaddr" sa_len         sys/socket.h HAVE_STRUC
 check_struct_has_member("struct stat"     st_flags       sys/stat.h   HAVE_STRUCT_STAT_ST_FLAGS)
 check_struct_has_member("struct stat"     st_birthtime   sys/stat.h   HAVE_STRUCT_STAT_ST_BIRTHTIME)
 check_struct_has_member("struct stat"     __st_birthtime sys/stat.h   HAVE_STRUCT_STAT___ST_BIRTHTIME)
+check_struct_has_member("struct stat"     st_mtim        sys/stat.h   HAVE_STRUCT_STAT_ST_MTIM)
+check_struct_has_member("struct stat"     st_mtimespec   sys/stat.h   HAVE_STRUCT_STAT_ST_MTIMESPEC)
 check_struct_has_member("struct tm"       tm_zone        time.h       HAVE_STRUCT_TM_TM_ZONE)
 
 #Symbols but NOT enums or types
@@ -50,6 +50,7 @@ typedef struct _capture_session {
 #endif
     gboolean  session_started;
     guint32   count;                      /**< Total number of frames captured */
+    int       count_pending;              /**< Frames the child has written that we haven't read yet */
     capture_options *capture_opts;        /**< options for this capture */
     capture_file *cf;                     /**< handle to cfile */
     struct _info_data *cap_data_info;          /**< stats for this capture */
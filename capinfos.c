@@ -59,6 +59,7 @@
 
 #include <wiretap/wtap.h>
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/crash_info.h>
 #include <wsutil/filesystem.h>
@@ -89,6 +90,8 @@
 #define INVALID_OPTION 1
 #define BAD_FLAG 1
 
+#define LONGOPT_OPEN_STATS 0x10000
+
 /*
  * By default capinfos now continues processing
  * the next filename if and when wiretap detects
@@ -155,10 +158,8 @@ static gboolean cap_file_hashes    = TRUE;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static gchar file_sha256[HASH_STR_SIZE];
-static gchar file_rmd160[HASH_STR_SIZE];
-static gchar file_sha1[HASH_STR_SIZE];
+static int num_threads = 1;               /* Files processed concurrently */
+static gboolean report_open_stats = FALSE; /* Report time spent in file readers */
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -212,8 +213,70 @@ typedef struct _capture_info {
   GArray        *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
   guint32        pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
   GArray        *idb_info_strings;       /* array of IDB info strings */
+
+  gchar          file_sha256[HASH_STR_SIZE];
+  gchar          file_rmd160[HASH_STR_SIZE];
+  gchar          file_sha1[HASH_STR_SIZE];
 } capture_info;
 
+/*
+ * One input file.  Files are handed out to the worker threads in command
+ * line order and reported by the main thread in the same order.
+ */
+typedef struct _capinfos_job {
+  const char    *filename;
+  capture_info   cf_info;
+  gboolean       opened;                 /* wtap_open_offline() succeeded */
+  gboolean       have_info;              /* cf_info is filled in and must be reported */
+  int            status;                 /* process_cap_file() result */
+  gboolean       done;
+  GString       *diagnostics;            /* error messages, printed when the job is reported */
+
+  /* Filled in by the hash thread while process_cap_file() runs */
+  gchar          file_sha256[HASH_STR_SIZE];
+  gchar          file_rmd160[HASH_STR_SIZE];
+  gchar          file_sha1[HASH_STR_SIZE];
+} capinfos_job;
+
+static capinfos_job *jobs;
+static guint         num_jobs;
+static guint         next_job;
+static gboolean      stop_jobs;
+static GMutex        jobs_mtx;
+static GCond         job_done_cond;
+
+/* The diagnostics of the job the current thread is processing, if any */
+static GPrivate      job_diagnostics = G_PRIVATE_INIT(NULL);
+
+/*
+ * Error messages about a file are kept with its job and printed when the
+ * file is reported, so that they come out in command line order, and not
+ * at all for files after one that stopped processing.
+ */
+static void
+diag_vprintf(const char *msg_format, va_list ap)
+{
+  GString *diagnostics = (GString *)g_private_get(&job_diagnostics);
+
+  if (diagnostics) {
+    g_string_append_vprintf(diagnostics, msg_format, ap);
+  } else {
+    vfprintf(stderr, msg_format, ap);
+  }
+}
+
+static void diag_printf(const char *msg_format, ...) G_GNUC_PRINTF(1, 2);
+
+static void
+diag_printf(const char *msg_format, ...)
+{
+  va_list ap;
+
+  va_start(ap, msg_format);
+  diag_vprintf(msg_format, ap);
+  va_end(ap);
+}
+
 static char *decimal_point;
 
 static void
@@ -687,9 +750,9 @@ print_stats(const gchar *filename, capture_info *cf_info)
     }
   }
   if (cap_file_hashes) {
-    printf     ("SHA256:              %s\n", file_sha256);
-    printf     ("RIPEMD160:           %s\n", file_rmd160);
-    printf     ("SHA1:                %s\n", file_sha1);
+    printf     ("SHA256:              %s\n", cf_info->file_sha256);
+    printf     ("RIPEMD160:           %s\n", cf_info->file_rmd160);
+    printf     ("SHA1:                %s\n", cf_info->file_sha1);
   }
   if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -943,17 +1006,17 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
   if (cap_file_hashes) {
     putsep();
     putquote();
-    printf("%s", file_sha256);
+    printf("%s", cf_info->file_sha256);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_rmd160);
+    printf("%s", cf_info->file_rmd160);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_sha1);
+    printf("%s", cf_info->file_sha1);
     putquote();
   }
 
@@ -1048,8 +1111,14 @@ cleanup_capture_info(capture_info *cf_info)
   cf_info->idb_info_strings = NULL;
 }
 
+/*
+ * Gather the infos for one file into cf_info.  *have_info is set if
+ * cf_info was filled in, in which case the caller reports it and calls
+ * cleanup_capture_info().
+ */
 static int
-process_cap_file(wtap *wth, const char *filename)
+process_cap_file(wtap *wth, const char *filename, capture_info *cf_info_p,
+                 gboolean *have_info)
 {
   int                   status = 0;
   int                   err;
@@ -1078,6 +1147,8 @@ process_cap_file(wtap *wth, const char *filename)
   g_assert(wth != NULL);
   g_assert(filename != NULL);
 
+  *have_info = FALSE;
+
   nstime_set_zero(&start_time);
   start_time_tsprec = WTAP_TSPREC_UNKNOWN;
   nstime_set_zero(&stop_time);
@@ -1150,7 +1221,7 @@ process_cap_file(wtap *wth, const char *filename)
           (rec->rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
         cf_info.encap_counts[rec->rec_header.packet_header.pkt_encap] += 1;
       } else {
-        fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
+        diag_printf("capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                 rec->rec_header.packet_header.pkt_encap, packet, filename);
       }
 
@@ -1212,14 +1283,14 @@ process_cap_file(wtap *wth, const char *filename)
   idb_info = NULL;
 
   if (err != 0) {
-    fprintf(stderr,
+    diag_printf(
         "capinfos: An error occurred after reading %u packets from \"%s\".\n",
         packet, filename);
     cfile_read_failure_message("capinfos", filename, err, err_info);
     if (err == WTAP_ERR_SHORT_READ) {
         /* Don't give up completely with this one. */
         status = 1;
-        fprintf(stderr,
+        diag_printf(
           "  (will continue anyway, checksums might be incorrect)\n");
     } else {
         cleanup_capture_info(&cf_info);
@@ -1230,7 +1301,7 @@ process_cap_file(wtap *wth, const char *filename)
   /* File size */
   size = wtap_file_size(wth, &err);
   if (size == -1) {
-    fprintf(stderr,
+    diag_printf(
         "capinfos: Can't get size of \"%s\": %s.\n",
         filename, g_strerror(err));
     cleanup_capture_info(&cf_info);
@@ -1292,17 +1363,36 @@ process_cap_file(wtap *wth, const char *filename)
     cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
   }
 
-  if (long_report) {
-    print_stats(filename, &cf_info);
-  } else {
-    print_stats_table(filename, &cf_info);
-  }
-
-  cleanup_capture_info(&cf_info);
+  *cf_info_p = cf_info;
+  *have_info = TRUE;
 
   return status;
 }
 
+/*
+ * Report, for each file reader that was tried, how often it was called
+ * and how long it took, so that slow opens can be tracked down.
+ */
+static void
+print_open_routine_stats(void)
+{
+  GArray *stats_arr = wtap_get_open_routine_stats();
+  guint i;
+
+  fprintf(stderr, "%-40s %8s %8s %8s %10s\n",
+          "File reader", "Tried", "Matched", "Skipped", "Time (ms)");
+  for (i = 0; i < stats_arr->len; i++) {
+    wtap_open_routine_stats_t *stats = &g_array_index(stats_arr, wtap_open_routine_stats_t, i);
+
+    if (stats->attempts == 0 && stats->skipped == 0)
+      continue;
+    fprintf(stderr, "%-40s %8u %8u %8u %10.3f\n",
+            stats->name, stats->attempts, stats->matches, stats->skipped,
+            stats->usecs / 1000.0);
+  }
+  g_array_free(stats_arr, TRUE);
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1356,8 +1446,13 @@ print_usage(FILE *output)
   fprintf(output, "Miscellaneous:\n");
   fprintf(output, "  -h display this help and exit\n");
   fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+  fprintf(output, "  -j <threads> process up to <threads> files at once; infos are still\n");
+  fprintf(output, "     reported in command line order (default is 1)\n");
   fprintf(output, "  -A generate all infos (default)\n");
   fprintf(output, "  -K disable displaying the capture comment\n");
+  fprintf(output, "  --open-stats\n");
+  fprintf(output, "     report how often each file reader was tried and the time\n");
+  fprintf(output, "     spent in it to the standard error\n");
   fprintf(output, "\n");
   fprintf(output, "Options are processed from left to right order with later options superceding\n");
   fprintf(output, "or adding to earlier options.\n");
@@ -1373,9 +1468,9 @@ print_usage(FILE *output)
 static void
 failure_warning_message(const char *msg_format, va_list ap)
 {
-  fprintf(stderr, "capinfos: ");
-  vfprintf(stderr, msg_format, ap);
-  fprintf(stderr, "\n");
+  diag_printf("capinfos: ");
+  diag_vprintf(msg_format, ap);
+  diag_printf("\n");
 }
 
 /*
@@ -1384,8 +1479,8 @@ failure_warning_message(const char *msg_format, va_list ap)
 static void
 failure_message_cont(const char *msg_format, va_list ap)
 {
-  vfprintf(stderr, msg_format, ap);
-  fprintf(stderr, "\n");
+  diag_vprintf(msg_format, ap);
+  diag_printf("\n");
 }
 
 static void
@@ -1397,28 +1492,145 @@ hash_to_str(const unsigned char *hash, size_t length, char *str) {
   }
 }
 
+/*
+ * Hash the raw file.  This runs alongside process_cap_file(), so both
+ * sequential readers share one trip through the file rather than the
+ * hash making a second pass over it afterwards.
+ */
+static gpointer
+hash_file_thread(gpointer data)
+{
+  capinfos_job *job = (capinfos_job *)data;
+  FILE         *fh;
+  char         *hash_buf;
+  gcry_md_hd_t  hd = NULL;
+  size_t        hash_bytes;
+
+  fh = ws_fopen(job->filename, "rb");
+  if (fh == NULL)
+    return NULL;
+
+  gcry_md_open(&hd, GCRY_MD_SHA256, 0);
+  if (hd) {
+    gcry_md_enable(hd, GCRY_MD_RMD160);
+    gcry_md_enable(hd, GCRY_MD_SHA1);
+    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
+    while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
+      gcry_md_write(hd, hash_buf, hash_bytes);
+    }
+    gcry_md_final(hd);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, job->file_sha256);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, job->file_rmd160);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, job->file_sha1);
+    g_free(hash_buf);
+    gcry_md_close(hd);
+  }
+  fclose(fh);
+  return NULL;
+}
+
+static void
+process_job(capinfos_job *job)
+{
+  GThread *hash_thread = NULL;
+  wtap    *wth;
+  int      err;
+  gchar   *err_info;
+
+  g_strlcpy(job->file_sha256, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(job->file_rmd160, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(job->file_sha1, "<unknown>", HASH_STR_SIZE);
+
+  job->diagnostics = g_string_new("");
+  g_private_set(&job_diagnostics, job->diagnostics);
+
+  if (cap_file_hashes) {
+    hash_thread = g_thread_new("capinfos hash", hash_file_thread, job);
+  }
+
+  wth = wtap_open_offline(job->filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+
+  if (!wth) {
+    cfile_open_failure_message("capinfos", job->filename, err, err_info);
+  } else {
+    job->opened = TRUE;
+    /* None of the infos need the packet data itself */
+    wtap_set_skip_packet_data(wth, TRUE);
+    job->status = process_cap_file(wth, job->filename, &job->cf_info, &job->have_info);
+    wtap_close(wth);
+  }
+
+  if (hash_thread) {
+    g_thread_join(hash_thread);
+  }
+  g_strlcpy(job->cf_info.file_sha256, job->file_sha256, HASH_STR_SIZE);
+  g_strlcpy(job->cf_info.file_rmd160, job->file_rmd160, HASH_STR_SIZE);
+  g_strlcpy(job->cf_info.file_sha1, job->file_sha1, HASH_STR_SIZE);
+
+  g_private_set(&job_diagnostics, NULL);
+}
+
+static gpointer
+capinfos_worker(gpointer data _U_)
+{
+  capinfos_job *job;
+
+  for (;;) {
+    g_mutex_lock(&jobs_mtx);
+    if (stop_jobs || next_job >= num_jobs) {
+      g_mutex_unlock(&jobs_mtx);
+      return NULL;
+    }
+    job = &jobs[next_job++];
+    g_mutex_unlock(&jobs_mtx);
+
+    process_job(job);
+
+    g_mutex_lock(&jobs_mtx);
+    job->done = TRUE;
+    g_cond_broadcast(&job_done_cond);
+    g_mutex_unlock(&jobs_mtx);
+  }
+}
+
+/*
+ * Wait for a file's infos.  Without worker threads the file is processed
+ * here; with them, the main thread only reports, in command line order.
+ */
+static void
+wait_for_job(capinfos_job *job, gboolean threaded)
+{
+  if (!threaded) {
+    process_job(job);
+    job->done = TRUE;
+    return;
+  }
+
+  g_mutex_lock(&jobs_mtx);
+  while (!job->done) {
+    g_cond_wait(&job_done_cond, &jobs_mtx);
+  }
+  g_mutex_unlock(&jobs_mtx);
+}
+
 int
 main(int argc, char *argv[])
 {
   GString *comp_info_str;
   GString *runtime_info_str;
   char  *init_progfile_dir_error;
-  wtap  *wth;
-  int    err;
-  gchar *err_info;
   int    opt;
   int    overall_error_status = EXIT_SUCCESS;
   static const struct option long_options[] = {
       {"help", no_argument, NULL, 'h'},
       {"version", no_argument, NULL, 'v'},
+      {"open-stats", no_argument, NULL, LONGOPT_OPEN_STATS},
       {0, 0, 0, 0 }
   };
 
-  int status = 0;
-  FILE  *fh;
-  char  *hash_buf = NULL;
-  gcry_md_hd_t hd = NULL;
-  size_t hash_bytes;
+  GThread **threads = NULL;
+  int        n_threads = 0;
+  guint      i;
 
   /* Set the C-language locale to the native environment. */
   setlocale(LC_ALL, "");
@@ -1472,7 +1684,7 @@ main(int argc, char *argv[])
   wtap_init(TRUE);
 
   /* Process the options */
-  while ((opt = getopt_long(argc, argv, "abcdehiklmoqrstuvxyzABCEFHIKLMNQRST", long_options, NULL)) !=-1) {
+  while ((opt = getopt_long(argc, argv, "abcdehij:klmoqrstuvxyzABCEFHIKLMNQRST", long_options, NULL)) !=-1) {
 
     switch (opt) {
 
@@ -1578,6 +1790,14 @@ main(int argc, char *argv[])
         continue_after_wtap_open_offline_failure = FALSE;
         break;
 
+      case 'j':
+        num_threads = get_positive_int(optarg, "number of threads");
+        break;
+
+      case LONGOPT_OPEN_STATS:
+        report_open_stats = TRUE;
+        break;
+
       case 'A':
         enable_all_infos();
         break;
@@ -1664,62 +1884,79 @@ main(int argc, char *argv[])
 
   if (cap_file_hashes) {
     gcry_check_version(NULL);
-    gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-    if (hd) {
-      gcry_md_enable(hd, GCRY_MD_RMD160);
-      gcry_md_enable(hd, GCRY_MD_SHA1);
-    }
-    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
   }
 
   overall_error_status = 0;
 
-  for (opt = optind; opt < argc; opt++) {
-
-    g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_rmd160, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+  num_jobs = argc - optind;
+  jobs = g_new0(capinfos_job, num_jobs);
+  for (i = 0; i < num_jobs; i++) {
+    jobs[i].filename = argv[optind + i];
+  }
 
-    if (cap_file_hashes) {
-      fh = ws_fopen(argv[opt], "rb");
-      if (fh && hd) {
-        while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-          gcry_md_write(hd, hash_buf, hash_bytes);
-        }
-        gcry_md_final(hd);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, file_rmd160);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
-      }
-      if (fh) fclose(fh);
-      if (hd) gcry_md_reset(hd);
+  if (num_threads > 1 && num_jobs > 1) {
+    n_threads = MIN((guint)num_threads, num_jobs);
+    threads = g_new(GThread *, n_threads);
+    for (opt = 0; opt < n_threads; opt++) {
+      threads[opt] = g_thread_new("capinfos worker", capinfos_worker, NULL);
     }
+  }
+
+  for (i = 0; i < num_jobs; i++) {
+    capinfos_job *job = &jobs[i];
+
+    wait_for_job(job, threads != NULL);
 
-    wth = wtap_open_offline(argv[opt], WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+    fputs(job->diagnostics->str, stderr);
+    g_string_free(job->diagnostics, TRUE);
+    job->diagnostics = NULL;
 
-    if (!wth) {
-      cfile_open_failure_message("capinfos", argv[opt], err, err_info);
+    if (!job->opened) {
       overall_error_status = 2; /* remember that an error has occurred */
       if (!continue_after_wtap_open_offline_failure)
         goto exit;
+      continue;
     }
 
-    if (wth) {
-      if ((opt > optind) && (long_report))
-        printf("\n");
-      status = process_cap_file(wth, argv[opt]);
-
-      wtap_close(wth);
-      if (status) {
-        overall_error_status = status;
-        goto exit;
+    if ((i > 0) && (long_report))
+      printf("\n");
+    if (job->have_info) {
+      if (long_report) {
+        print_stats(job->filename, &job->cf_info);
+      } else {
+        print_stats_table(job->filename, &job->cf_info);
       }
+      cleanup_capture_info(&job->cf_info);
+      job->have_info = FALSE;
+    }
+
+    if (job->status) {
+      overall_error_status = job->status;
+      goto exit;
     }
   }
 
+  if (report_open_stats)
+    print_open_routine_stats();
+
 exit:
-  g_free(hash_buf);
-  gcry_md_close(hd);
+  if (threads) {
+    g_mutex_lock(&jobs_mtx);
+    stop_jobs = TRUE;
+    g_mutex_unlock(&jobs_mtx);
+    for (opt = 0; opt < n_threads; opt++) {
+      g_thread_join(threads[opt]);
+    }
+    g_free(threads);
+  }
+  for (i = 0; i < num_jobs; i++) {
+    if (jobs[i].have_info)
+      cleanup_capture_info(&jobs[i].cf_info);
+    /* Diagnostics of files after the one we stopped at are dropped */
+    if (jobs[i].diagnostics)
+      g_string_free(jobs[i].diagnostics, TRUE);
+  }
+  g_free(jobs);
   wtap_cleanup();
   free_progdirs();
   return overall_error_status;
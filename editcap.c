@@ -76,6 +76,7 @@
 #include <wsutil/pint.h>
 #include <wsutil/strtoi.h>
 #include <wiretap/wtap_opttypes.h>
+#include <wiretap/wtap_index.h>
 #include <wiretap/pcapng.h>
 
 #include "ui/failure_message.h"
@@ -88,6 +89,8 @@
 #define WRITE_ERROR 2
 #define DUMP_ERROR 2
 
+#define LONGOPT_THREADS 0x10000
+
 /*
  * Some globals so we can pass things to various routines
  */
@@ -173,6 +176,8 @@ static int                    do_strict_time_adjustment = FALSE;
 static struct time_adjustment strict_time_adj           = {NSTIME_INIT_ZERO, 0}; /* strict time adjustment */
 static nstime_t               previous_time             = NSTIME_INIT_ZERO; /* previous time */
 
+static guint32                split_threads             = 1;  /* output files to write at once */
+
 static int find_dct2000_real_data(guint8 *buf);
 static void handle_chopping(chop_t chop, wtap_packet_header *out_phdr,
                             const wtap_packet_header *in_phdr, guint8 **buf,
@@ -573,6 +578,85 @@ remove_vlan_info(const wtap_packet_header *phdr, guint8* fd, guint32* len) {
     }
 }
 
+/*
+ * Apply the -t time adjustment to a record with a time stamp.
+ * Copy and change rather than modify the record we're handed.
+ */
+static const wtap_rec *
+adjust_time(const wtap_rec *rec, wtap_rec *temp_rec)
+{
+    if (time_adj.tv.secs != 0) {
+        *temp_rec = *rec;
+        if (time_adj.is_negative)
+            temp_rec->ts.secs -= time_adj.tv.secs;
+        else
+            temp_rec->ts.secs += time_adj.tv.secs;
+        rec = temp_rec;
+    }
+
+    if (time_adj.tv.nsecs != 0) {
+        *temp_rec = *rec;
+        if (time_adj.is_negative) { /* subtract */
+            if (temp_rec->ts.nsecs < time_adj.tv.nsecs) { /* borrow */
+                temp_rec->ts.secs--;
+                temp_rec->ts.nsecs += ONE_BILLION;
+            }
+            temp_rec->ts.nsecs -= time_adj.tv.nsecs;
+        } else {                  /* add */
+            if (temp_rec->ts.nsecs + time_adj.tv.nsecs >= ONE_BILLION) {
+                /* carry */
+                temp_rec->ts.secs++;
+                temp_rec->ts.nsecs += time_adj.tv.nsecs - ONE_BILLION;
+            } else {
+                temp_rec->ts.nsecs += time_adj.tv.nsecs;
+            }
+        }
+        rec = temp_rec;
+    }
+    return rec;
+}
+
+/*
+ * Apply -s, -L, -C and --novlan to a packet record.  Copy and change
+ * rather than modify the record we're handed; the packet data is
+ * modified in place.
+ */
+static const wtap_rec *
+manipulate_packet(const wtap_rec *rec, wtap_rec *temp_rec, guint8 **buf,
+                  guint32 snaplen, chop_t chop, gboolean adjlen)
+{
+    if (snaplen != 0) {
+        /* Limit capture length to snaplen */
+        if (rec->rec_header.packet_header.caplen > snaplen) {
+            *temp_rec = *rec;
+            temp_rec->rec_header.packet_header.caplen = snaplen;
+            rec = temp_rec;
+        }
+        /* If -L, also set reported length to snaplen */
+        if (adjlen && rec->rec_header.packet_header.len > snaplen) {
+            *temp_rec = *rec;
+            temp_rec->rec_header.packet_header.len = snaplen;
+            rec = temp_rec;
+        }
+    }
+
+    /* CHOP */
+    *temp_rec = *rec;
+    handle_chopping(chop, &temp_rec->rec_header.packet_header,
+                    &rec->rec_header.packet_header, buf,
+                    adjlen);
+    rec = temp_rec;
+
+    /* remove vlan info */
+    if (rem_vlan) {
+        *temp_rec = *rec;
+        remove_vlan_info(&rec->rec_header.packet_header, *buf,
+                         &temp_rec->rec_header.packet_header.caplen);
+        rec = temp_rec;
+    }
+    return rec;
+}
+
 static gboolean
 is_duplicate(guint8* fd, guint32 len) {
     int i;
@@ -802,6 +886,9 @@ print_usage(FILE *output)
     fprintf(output, "  -i <seconds per file>  split the packet output to different files based on\n");
     fprintf(output, "                         uniform time intervals with a maximum of\n");
     fprintf(output, "                         <seconds per file> each.\n");
+    fprintf(output, "  --threads <threads>    when splitting with -c or -i, write up to <threads>\n");
+    fprintf(output, "                         output files at once, if the input file has an\n");
+    fprintf(output, "                         up-to-date packet index.\n");
     fprintf(output, "  -F <capture type>      set the output file type; default is pcapng. An empty\n");
     fprintf(output, "                         \"-F\" option will list the file types.\n");
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
@@ -938,6 +1025,259 @@ editcap_dump_open(const char *filename, guint32 snaplen,
   return pdh;
 }
 
+/*
+ * Splitting with -c or -i, using a packet index to work out which
+ * records go into which output file without reading the capture file,
+ * and then writing the output files in parallel, each worker reading
+ * its own range of the capture file.
+ *
+ * This is only done if nothing that is done to a packet depends on the
+ * packets before it, so that the output is the same as a sequential
+ * run would produce.
+ */
+typedef struct {
+    gchar   *filename;
+    guint32  first;     /* index of the first record for this file */
+    guint32  end;       /* index of the record after the last one */
+} split_job_t;
+
+typedef enum {
+    SPLIT_OK,
+    SPLIT_OPEN_FAILED,
+    SPLIT_READ_FAILED,
+    SPLIT_DUMP_OPEN_FAILED,
+    SPLIT_WRITE_FAILED,
+    SPLIT_CLOSE_FAILED
+} split_failure_t;
+
+typedef struct {
+    const char                  *in_filename;
+    wtap_index_t                *idx;
+    GArray                      *jobs;
+    volatile gint                next_job;
+    volatile gint                failed;
+    guint32                      dump_snaplen;
+    guint32                      snaplen;
+    chop_t                       chop;
+    gboolean                     adjlen;
+    GArray                      *shb_hdrs;
+    wtapng_iface_descriptions_t *idb_inf;
+    GArray                      *nrb_hdrs;
+
+    /* The first failure, reported once all the workers are done */
+    GMutex                       failure_mtx;
+    split_failure_t              failure;
+    int                          err;
+    gchar                       *err_info;
+    const char                  *failed_filename;
+    guint32                      failed_record;
+} split_state_t;
+
+static GArray *
+split_get_jobs(wtap_index_t *idx, guint32 split_packet_count,
+               guint32 secs_per_block, gchar *fprefix, gchar *fsuffix)
+{
+    GArray *jobs = g_array_new(FALSE, FALSE, sizeof (split_job_t));
+    guint32 num_records = wtap_index_get_num_records(idx);
+    const wtap_index_entry_t *first_entry = wtap_index_get_entry(idx, 0);
+    split_job_t job;
+    wtap_rec rec;
+    nstime_t block_end;
+
+    job.first = 0;
+    while (job.first < num_records) {
+        if (split_packet_count != 0) {
+            job.end = num_records - job.first > split_packet_count ?
+                job.first + split_packet_count : num_records;
+        } else {
+            /*
+             * As in a sequential run, each file covers secs_per_block
+             * seconds from the time stamp of the first packet, and
+             * there's a file for every interval, even if it's empty.
+             */
+            block_end.secs = (time_t)(first_entry->secs +
+                (gint64)(jobs->len + 1) * secs_per_block);
+            block_end.nsecs = first_entry->nsecs;
+            job.end = wtap_index_find_time(idx, &block_end);
+        }
+
+        /* The file is named after the packet that would have opened it. */
+        wtap_index_get_rec(idx, job.first, &rec);
+        job.filename = fileset_get_filename_by_pattern(jobs->len, &rec,
+                                                       fprefix, fsuffix);
+        g_array_append_val(jobs, job);
+        job.first = job.end;
+    }
+    return jobs;
+}
+
+static void
+split_set_failure(split_state_t *state, split_failure_t failure,
+                  const split_job_t *job, int err, gchar *err_info,
+                  guint32 record)
+{
+    g_mutex_lock(&state->failure_mtx);
+    if (state->failure == SPLIT_OK) {
+        state->failure = failure;
+        state->err = err;
+        state->err_info = err_info;
+        state->failed_filename = job->filename;
+        state->failed_record = record;
+    } else {
+        g_free(err_info);
+    }
+    g_mutex_unlock(&state->failure_mtx);
+    g_atomic_int_set(&state->failed, 1);
+}
+
+static void
+split_write_file(split_state_t *state, const split_job_t *job)
+{
+    wtap         *wth;
+    wtap_dumper  *pdh;
+    wtap_chunk_t  chunk;
+    const wtap_rec *rec;
+    wtap_rec      temp_rec;
+    guint8       *buf;
+    gint64        data_offset;
+    guint32       record;
+    int           read_err = 0, write_err;
+    gchar        *read_err_info = NULL, *write_err_info = NULL;
+
+    pdh = editcap_dump_open(job->filename, state->dump_snaplen,
+                            state->shb_hdrs, state->idb_inf, state->nrb_hdrs,
+                            &write_err);
+    if (pdh == NULL) {
+        split_set_failure(state, SPLIT_DUMP_OPEN_FAILED, job, write_err,
+                          NULL, 0);
+        return;
+    }
+
+    if (job->first < job->end) {
+        chunk.start = (gint64)wtap_index_get_entry(state->idx, job->first)->offset;
+        if (job->end < wtap_index_get_num_records(state->idx))
+            chunk.end = (gint64)wtap_index_get_entry(state->idx, job->end)->offset;
+        else
+            chunk.end = G_MAXINT64;   /* the index runs to the end of the file */
+
+        wth = wtap_open_chunk(state->in_filename, WTAP_TYPE_AUTO, &chunk,
+                              &read_err, &read_err_info);
+        if (wth == NULL) {
+            split_set_failure(state, SPLIT_OPEN_FAILED, job, read_err,
+                              read_err_info, 0);
+            wtap_dump_close(pdh, &write_err);
+            return;
+        }
+
+        for (record = job->first; record < job->end; record++) {
+            if (!wtap_read(wth, &read_err, &read_err_info, &data_offset)) {
+                split_set_failure(state, SPLIT_READ_FAILED, job, read_err,
+                                  read_err_info, record + 1);
+                break;
+            }
+            rec = wtap_get_rec(wth);
+            buf = wtap_get_buf_ptr(wth);
+
+            if (rec->presence_flags & WTAP_HAS_TS)
+                rec = adjust_time(rec, &temp_rec);
+            if (rec->rec_type == REC_TYPE_PACKET)
+                rec = manipulate_packet(rec, &temp_rec, &buf, state->snaplen,
+                                        state->chop, state->adjlen);
+
+            if (!wtap_dump(pdh, rec, buf, &write_err, &write_err_info)) {
+                split_set_failure(state, SPLIT_WRITE_FAILED, job, write_err,
+                                  write_err_info, record + 1);
+                break;
+            }
+        }
+        wtap_close(wth);
+    }
+
+    if (!wtap_dump_close(pdh, &write_err))
+        split_set_failure(state, SPLIT_CLOSE_FAILED, job, write_err, NULL, 0);
+}
+
+static gpointer
+split_worker(gpointer data)
+{
+    split_state_t *state = (split_state_t *)data;
+    guint job;
+
+    while (!g_atomic_int_get(&state->failed)) {
+        job = (guint)g_atomic_int_add(&state->next_job, 1);
+        if (job >= state->jobs->len)
+            break;
+        split_write_file(state, &g_array_index(state->jobs, split_job_t, job));
+    }
+    return NULL;
+}
+
+/*
+ * Returns EXIT_SUCCESS or one of the editcap exit statuses, having
+ * reported any failure.
+ */
+static int
+split_in_parallel(split_state_t *state, guint num_threads)
+{
+    GThread **threads;
+    guint     i;
+    int       ret = EXIT_SUCCESS;
+
+    if (num_threads > state->jobs->len)
+        num_threads = state->jobs->len;
+    if (verbose)
+        fprintf(stderr, "Writing %u files with %u threads\n",
+                state->jobs->len, num_threads);
+
+    g_mutex_init(&state->failure_mtx);
+    threads = g_new(GThread *, num_threads);
+    for (i = 0; i < num_threads; i++)
+        threads[i] = g_thread_new("editcap split", split_worker, state);
+    for (i = 0; i < num_threads; i++)
+        g_thread_join(threads[i]);
+    g_free(threads);
+    g_mutex_clear(&state->failure_mtx);
+
+    switch (state->failure) {
+
+    case SPLIT_OK:
+        break;
+
+    case SPLIT_OPEN_FAILED:
+        cfile_open_failure_message("editcap", state->in_filename,
+                                   state->err, state->err_info);
+        ret = INVALID_FILE;
+        break;
+
+    case SPLIT_READ_FAILED:
+        /* As in a sequential run, a read error isn't fatal. */
+        cfile_read_failure_message("editcap", state->in_filename,
+                                   state->err, state->err_info);
+        break;
+
+    case SPLIT_DUMP_OPEN_FAILED:
+        cfile_dump_open_failure_message("editcap", state->failed_filename,
+                                        state->err, out_file_type_subtype);
+        ret = INVALID_FILE;
+        break;
+
+    case SPLIT_WRITE_FAILED:
+        cfile_write_failure_message("editcap", state->in_filename,
+                                    state->failed_filename,
+                                    state->err, state->err_info,
+                                    state->failed_record,
+                                    out_file_type_subtype);
+        ret = DUMP_ERROR;
+        break;
+
+    case SPLIT_CLOSE_FAILED:
+        cfile_close_failure_message(state->failed_filename, state->err);
+        ret = WRITE_ERROR;
+        break;
+    }
+    return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -945,11 +1285,14 @@ main(int argc, char *argv[])
     GString      *runtime_info_str;
     char         *init_progfile_dir_error;
     wtap         *wth = NULL;
+    wtap         *rth = NULL;   /* what we read from; wth, or a range of it */
+    wtap_index_t *idx = NULL;
     int           i, j, read_err, write_err;
     gchar        *read_err_info, *write_err_info;
     int           opt;
     static const struct option long_options[] = {
         {"novlan", no_argument, NULL, 0x8100},
+        {"threads", required_argument, NULL, LONGOPT_THREADS},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'V'},
         {0, 0, 0, 0 }
@@ -1041,6 +1384,10 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_THREADS:
+            split_threads = get_nonzero_guint32(optarg, "number of threads");
+            break;
+
         case 'a':
         {
             guint frame_number;
@@ -1339,6 +1686,15 @@ main(int argc, char *argv[])
         fprintf(stderr, "File %s is a %s capture file.\n", argv[optind],
                 wtap_file_type_subtype_string(wtap_file_type_subtype(wth)));
     }
+    rth = wth;
+
+    /*
+     * If there's an up-to-date packet index for the file, we may be
+     * able to use it to find the packets we want without reading the
+     * whole file.
+     */
+    if (check_startstop || split_packet_count != 0 || secs_per_block != 0)
+        idx = wtap_index_open(wth, argv[optind]);
 
     shb_hdrs = wtap_file_get_shb_for_new_file(wth);
     idb_inf = wtap_file_get_idb_info(wth);
@@ -1368,17 +1724,113 @@ main(int argc, char *argv[])
             }
         }
 
+        /*
+         * If we're splitting, and every packet will be written, and
+         * written unchanged apart from things that don't depend on the
+         * packets before it, the index tells us which packets go into
+         * which file, and we can write the files in parallel.
+         */
+        if (idx != NULL && split_threads > 1 &&
+            wtap_index_get_num_records(idx) != 0 &&
+            (split_packet_count != 0 ||
+             (secs_per_block != 0 && wtap_index_is_time_ordered(idx))) &&
+            !check_startstop && max_selected == 0 && !keep_em &&
+            !dup_detect && !dup_detect_by_time &&
+            !do_strict_time_adjustment && err_prob == 0.0 &&
+            frames_user_comments == NULL &&
+            strcmp(argv[optind+1], "-") != 0) {
+            split_state_t split_state;
+
+            if (!fileset_extract_prefix_suffix(argv[optind+1], &fprefix, &fsuffix)) {
+                ret = CANT_EXTRACT_PREFIX;
+                goto clean_exit;
+            }
+
+            /* If we don't have an application name add Editcap */
+            if (wtap_block_get_string_option_value(g_array_index(shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, &shb_user_appl) != WTAP_OPTTYPE_SUCCESS) {
+                wtap_block_add_string_option_format(g_array_index(shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, "Editcap " VERSION);
+            }
+
+            memset(&split_state, 0, sizeof split_state);
+            split_state.in_filename = argv[optind];
+            split_state.idx = idx;
+            split_state.jobs = split_get_jobs(idx, split_packet_count,
+                                              secs_per_block, fprefix, fsuffix);
+            split_state.dump_snaplen = snaplen ? MIN(snaplen, wtap_snapshot_length(wth)) : wtap_snapshot_length(wth);
+            split_state.snaplen = snaplen;
+            split_state.chop = chop;
+            split_state.adjlen = adjlen;
+            split_state.shb_hdrs = shb_hdrs;
+            split_state.idb_inf = idb_inf;
+            split_state.nrb_hdrs = nrb_hdrs;
+
+            ret = split_in_parallel(&split_state, split_threads);
+
+            for (i = 0; i < (int)split_state.jobs->len; i++)
+                g_free(g_array_index(split_state.jobs, split_job_t, i).filename);
+            g_array_free(split_state.jobs, TRUE);
+            g_free(fprefix);
+            g_free(fsuffix);
+            goto clean_exit;
+        }
+
+        /*
+         * If we're only selecting a time range, and the index says the
+         * packets are in time order, find the range with a binary
+         * search, and read only that part of the file.  Packets before
+         * the range could only affect the output through duplicate
+         * detection.
+         */
+        read_err = 0;
+        if (idx != NULL && check_startstop && wtap_index_is_time_ordered(idx) &&
+            split_packet_count == 0 && secs_per_block == 0 &&
+            !dup_detect && !dup_detect_by_time) {
+            nstime_t     range_start, range_stop;
+            guint32      first, end;
+            wtap_chunk_t chunk;
+
+            range_start.secs = starttime;
+            range_start.nsecs = 0;
+            range_stop.secs = stoptime;
+            range_stop.nsecs = 0;
+            first = wtap_index_find_time(idx, &range_start);
+            end = wtap_index_find_time(idx, &range_stop);
+            if (first < end) {
+                chunk.start = (gint64)wtap_index_get_entry(idx, first)->offset;
+                if (end < wtap_index_get_num_records(idx))
+                    chunk.end = (gint64)wtap_index_get_entry(idx, end)->offset;
+                else
+                    chunk.end = G_MAXINT64;   /* the index runs to the end of the file */
+                rth = wtap_open_chunk(argv[optind], WTAP_TYPE_AUTO, &chunk,
+                                      &read_err, &read_err_info);
+                if (rth == NULL) {
+                    cfile_open_failure_message("editcap", argv[optind],
+                                               read_err, read_err_info);
+                    ret = INVALID_FILE;
+                    goto clean_exit;
+                }
+            } else {
+                rth = NULL;     /* no packets in the range */
+            }
+            /* Keep packet numbers the same as in the whole file. */
+            read_count = first;
+            count = first + 1;
+            if (verbose)
+                fprintf(stderr, "Reading packets %u through %u using the index\n",
+                        first + 1, end);
+        }
+
         /* Read all of the packets in turn */
-        while (wtap_read(wth, &read_err, &read_err_info, &data_offset)) {
+        while (rth != NULL && wtap_read(rth, &read_err, &read_err_info, &data_offset)) {
             if (max_packet_number <= read_count)
                 break;
 
             read_count++;
 
-            rec = wtap_get_rec(wth);
+            rec = wtap_get_rec(rth);
 
             /* Extra actions for the first packet */
-            if (read_count == 1) {
+            if (pdh == NULL) {
                 if (split_packet_count != 0 || secs_per_block != 0) {
                     if (!fileset_extract_prefix_suffix(argv[optind+1], &fprefix, &fsuffix)) {
                         ret = CANT_EXTRACT_PREFIX;
@@ -1410,7 +1862,7 @@ main(int argc, char *argv[])
             } /* first packet only handling */
 
 
-            buf = wtap_get_buf_ptr(wth);
+            buf = wtap_get_buf_ptr(rth);
 
             /*
              * Not all packets have time stamps. Only process the time
@@ -1508,7 +1960,7 @@ main(int argc, char *argv[])
                 /* We simply write it, perhaps after truncating it; we could
                  * do other things, like modify it. */
 
-                rec = wtap_get_rec(wth);
+                rec = wtap_get_rec(rth);
 
                 if (rec->presence_flags & WTAP_HAS_TS) {
                     /* Do we adjust timestamps to ensure strict chronological
@@ -1570,74 +2022,12 @@ main(int argc, char *argv[])
                         previous_time = rec->ts;
                     }
 
-                    if (time_adj.tv.secs != 0) {
-                        /* Copy and change rather than modify returned rec */
-                        temp_rec = *rec;
-                        if (time_adj.is_negative)
-                            temp_rec.ts.secs -= time_adj.tv.secs;
-                        else
-                            temp_rec.ts.secs += time_adj.tv.secs;
-                        rec = &temp_rec;
-                    }
-
-                    if (time_adj.tv.nsecs != 0) {
-                        /* Copy and change rather than modify returned rec */
-                        temp_rec = *rec;
-                        if (time_adj.is_negative) { /* subtract */
-                            if (temp_rec.ts.nsecs < time_adj.tv.nsecs) { /* borrow */
-                                temp_rec.ts.secs--;
-                                temp_rec.ts.nsecs += ONE_BILLION;
-                            }
-                            temp_rec.ts.nsecs -= time_adj.tv.nsecs;
-                        } else {                  /* add */
-                            if (temp_rec.ts.nsecs + time_adj.tv.nsecs >= ONE_BILLION) {
-                                /* carry */
-                                temp_rec.ts.secs++;
-                                temp_rec.ts.nsecs += time_adj.tv.nsecs - ONE_BILLION;
-                            } else {
-                                temp_rec.ts.nsecs += time_adj.tv.nsecs;
-                            }
-                        }
-                        rec = &temp_rec;
-                    }
+                    rec = adjust_time(rec, &temp_rec);
                 } /* time stamp adjustment */
 
                 if (rec->rec_type == REC_TYPE_PACKET) {
-                    if (snaplen != 0) {
-                        /* Limit capture length to snaplen */
-                        if (rec->rec_header.packet_header.caplen > snaplen) {
-                            /* Copy and change rather than modify returned wtap_rec */
-                            temp_rec = *rec;
-                            temp_rec.rec_header.packet_header.caplen = snaplen;
-                            rec = &temp_rec;
-                        }
-                        /* If -L, also set reported length to snaplen */
-                        if (adjlen && rec->rec_header.packet_header.len > snaplen) {
-                            /* Copy and change rather than modify returned phdr */
-                            temp_rec = *rec;
-                            temp_rec.rec_header.packet_header.len = snaplen;
-                            rec = &temp_rec;
-                        }
-                    }
-
-                    /*
-                     * CHOP
-                     * Copy and change rather than modify returned phdr.
-                     */
-                    temp_rec = *rec;
-                    handle_chopping(chop, &temp_rec.rec_header.packet_header,
-                                    &rec->rec_header.packet_header, &buf,
-                                    adjlen);
-                    rec = &temp_rec;
-
-                    /* remove vlan info */
-                    if (rem_vlan) {
-                        /* Copy and change rather than modify returned rec */
-                        temp_rec = *rec;
-                        remove_vlan_info(&rec->rec_header.packet_header, buf,
-                                         &temp_rec.rec_header.packet_header.caplen);
-                        rec = &temp_rec;
-                    }
+                    rec = manipulate_packet(rec, &temp_rec, &buf, snaplen,
+                                            chop, adjlen);
 
                     /* suppress duplicates by packet window */
                     if (dup_detect) {
@@ -1875,6 +2265,9 @@ clean_exit:
     wtap_block_array_free(shb_hdrs);
     wtap_block_array_free(nrb_hdrs);
     g_free(idb_inf);
+    wtap_index_close(idx);
+    if (rth != NULL && rth != wth)
+        wtap_close(rth);
     if (wth != NULL)
         wtap_close(wth);
     wtap_cleanup();
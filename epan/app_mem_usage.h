@@ -12,6 +12,10 @@
 
 #include "ws_symbol_export.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
 typedef struct {
 	const char *name;
 	gsize (*fetch)(void);
@@ -25,4 +29,8 @@ WS_DLL_PUBLIC void memory_usage_gc(void);
 
 WS_DLL_PUBLIC const char *memory_usage_get(guint idx, gsize *value);
 
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* APP_MEM_USAGE_H */
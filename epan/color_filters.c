@@ -52,6 +52,10 @@ static gboolean filters_enabled = TRUE;
  */
 static gboolean tmp_colors_set = FALSE;
 
+/* Field values shared by the filters while colorizing a packet, so that
+ * a field used by several filters is read from the tree only once */
+static dfilter_fields_t *color_filter_fields = NULL;
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const gchar *name,          /* The name of the filter to create */
@@ -348,6 +352,9 @@ color_filters_cleanup(void)
 {
     /* delete the previously deleted filters */
     color_filter_list_delete(&color_filter_deleted_list);
+
+    dfilter_fields_free(color_filter_fields);
+    color_filter_fields = NULL;
 }
 
 typedef struct _color_clone
@@ -495,23 +502,30 @@ color_filters_colorize_packet(epan_dissect_t *edt)
 {
     GSList         *curr;
     color_filter_t *colorf;
+    color_filter_t *match = NULL;
 
     /* If we have color filters, "search" for the matching one. */
     if ((edt->tree != NULL) && (color_filters_used())) {
+        if (color_filter_fields == NULL)
+            color_filter_fields = dfilter_fields_new();
+
         curr = color_filter_list;
 
         while(curr != NULL) {
             colorf = (color_filter_t *)curr->data;
             if ( (!colorf->disabled) &&
                  (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
+                 dfilter_apply_edt_with_fields(colorf->c_colorfilter, edt, color_filter_fields)) {
+                match = colorf;
+                break;
             }
             curr = g_slist_next(curr);
         }
+
+        dfilter_fields_reset(color_filter_fields);
     }
 
-    return NULL;
+    return match;
 }
 
 /* read filters from the given file */
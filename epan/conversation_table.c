@@ -266,8 +266,13 @@ reset_conversation_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    if (ch->changed_idx != NULL) {
+        g_array_free(ch->changed_idx, TRUE);
+    }
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->changed_idx=NULL;
 }
 
 void reset_hostlist_table_data(conv_hash_t *ch)
@@ -290,8 +295,60 @@ void reset_hostlist_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    if (ch->changed_idx != NULL) {
+        g_array_free(ch->changed_idx, TRUE);
+    }
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->changed_idx=NULL;
+}
+
+/* Queue an entry for the next incremental redraw, once per batch. */
+static void
+mark_table_entry_changed(conv_hash_t *ch, guint idx, gboolean *modified)
+{
+    if (*modified) {
+        return;
+    }
+
+    if (ch->changed_idx == NULL) {
+        ch->changed_idx = g_array_new(FALSE, FALSE, sizeof(guint));
+    }
+    g_array_append_val(ch->changed_idx, idx);
+    *modified = TRUE;
+}
+
+void
+conversation_table_clear_changes(conv_hash_t *ch)
+{
+    guint i;
+
+    if (!ch || !ch->changed_idx) {
+        return;
+    }
+
+    for (i = 0; i < ch->changed_idx->len; i++) {
+        guint idx = g_array_index(ch->changed_idx, guint, i);
+        g_array_index(ch->conv_array, conv_item_t, idx).modified = FALSE;
+    }
+    g_array_set_size(ch->changed_idx, 0);
+}
+
+void
+hostlist_table_clear_changes(conv_hash_t *ch)
+{
+    guint i;
+
+    if (!ch || !ch->changed_idx) {
+        return;
+    }
+
+    for (i = 0; i < ch->changed_idx->len; i++) {
+        guint idx = g_array_index(ch->changed_idx, guint, i);
+        g_array_index(ch->conv_array, hostlist_talker_t, idx).modified = FALSE;
+    }
+    g_array_set_size(ch->changed_idx, 0);
 }
 
 char *get_conversation_address(wmem_allocator_t *allocator, address *addr, gboolean resolve_names)
@@ -627,7 +684,8 @@ add_conversation_table_data_with_conv_id(
         existing_key.port2 = port2;
         existing_key.conv_id = conv_id;
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+            conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
         }
     }
 
@@ -648,6 +706,7 @@ add_conversation_table_data_with_conv_id(
         new_conv_item.tx_frames = 0;
         new_conv_item.rx_bytes = 0;
         new_conv_item.tx_bytes = 0;
+        new_conv_item.modified = FALSE;
 
         if (ts) {
             memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
@@ -689,6 +748,8 @@ add_conversation_table_data_with_conv_id(
             memcpy(&conv_item->start_abs_time, abs_ts, sizeof(conv_item->start_abs_time));
         }
     }
+
+    mark_table_entry_changed(ch, conversation_idx, &conv_item->modified);
 }
 
 /*
@@ -751,7 +812,8 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         existing_key.port = port;
 
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &talker_idx_hash_val)) {
-            talker = &g_array_index(ch->conv_array, hostlist_talker_t, GPOINTER_TO_UINT(talker_idx_hash_val));
+            talker_idx = GPOINTER_TO_UINT(talker_idx_hash_val);
+            talker = &g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
         }
     }
 
@@ -769,7 +831,7 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         host.tx_frames=0;
         host.rx_bytes=0;
         host.tx_bytes=0;
-        host.modified = TRUE;
+        host.modified = FALSE;
 
         g_array_append_val(ch->conv_array, host);
         talker_idx= ch->conv_array->len - 1;
@@ -782,8 +844,7 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(talker_idx));
     }
 
-    /* if this is a new talker we need to initialize the struct */
-    talker->modified = TRUE;
+    mark_table_entry_changed(ch, talker_idx, &talker->modified);
 
     /* update the talker struct */
     if( sender ){
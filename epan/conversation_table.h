@@ -53,6 +53,7 @@ typedef enum {
 typedef struct _conversation_hash_t {
     GHashTable  *hashtable;       /**< conversations hash table */
     GArray      *conv_array;      /**< array of conversation values */
+    GArray      *changed_idx;     /**< conv_array indexes (guint) added or updated since the changes were last cleared */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
 } conv_hash_t;
 
@@ -113,6 +114,8 @@ typedef struct _conversation_item_t {
     nstime_t            start_time;     /**< relative start time for the conversation */
     nstime_t            stop_time;      /**< relative stop time for the conversation */
     nstime_t            start_abs_time; /**< absolute start time for the conversation */
+
+    gboolean            modified;       /**< listed in changed_idx */
 } conv_item_t;
 
 /** Hostlist information */
@@ -127,7 +130,7 @@ typedef struct _hostlist_talker_t {
     guint64 rx_bytes;       /**< number of received bytes */
     guint64 tx_bytes;       /**< number of transmitted bytes */
 
-    gboolean modified;      /**< new to redraw the row */
+    gboolean modified;      /**< listed in changed_idx */
 
 } hostlist_talker_t;
 
@@ -216,6 +219,19 @@ WS_DLL_PUBLIC void reset_conversation_table_data(conv_hash_t *ch);
  */
 WS_DLL_PUBLIC void reset_hostlist_table_data(conv_hash_t *ch);
 
+/** Forget the conversations added or updated so far. GUIs that redraw
+ * incrementally walk ch->changed_idx on each tap draw and then call this.
+ *
+ * @param ch the conversation table
+ */
+WS_DLL_PUBLIC void conversation_table_clear_changes(conv_hash_t *ch);
+
+/** Forget the hosts added or updated so far.
+ *
+ * @param ch the hostlist table
+ */
+WS_DLL_PUBLIC void hostlist_table_clear_changes(conv_hash_t *ch);
+
 /** Initialize dissector conversation for stats and (possibly) GUI.
  *
  * @param opt_arg filter string to compare with dissector
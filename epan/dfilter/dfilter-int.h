@@ -24,11 +24,19 @@ struct epan_dfilter {
 	GList		**registers;
 	gboolean	*attempted_load;
 	gboolean	*owns_memory;
+	gboolean	*shares_list;
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
 };
 
+/* Field values read from one protocol tree, shared between the dfilters
+ * applied to it.  Maps a field id to the GList of its fvalues, or to NULL
+ * if the field isn't in the tree. */
+struct epan_dfilter_fields {
+	GHashTable	*values;
+};
+
 typedef struct {
 	/* Syntax Tree stuff */
 	stnode_t	*st_root;
@@ -150,6 +150,7 @@ dfilter_free(dfilter_t *df)
 	g_free(df->registers);
 	g_free(df->attempted_load);
 	g_free(df->owns_memory);
+	g_free(df->shares_list);
 	g_free(df);
 }
 
@@ -351,6 +352,7 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		dfilter->registers = g_new0(GList*, dfilter->max_registers);
 		dfilter->attempted_load = g_new0(gboolean, dfilter->max_registers);
 		dfilter->owns_memory = g_new0(gboolean, dfilter->max_registers);
+		dfilter->shares_list = g_new0(gboolean, dfilter->max_registers);
 
 		/* Initialize constants */
 		dfvm_init_const(dfilter);
@@ -400,13 +402,46 @@ FAILURE:
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree)
 {
-	return dfvm_apply(df, tree);
+	return dfvm_apply(df, tree, NULL);
 }
 
 gboolean
 dfilter_apply_edt(dfilter_t *df, epan_dissect_t* edt)
 {
-	return dfvm_apply(df, edt->tree);
+	return dfvm_apply(df, edt->tree, NULL);
+}
+
+dfilter_fields_t *
+dfilter_fields_new(void)
+{
+	dfilter_fields_t *fields;
+
+	fields = g_new(dfilter_fields_t, 1);
+	fields->values = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+	    NULL, (GDestroyNotify)g_list_free);
+	return fields;
+}
+
+void
+dfilter_fields_reset(dfilter_fields_t *fields)
+{
+	g_hash_table_remove_all(fields->values);
+}
+
+void
+dfilter_fields_free(dfilter_fields_t *fields)
+{
+	if (!fields)
+		return;
+	g_hash_table_destroy(fields->values);
+	g_free(fields);
+}
+
+gboolean
+dfilter_apply_edt_with_fields(dfilter_t *df, epan_dissect_t* edt,
+    dfilter_fields_t *fields)
+{
+	return dfvm_apply(df, edt->tree, fields);
 }
 
 
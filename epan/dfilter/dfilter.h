@@ -64,6 +64,31 @@ dfilter_apply_edt(dfilter_t *df, struct epan_dissect *edt);
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree);
 
+/* Field values read from a protocol tree by one dfilter, kept so that
+ * other dfilters applied to the same tree don't read them again. */
+typedef struct epan_dfilter_fields dfilter_fields_t;
+
+WS_DLL_PUBLIC
+dfilter_fields_t *
+dfilter_fields_new(void);
+
+/* Forget the field values read so far; must be called before the
+ * dfilter_fields_t is used with another (or a changed) protocol tree. */
+WS_DLL_PUBLIC
+void
+dfilter_fields_reset(dfilter_fields_t *fields);
+
+WS_DLL_PUBLIC
+void
+dfilter_fields_free(dfilter_fields_t *fields);
+
+/* Apply compiled dfilter, sharing the field values read from the tree
+ * with the other dfilters applied to it with the same 'fields'. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_apply_edt_with_fields(dfilter_t *df, struct epan_dissect *edt,
+    dfilter_fields_t *fields);
+
 /* Prime a proto_tree using the fields/protocols used in a dfilter. */
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
@@ -285,15 +285,20 @@ dfvm_dump(FILE *f, dfilter_t *df)
 }
 
 /* Reads a field from the proto_tree and loads the fvalues into a register,
- * if that field has not already been read. */
+ * if that field has not already been read.  If 'fields' is not NULL, the
+ * fvalues are taken from, or added to, the values shared with other
+ * dfilters. */
 static gboolean
-read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
+read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg,
+	  dfilter_fields_t *fields)
 {
 	GPtrArray	*finfos;
 	field_info	*finfo;
 	int		i, len;
 	GList		*fvalues = NULL;
 	gboolean	found_something = FALSE;
+	gpointer	key = NULL;
+	gpointer	shared;
 
 	/* Already loaded in this run of the dfilter? */
 	if (df->attempted_load[reg]) {
@@ -307,6 +312,20 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 
 	df->attempted_load[reg] = TRUE;
 
+	/* Already loaded by another dfilter? */
+	if (fields) {
+		key = GINT_TO_POINTER(hfinfo->id);
+		if (g_hash_table_lookup_extended(fields->values, key, NULL, &shared)) {
+			if (!shared) {
+				return FALSE;
+			}
+			df->registers[reg] = (GList *)shared;
+			df->owns_memory[reg] = FALSE;
+			df->shares_list[reg] = TRUE;
+			return TRUE;
+		}
+	}
+
 	while (hfinfo) {
 		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
 		if ((finfos == NULL) || (g_ptr_array_len(finfos) == 0)) {
@@ -326,6 +345,12 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 		hfinfo = hfinfo->same_name_next;
 	}
 
+	if (fields) {
+		/* The shared values own the list */
+		g_hash_table_insert(fields->values, key, fvalues);
+		df->shares_list[reg] = TRUE;
+	}
+
 	if (!found_something) {
 		return FALSE;
 	}
@@ -422,9 +447,11 @@ free_register_overhead(dfilter_t* df)
 				g_list_foreach(df->registers[i], free_owned_register, NULL);
 				df->owns_memory[i] = FALSE;
 			}
-			g_list_free(df->registers[i]);
+			if (!df->shares_list[i])
+				g_list_free(df->registers[i]);
 			df->registers[i] = NULL;
 		}
+		df->shares_list[i] = FALSE;
 	}
 }
 
@@ -459,7 +486,7 @@ mk_range(dfilter_t *df, int from_reg, int to_reg, drange_t *d_range)
 
 
 gboolean
-dfvm_apply(dfilter_t *df, proto_tree *tree)
+dfvm_apply(dfilter_t *df, proto_tree *tree, dfilter_fields_t *fields)
 {
 	int		id, length;
 	gboolean	accum = TRUE;
@@ -500,7 +527,8 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 
 			case READ_TREE:
 				accum = read_tree(df, tree,
-						arg1->value.hfinfo, arg2->value.numeric);
+						arg1->value.hfinfo, arg2->value.numeric,
+						fields);
 				break;
 
 			case CALL_FUNCTION:
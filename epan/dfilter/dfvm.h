@@ -86,7 +86,7 @@ void
 dfvm_dump(FILE *f, dfilter_t *df);
 
 gboolean
-dfvm_apply(dfilter_t *df, proto_tree *tree);
+dfvm_apply(dfilter_t *df, proto_tree *tree, dfilter_fields_t *fields);
 
 void
 dfvm_init_const(dfilter_t *df);
@@ -1703,8 +1703,9 @@ dissect_http_message(tvbuff_t *tvb, int offset, packet_info *pinfo,
 			     g_ascii_strcasecmp(headers.content_encoding, "x-gzip") == 0 ||
 			     g_ascii_strcasecmp(headers.content_encoding, "x-deflate") == 0))
 			{
-				uncomp_tvb = tvb_child_uncompress(tvb, next_tvb, 0,
-				    tvb_captured_length(next_tvb));
+				uncomp_tvb = tvb_child_uncompress_cached(tvb, next_tvb, 0,
+				    tvb_captured_length(next_tvb), pinfo->num,
+				    pinfo->curr_layer_num, offset);
 			}
 
 			/*
@@ -1989,7 +1989,8 @@ dissect_http2_data_full_body(tvbuff_t *tvb, packet_info *pinfo, proto_tree *http
 
     if (can_uncompress_body(pinfo)) {
         proto_item *compressed_proto_item = NULL;
-        tvbuff_t *uncompressed_tvb = tvb_child_uncompress(tvb, tvb, 0, datalen);
+        tvbuff_t *uncompressed_tvb = tvb_child_uncompress_cached(tvb, tvb, 0, datalen,
+            pinfo->num, pinfo->curr_layer_num, get_stream_info(get_http2_session(pinfo))->stream_id);
         http2_data_stream_body_info_t *body_info = get_data_stream_body_info(pinfo);
         gchar *compression_method = body_info->content_encoding;
 
@@ -130,6 +130,9 @@
 #include <epan/expert.h>
 #include <epan/addr_resolv.h>
 #include <wsutil/str_util.h>
+#include <wsutil/file_util.h>
+#include <wsutil/inet_addr.h>
+#include <wsutil/strtoi.h>
 #include "packet-tcp.h"
 #include "packet-udp.h"
 #include "packet-ntp.h"
@@ -170,6 +173,16 @@ static range_t *global_ipfix_ports = NULL;
 
 static gboolean netflow_preference_desegment = TRUE;
 
+/*
+ * Templates can be loaded from, and saved to, a file, so that data
+ * flowsets at the start of a capture (e.g. one of a set of rotated
+ * files) can be dissected before the exporter resends its templates.
+ */
+static const gchar *netflow_template_file = NULL;
+static gboolean netflow_save_templates = FALSE;
+#define V9_V10_STORED_TMPLT_MAX_DEF 10000
+static guint v9_v10_stored_tmplt_max = V9_V10_STORED_TMPLT_MAX_DEF;
+
 /*
  * Flowset (template) ID's
  */
@@ -310,6 +323,7 @@ typedef struct _v9_v10_tmplt {
     guint32  dst_port;
     guint32  src_id;   /* SourceID in NetFlow V9, Observation Domain ID in IPFIX */
     guint16  tmplt_id;
+    guint16  version;  /* 9 or 10; only used for stored templates */
     guint    length;
     guint16  field_count[TF_NUM];                /* 0:scopes; 1:entries  */
     v9_v10_tmplt_entry_t *fields_p[TF_NUM_EXT];  /* 0:scopes; 1:entries; n:vendor_entries  */
@@ -320,6 +334,26 @@ typedef struct _v9_v10_tmplt {
 /* Confusingly, for key, fill in only relevant parts of v9_v10_tmplt_entry_t... */
 wmem_map_t *v9_v10_tmplt_table = NULL;
 
+/* Map from (version+exporter address+obs-domain-id+flowset-id) -> v9_v10_tmplt_t* */
+/* of templates loaded from the template file or seen in previous captures.     */
+/* Unlike v9_v10_tmplt_table, this outlives a capture file; it's allocated      */
+/* with g_malloc() and only version, src_addr, src_id and tmplt_id are used as  */
+/* the key.  Only used if a template file has been set.                         */
+static GHashTable *v9_v10_stored_tmplt_table = NULL;
+static gchar *v9_v10_stored_tmplt_file_loaded = NULL;
+
+/* Templates of the last capture that was closed.  They're only added to     */
+/* v9_v10_stored_tmplt_table once a different capture is dissected, so that  */
+/* reloading or redissecting a capture doesn't use its own templates for the */
+/* data flowsets that precede them.  A capture is identified by the time     */
+/* stamp of its first frame.  This is only a heuristic: two captures that    */
+/* start at the same time are taken to be the same one (and a capture that  */
+/* is edited so that its first frame changes, to be a different one).       */
+static GHashTable *v9_v10_pending_tmplt_table = NULL;
+static nstime_t v9_v10_pending_tmplt_capture;
+static gboolean v9_v10_capture_known = FALSE;
+static nstime_t v9_v10_capture;
+
 
 static const value_string v9_v10_template_types[] = {
     {   1, "BYTES" },
@@ -3182,6 +3216,7 @@ static expert_field ei_cflow_no_flow_information                       = EI_INIT
 static expert_field ei_cflow_mpls_label_bad_length                     = EI_INIT;
 static expert_field ei_cflow_flowsets_impossible                       = EI_INIT;
 static expert_field ei_cflow_no_template_found                         = EI_INIT;
+static expert_field ei_cflow_stored_template                           = EI_INIT;
 static expert_field ei_transport_bytes_out_of_order                    = EI_INIT;
 static expert_field ei_unexpected_sequence_number                      = EI_INIT;
 
@@ -3350,6 +3385,8 @@ static int      flow_process_sizecount(proto_tree *pdutree, tvbuff_t *tvb,
                                        int offset);
 
 static v9_v10_tmplt_t *v9_v10_tmplt_build_key(v9_v10_tmplt_t *tmplt_p, packet_info *pinfo, guint32 src_id, guint16 tmplt_id);
+static v9_v10_tmplt_t *v9_v10_stored_tmplt_lookup(packet_info *pinfo, guint16 version, guint32 src_id, guint16 tmplt_id);
+static void v9_v10_stored_tmplt_check_capture(packet_info *pinfo);
 
 
 static int
@@ -3513,6 +3550,8 @@ dissect_netflow(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
 
     ipfix_debug("dissect_netflow: start");
 
+    v9_v10_stored_tmplt_check_capture(pinfo);
+
     ver = tvb_get_ntohs(tvb, offset);
 
     ipfix_debug("dissect_netflow: found version %d", ver);
@@ -4160,17 +4199,25 @@ dissect_v9_v10_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdutree, int
     /* Look up template */
     v9_v10_tmplt_build_key(&tmplt_key, pinfo, hdrinfo_p->src_id, id);
     tmplt_p = (v9_v10_tmplt_t *)wmem_map_lookup(v9_v10_tmplt_table, &tmplt_key);
+    if (tmplt_p == NULL) {
+        /* Not (yet) seen in this capture; maybe we know it from elsewhere */
+        tmplt_p = v9_v10_stored_tmplt_lookup(pinfo, hdrinfo_p->vspec, hdrinfo_p->src_id, id);
+    }
     if ((tmplt_p != NULL)  && (tmplt_p->length != 0)) {
         int count = 1;
         proto_item *ti;
 
-        /* Provide a link back to template frame */
-        ti = proto_tree_add_uint(pdutree, hf_template_frame, tvb,
-                                 0, 0, tmplt_p->template_frame_number);
-        if (tmplt_p->template_frame_number > pinfo->num) {
-            proto_item_append_text(ti, " (received after this frame)");
+        if (tmplt_p->template_frame_number != 0) {
+            /* Provide a link back to template frame */
+            ti = proto_tree_add_uint(pdutree, hf_template_frame, tvb,
+                                     0, 0, tmplt_p->template_frame_number);
+            if (tmplt_p->template_frame_number > pinfo->num) {
+                proto_item_append_text(ti, " (received after this frame)");
+            }
+            PROTO_ITEM_SET_GENERATED(ti);
+        } else {
+            expert_add_info(pinfo, proto_tree_get_parent(pdutree), &ei_cflow_stored_template);
         }
-        PROTO_ITEM_SET_GENERATED(ti);
 
         /* Note: If the flow contains variable length fields then          */
         /*       tmplt_p->length will be less then actual length of the flow. */
@@ -10531,6 +10578,7 @@ dissect_v9_v10_options_template(tvbuff_t *tvb, packet_info *pinfo, proto_tree *p
         memset(&tmplt, 0, sizeof(tmplt));
 
         v9_v10_tmplt_build_key(&tmplt, pinfo, hdrinfo_p->src_id, id);
+        tmplt.version = hdrinfo_p->vspec;
 
         tmplt.field_count[TF_SCOPES]  = option_scope_field_count;
         tmplt.field_count[TF_ENTRIES] = option_field_count;
@@ -10638,6 +10686,7 @@ dissect_v9_v10_data_template(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdut
         memset(&tmplt, 0, sizeof(tmplt));
 
         v9_v10_tmplt_build_key(&tmplt, pinfo, hdrinfo_p->src_id, id); /* lookup only ! */
+        tmplt.version = hdrinfo_p->vspec;
 
         tmplt.field_count[TF_ENTRIES]  = count;
 
@@ -10738,6 +10787,383 @@ v9_v10_tmplt_table_hash(gconstpointer k)
     return val;
 }
 
+/*
+ * Stored templates
+ */
+static gboolean
+v9_v10_stored_tmplt_table_equal(gconstpointer k1, gconstpointer k2)
+{
+    const v9_v10_tmplt_t *ta = (const v9_v10_tmplt_t *)k1;
+    const v9_v10_tmplt_t *tb = (const v9_v10_tmplt_t *)k2;
+
+    return (
+        (ta->version  == tb->version)                    &&
+        (cmp_address(&ta->src_addr, &tb->src_addr) == 0) &&
+        (ta->src_id   == tb->src_id)                     &&
+        (ta->tmplt_id == tb->tmplt_id)
+        );
+}
+
+static guint
+v9_v10_stored_tmplt_table_hash(gconstpointer k)
+{
+    const v9_v10_tmplt_t *tmplt_p = (const v9_v10_tmplt_t *)k;
+    guint32               val;
+
+    val = tmplt_p->src_id + (tmplt_p->tmplt_id << 9) + (tmplt_p->version << 25);
+
+    return add_address_to_hash(val, &tmplt_p->src_addr);
+}
+
+static void
+v9_v10_stored_tmplt_free(gpointer data)
+{
+    v9_v10_tmplt_t *tmplt_p = (v9_v10_tmplt_t *)data;
+
+    free_address(&tmplt_p->src_addr);
+    g_free(tmplt_p->fields_p[TF_SCOPES]);
+    g_free(tmplt_p->fields_p[TF_ENTRIES]);
+    g_free(tmplt_p);
+}
+
+/* Templates are only kept between captures if there's a template file */
+static gboolean
+v9_v10_stored_tmplt_enabled(void)
+{
+    return (netflow_template_file != NULL) && (netflow_template_file[0] != '\0');
+}
+
+static v9_v10_tmplt_t *
+v9_v10_stored_tmplt_lookup(packet_info *pinfo, guint16 version, guint32 src_id, guint16 tmplt_id)
+{
+    v9_v10_tmplt_t tmplt_key;
+
+    if (v9_v10_stored_tmplt_table == NULL)
+        return NULL;
+
+    memset(&tmplt_key, 0, sizeof(tmplt_key));
+    set_address(&tmplt_key.src_addr, pinfo->net_src.type, pinfo->net_src.len, pinfo->net_src.data); /* lookup only! */
+    tmplt_key.version  = version;
+    tmplt_key.src_id   = src_id;
+    tmplt_key.tmplt_id = tmplt_id;
+
+    return (v9_v10_tmplt_t *)g_hash_table_lookup(v9_v10_stored_tmplt_table, &tmplt_key);
+}
+
+/* Add a copy of a template to a table of stored templates, replacing any
+   older template with the same key.  The copy is not linked to a frame. */
+static void
+v9_v10_stored_tmplt_add(GHashTable **table_p, const v9_v10_tmplt_t *tmplt_p)
+{
+    v9_v10_tmplt_t *stored_p;
+    int             i;
+
+    if ((tmplt_p->src_addr.type != AT_IPv4) && (tmplt_p->src_addr.type != AT_IPv6))
+        return;
+
+    if (*table_p == NULL) {
+        *table_p = g_hash_table_new_full(v9_v10_stored_tmplt_table_hash,
+                                         v9_v10_stored_tmplt_table_equal,
+                                         NULL, v9_v10_stored_tmplt_free);
+    }
+
+    if ((g_hash_table_size(*table_p) >= v9_v10_stored_tmplt_max) &&
+        (g_hash_table_lookup(*table_p, tmplt_p) == NULL)) {
+        /* Full; keep what we have */
+        return;
+    }
+
+    stored_p = g_new0(v9_v10_tmplt_t, 1);
+    copy_address(&stored_p->src_addr, &tmplt_p->src_addr);
+    stored_p->version  = tmplt_p->version;
+    stored_p->src_id   = tmplt_p->src_id;
+    stored_p->tmplt_id = tmplt_p->tmplt_id;
+    stored_p->length   = tmplt_p->length;
+    for (i = TF_SCOPES; i < TF_NUM; i++) {
+        stored_p->field_count[i] = tmplt_p->field_count[i];
+        if (tmplt_p->fields_p[i] != NULL) {
+            stored_p->fields_p[i] = (v9_v10_tmplt_entry_t *)g_memdup(tmplt_p->fields_p[i],
+                                                                    tmplt_p->field_count[i] * sizeof(v9_v10_tmplt_entry_t));
+        }
+    }
+
+    /* g_hash_table_replace() frees the old value, and its key with it */
+    g_hash_table_replace(*table_p, stored_p, stored_p);
+}
+
+static void
+v9_v10_pending_tmplt_commit_one(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+    v9_v10_stored_tmplt_add(&v9_v10_stored_tmplt_table, (const v9_v10_tmplt_t *)value);
+}
+
+/* Called for each packet; the first one of a capture decides what happens
+   to the templates of the previous capture. */
+static void
+v9_v10_stored_tmplt_check_capture(packet_info *pinfo)
+{
+    const nstime_t *first_ts;
+
+    if (v9_v10_capture_known || !v9_v10_stored_tmplt_enabled())
+        return;
+
+    /* The first frame isn't in the frame list while it's being read */
+    first_ts = (pinfo->num == 1) ? &pinfo->abs_ts : epan_get_frame_ts(pinfo->epan, 1);
+    if (first_ts != NULL) {
+        v9_v10_capture = *first_ts;
+    } else {
+        nstime_set_unset(&v9_v10_capture);
+    }
+    v9_v10_capture_known = TRUE;
+
+    if (v9_v10_pending_tmplt_table == NULL)
+        return;
+
+    if (nstime_is_unset(&v9_v10_capture) ||
+        (nstime_cmp(&v9_v10_capture, &v9_v10_pending_tmplt_capture) != 0)) {
+        /* A different capture; the previous one's templates can be used now */
+        g_hash_table_foreach(v9_v10_pending_tmplt_table, v9_v10_pending_tmplt_commit_one, NULL);
+    }
+    /* Otherwise this is the same capture again, whose templates will be
+       seen again anyway. */
+    g_hash_table_destroy(v9_v10_pending_tmplt_table);
+    v9_v10_pending_tmplt_table = NULL;
+}
+
+/*
+ * The template file has one template per line:
+ *
+ *   <version> <exporter address> <obs-domain-id> <template id> <scope count> <entry count> <type>/<length>[/<pen>] ...
+ *
+ * with the scope fields first.  The version is 9 (NetFlow v9) or 10
+ * (IPFIX).  Lines starting with '#' are comments.
+ */
+static gboolean
+v9_v10_stored_tmplt_parse_line(gchar *line, v9_v10_tmplt_t *tmplt_p, ws_in6_addr *addr_buf)
+{
+    gchar  **tokens;
+    guint    n_tokens;
+    guint    i, field;
+    int      fields_type;
+    gboolean ok = FALSE;
+
+    tokens = g_strsplit_set(g_strstrip(line), " \t", -1);
+    n_tokens = g_strv_length(tokens);
+    if (n_tokens < 6)
+        goto done;
+
+    if (!ws_strtou16(tokens[0], NULL, &tmplt_p->version) ||
+        ((tmplt_p->version != 9) && (tmplt_p->version != 10)))
+        goto done;
+
+    if (ws_inet_pton4(tokens[1], (ws_in4_addr *)addr_buf)) {
+        set_address(&tmplt_p->src_addr, AT_IPv4, 4, addr_buf);
+    } else if (ws_inet_pton6(tokens[1], addr_buf)) {
+        set_address(&tmplt_p->src_addr, AT_IPv6, 16, addr_buf);
+    } else {
+        goto done;
+    }
+
+    if (!ws_strtou32(tokens[2], NULL, &tmplt_p->src_id) ||
+        !ws_strtou16(tokens[3], NULL, &tmplt_p->tmplt_id) ||
+        !ws_strtou16(tokens[4], NULL, &tmplt_p->field_count[TF_SCOPES]) ||
+        !ws_strtou16(tokens[5], NULL, &tmplt_p->field_count[TF_ENTRIES]))
+        goto done;
+
+    if (n_tokens != 6u + tmplt_p->field_count[TF_SCOPES] + tmplt_p->field_count[TF_ENTRIES])
+        goto done;
+    if (v9_tmplt_max_fields &&
+        ((tmplt_p->field_count[TF_SCOPES] > v9_tmplt_max_fields) ||
+         (tmplt_p->field_count[TF_ENTRIES] > v9_tmplt_max_fields)))
+        goto done;
+
+    i = 6;
+    for (fields_type = TF_SCOPES; fields_type < TF_NUM; fields_type++) {
+        if (tmplt_p->field_count[fields_type] == 0)
+            continue;
+        tmplt_p->fields_p[fields_type] = g_new0(v9_v10_tmplt_entry_t, tmplt_p->field_count[fields_type]);
+        for (field = 0; field < tmplt_p->field_count[fields_type]; field++, i++) {
+            v9_v10_tmplt_entry_t *entry_p = &tmplt_p->fields_p[fields_type][field];
+            gchar **parts = g_strsplit(tokens[i], "/", 3);
+            gboolean valid;
+
+            valid = (g_strv_length(parts) >= 2) &&
+                ws_strtou16(parts[0], NULL, &entry_p->type) &&
+                ws_strtou16(parts[1], NULL, &entry_p->length) &&
+                ((parts[2] == NULL) || ws_strtou32(parts[2], NULL, &entry_p->pen));
+            g_strfreev(parts);
+            if (!valid)
+                goto done;
+
+            if (entry_p->type & 0x8000)
+                entry_p->pen_str = enterprises_lookup(entry_p->pen, "(Unknown)");
+            if (entry_p->length != VARIABLE_LENGTH)
+                tmplt_p->length += entry_p->length;
+        }
+    }
+    ok = TRUE;
+
+done:
+    g_strfreev(tokens);
+    return ok;
+}
+
+static void
+v9_v10_stored_tmplt_load(const gchar *filename)
+{
+    FILE  *fp;
+    gchar  line[16384];
+
+    fp = ws_fopen(filename, "r");
+    if (fp == NULL)
+        return;
+
+    while (fgets(line, sizeof line, fp) != NULL) {
+        v9_v10_tmplt_t tmplt;
+        ws_in6_addr    addr_buf;
+
+        if ((line[0] == '#') || (line[0] == '\n') || (line[0] == '\r'))
+            continue;
+
+        memset(&tmplt, 0, sizeof(tmplt));
+        if (v9_v10_stored_tmplt_parse_line(line, &tmplt, &addr_buf))
+            v9_v10_stored_tmplt_add(&v9_v10_stored_tmplt_table, &tmplt);
+        g_free(tmplt.fields_p[TF_SCOPES]);
+        g_free(tmplt.fields_p[TF_ENTRIES]);
+    }
+
+    fclose(fp);
+}
+
+static void
+v9_v10_stored_tmplt_write_one(gpointer key _U_, gpointer value, gpointer user_data)
+{
+    const v9_v10_tmplt_t *tmplt_p = (const v9_v10_tmplt_t *)value;
+    FILE                 *fp      = (FILE *)user_data;
+    gchar                 addr_str[WS_INET6_ADDRSTRLEN];
+    int                   fields_type;
+    guint                 i;
+
+    if (tmplt_p->src_addr.type == AT_IPv4)
+        ws_inet_ntop4(tmplt_p->src_addr.data, addr_str, sizeof addr_str);
+    else
+        ws_inet_ntop6(tmplt_p->src_addr.data, addr_str, sizeof addr_str);
+
+    fprintf(fp, "%u %s %u %u %u %u", tmplt_p->version, addr_str, tmplt_p->src_id, tmplt_p->tmplt_id,
+            tmplt_p->field_count[TF_SCOPES], tmplt_p->field_count[TF_ENTRIES]);
+    for (fields_type = TF_SCOPES; fields_type < TF_NUM; fields_type++) {
+        for (i = 0; i < tmplt_p->field_count[fields_type]; i++) {
+            const v9_v10_tmplt_entry_t *entry_p = &tmplt_p->fields_p[fields_type][i];
+
+            if (entry_p->type & 0x8000)
+                fprintf(fp, " %u/%u/%u", entry_p->type, entry_p->length, entry_p->pen);
+            else
+                fprintf(fp, " %u/%u", entry_p->type, entry_p->length);
+        }
+    }
+    fprintf(fp, "\n");
+}
+
+static void
+v9_v10_stored_tmplt_write_unless_pending(gpointer key, gpointer value, gpointer user_data)
+{
+    /* The templates of the capture that was just closed take precedence */
+    if ((v9_v10_pending_tmplt_table != NULL) &&
+        (g_hash_table_lookup(v9_v10_pending_tmplt_table, value) != NULL))
+        return;
+
+    v9_v10_stored_tmplt_write_one(key, value, user_data);
+}
+
+static void
+v9_v10_stored_tmplt_save(const gchar *filename)
+{
+    FILE *fp;
+
+    if ((v9_v10_stored_tmplt_table == NULL) && (v9_v10_pending_tmplt_table == NULL))
+        return;
+
+    fp = ws_fopen(filename, "w");
+    if (fp == NULL)
+        return;
+
+    fprintf(fp, "# NetFlow v9/IPFIX templates saved by Wireshark\n");
+    fprintf(fp, "# <version> <exporter> <obs-domain-id> <template id> <scope count> <entry count> <type>/<length>[/<pen>] ...\n");
+    if (v9_v10_stored_tmplt_table != NULL)
+        g_hash_table_foreach(v9_v10_stored_tmplt_table, v9_v10_stored_tmplt_write_unless_pending, fp);
+    if (v9_v10_pending_tmplt_table != NULL)
+        g_hash_table_foreach(v9_v10_pending_tmplt_table, v9_v10_stored_tmplt_write_one, fp);
+    fclose(fp);
+}
+
+static void
+v9_v10_tmplt_store_one(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+    const v9_v10_tmplt_t *tmplt_p = (const v9_v10_tmplt_t *)value;
+
+    /* Skip templates that were too large to be cached */
+    if ((tmplt_p->fields_p[TF_SCOPES] == NULL) && (tmplt_p->fields_p[TF_ENTRIES] == NULL))
+        return;
+
+    v9_v10_stored_tmplt_add(&v9_v10_pending_tmplt_table, tmplt_p);
+}
+
+static void
+netflow_stored_tmplt_free_all(void)
+{
+    if (v9_v10_stored_tmplt_table != NULL) {
+        g_hash_table_destroy(v9_v10_stored_tmplt_table);
+        v9_v10_stored_tmplt_table = NULL;
+    }
+    if (v9_v10_pending_tmplt_table != NULL) {
+        g_hash_table_destroy(v9_v10_pending_tmplt_table);
+        v9_v10_pending_tmplt_table = NULL;
+    }
+    g_free(v9_v10_stored_tmplt_file_loaded);
+    v9_v10_stored_tmplt_file_loaded = NULL;
+}
+
+static void
+netflow_init(void)
+{
+    /* (Re)load the template file if it's been changed */
+    if (!v9_v10_stored_tmplt_enabled()) {
+        /* Don't keep templates between captures */
+        netflow_stored_tmplt_free_all();
+        return;
+    }
+    if (g_strcmp0(netflow_template_file, v9_v10_stored_tmplt_file_loaded) == 0)
+        return;
+
+    v9_v10_stored_tmplt_load(netflow_template_file);
+    g_free(v9_v10_stored_tmplt_file_loaded);
+    v9_v10_stored_tmplt_file_loaded = g_strdup(netflow_template_file);
+}
+
+static void
+netflow_cleanup(void)
+{
+    /* Remember the templates of this capture for the next one.  If no
+       NetFlow/IPFIX packet was dissected, keep those of the previous one. */
+    if (v9_v10_capture_known && v9_v10_stored_tmplt_enabled()) {
+        if (v9_v10_pending_tmplt_table != NULL)
+            g_hash_table_remove_all(v9_v10_pending_tmplt_table);
+        wmem_map_foreach(v9_v10_tmplt_table, v9_v10_tmplt_store_one, NULL);
+        v9_v10_pending_tmplt_capture = v9_v10_capture;
+    }
+    v9_v10_capture_known = FALSE;
+
+    if (netflow_save_templates && v9_v10_stored_tmplt_enabled()) {
+        v9_v10_stored_tmplt_save(netflow_template_file);
+    }
+}
+
+static void
+netflow_shutdown(void)
+{
+    netflow_stored_tmplt_free_all();
+}
+
 /*
  * dissect a version 1, 5, or 7 pdu and return the length of the pdu we
  * processed
@@ -17240,6 +17666,9 @@ proto_register_netflow(void)
         { &ei_cflow_no_template_found,
           { "cflow.no_template_found", PI_MALFORMED, PI_WARN,
             "No template found", EXPFILL }},
+        { &ei_cflow_stored_template,
+          { "cflow.stored_template", PI_SEQUENCE, PI_NOTE,
+            "Template not in this capture; using a template from the template file or a previous capture", EXPFILL }},
         { &ei_transport_bytes_out_of_order,
           { "cflow.transport_bytes.out-of-order", PI_MALFORMED, PI_WARN,
             "Transport Bytes Out of Order", EXPFILL}},
@@ -17288,6 +17717,30 @@ proto_register_netflow(void)
 
     prefs_register_bool_preference(netflow_module, "desegment", "Reassemble Netflow v10 messages spanning multiple TCP segments.", "Whether the Netflow/Ipfix dissector should reassemble messages spanning multiple TCP segments.  To use this option, you must also enable \"Allow subdissectors to reassemble TCP streams\" in the TCP protocol settings.", &netflow_preference_desegment);
 
+    prefs_register_filename_preference(netflow_module, "template_file",
+                                       "Template file",
+                                       "A file of v9/IPFIX templates that are used for data flowsets"
+                                       " whose template hasn't been seen in the capture (yet)."
+                                       " Templates are only kept between captures if this is set.",
+                                       &netflow_template_file, FALSE);
+
+    prefs_register_bool_preference(netflow_module, "save_templates",
+                                   "Save templates to the template file",
+                                   "Whether the templates seen in a capture are added to the"
+                                   " template file when the capture is closed.",
+                                   &netflow_save_templates);
+
+    prefs_register_uint_preference(netflow_module, "max_stored_templates",
+                                   "Maximum number of templates kept between captures",
+                                   "Set the maximum number of templates that are kept from the"
+                                   " template file and from previous captures."
+                                   " (default: " G_STRINGIFY(V9_V10_STORED_TMPLT_MAX_DEF) ")",
+                                   10, &v9_v10_stored_tmplt_max);
+
+    register_init_routine(netflow_init);
+    register_cleanup_routine(netflow_cleanup);
+    register_shutdown_routine(netflow_shutdown);
+
     v9_v10_tmplt_table = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), v9_v10_tmplt_table_hash, v9_v10_tmplt_table_equal);
     netflow_sequence_analysis_domain_hash = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
     netflow_sequence_analysis_result_hash = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
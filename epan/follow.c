@@ -152,6 +152,7 @@ follow_info_free(follow_info_t* follow_info)
         }
     }
     g_list_free(follow_info->payload);
+    follow_info_free_index(follow_info);
 
     //Only TCP stream uses fragments
     for (cur = follow_info->fragments[0]; cur; cur = g_list_next(cur)) {
@@ -175,6 +176,42 @@ follow_info_free(follow_info_t* follow_info)
     g_free(follow_info);
 }
 
+guint
+follow_info_index_payload(follow_info_t* follow_info)
+{
+    GList *cur;
+    follow_chunk_t chunk;
+    guint64 dir_offset[2] = { 0, 0 };
+    guint dir_index[2] = { 0, 0 };
+
+    follow_info_free_index(follow_info);
+    follow_info->chunks = g_array_sized_new(FALSE, FALSE, sizeof(follow_chunk_t),
+                                            g_list_length(follow_info->payload));
+
+    /* The payload list is in reverse order. */
+    for (cur = g_list_last(follow_info->payload); cur; cur = g_list_previous(cur)) {
+        follow_record_t *follow_record = (follow_record_t *)cur->data;
+        int dir = follow_record->is_server ? 1 : 0;
+
+        chunk.record = follow_record;
+        chunk.dir_offset = dir_offset[dir];
+        chunk.dir_index = dir_index[dir]++;
+        dir_offset[dir] += follow_record->data->len;
+        g_array_append_val(follow_info->chunks, chunk);
+    }
+
+    return follow_info->chunks->len;
+}
+
+void
+follow_info_free_index(follow_info_t* follow_info)
+{
+    if (follow_info->chunks) {
+        g_array_free(follow_info->chunks, TRUE);
+        follow_info->chunks = NULL;
+    }
+}
+
 gboolean
 follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
                       epan_dissect_t *edt _U_, const void *data)
@@ -81,10 +81,18 @@ typedef struct {
     GByteArray *data;
 } follow_record_t;
 
+/* Position of a payload record within its direction of the stream. */
+typedef struct {
+    follow_record_t *record;
+    guint64         dir_offset; /* Offset of the record's first byte within its direction. */
+    guint           dir_index;  /* Number of records preceding this one in its direction. */
+} follow_chunk_t;
+
 typedef struct _follow_info {
     show_stream_t   show_stream;
     char            *filter_out_filter;
     GList           *payload;   /* "follow_record_t" entries, in reverse order. */
+    GArray          *chunks;    /* "follow_chunk_t" entries, in stream order. See follow_info_index_payload. */
     guint           bytes_written[2]; /* Index with FROM_CLIENT or FROM_SERVER for readability. */
     guint32         seq[2]; /* TCP only */
     GList           *fragments[2]; /* TCP only */
@@ -200,6 +208,24 @@ WS_DLL_PUBLIC void follow_reset_stream(follow_info_t* info);
  */
 WS_DLL_PUBLIC void follow_info_free(follow_info_t* follow_info);
 
+/** Index the payload of a follow_info_t.
+ * Fills in follow_info->chunks with one follow_chunk_t per payload
+ * record, in stream order, so that a UI can render or search any part
+ * of a large stream without walking the payload list. Any existing
+ * index is replaced. The index refers to the payload records and must
+ * be rebuilt or freed whenever the payload changes.
+ *
+ * @param follow_info [in] follower info
+ * @return The number of indexed records
+ */
+WS_DLL_PUBLIC guint follow_info_index_payload(follow_info_t* follow_info);
+
+/** Free the payload index of a follow_info_t.
+ *
+ * @param follow_info [in] follower info
+ */
+WS_DLL_PUBLIC void follow_info_free_index(follow_info_t* follow_info);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -17,6 +17,7 @@
 
 #include <epan/tvbuff.h>
 #include <epan/in_cksum.h>
+#include <wsutil/ws_cksum.h>
 
 /*
  * Checksum routine for Internet Protocol family headers (Portable Version).
@@ -76,28 +77,19 @@ in_cksum(const vec_t *vec, int veclen)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Add up all the whole words; ws_cksum_sum16() has
+		 * vectorized versions, and returns a 16-bit sum, so
+		 * this can't overflow.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
+		if (mlen >= 2) {
+			sum += ws_cksum_sum16(w, mlen & ~1);
+			w += mlen / 2;
+			mlen &= 1;
 		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
-		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
-		while ((mlen -= 2) >= 0) {
-			sum += *w++;
-		}
+		mlen -= 2;
 		if (byte_swapped) {
 			REDUCE;
 			sum <<= 8;
@@ -3468,6 +3468,12 @@ prefs_register_modules(void)
     prefs_register_bool_preference(capture_module, "show_info", "Show capture information dialog while capturing",
         "Show capture information dialog while capturing?", &prefs.capture_show_info);
 
+    /* Used by Wireshark, TShark and sharkd alike. */
+    prefs_register_bool_preference(capture_module, "packet_index", "Keep a packet index next to capture files",
+        "Write a packet index (.wsidx) file next to a pcap or pcapng file when it is first"
+        " read, and use it to avoid rereading the file when it is opened again?",
+        &prefs.capture_packet_index);
+
     prefs_register_obsolete_preference(capture_module, "syntax_check_filter");
 
     custom_cbs.free_cb = capture_column_free_cb;
@@ -4115,6 +4121,7 @@ pre_init_prefs(void)
     prefs.capture_no_extcap             = FALSE;
     prefs.capture_auto_scroll           = TRUE;
     prefs.capture_show_info             = FALSE;
+    prefs.capture_packet_index          = FALSE;
 
     if (!prefs.capture_columns) {
         /* First time through */
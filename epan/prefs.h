@@ -207,6 +207,7 @@ typedef struct _e_prefs {
   gboolean     capture_auto_scroll; /* XXX - Move to recent */
   gboolean     capture_no_extcap;
   gboolean     capture_show_info;
+  gboolean     capture_packet_index;
   GList       *capture_columns;
   guint        tap_update_interval;
   gboolean     display_hidden_proto_items;
@@ -85,6 +85,7 @@ typedef struct _tap_listener_t {
 	guint flags;
 	gchar *fstring;
 	dfilter_t *code;
+	GArray *hfids;
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -92,6 +93,9 @@ typedef struct _tap_listener_t {
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/* Field values shared by the listener filters while pushing a packet */
+static dfilter_fields_t *tap_filter_fields=NULL;
+
 #ifdef HAVE_PLUGINS
 static GSList *tap_plugins = NULL;
 
@@ -255,6 +259,9 @@ void tap_build_interesting (epan_dissect_t *edt)
 		if(tl->code){
 			epan_dissect_prime_with_dfilter(edt, tl->code);
 		}
+		if(tl->hfids){
+			epan_dissect_prime_with_hfid_array(edt, tl->hfids);
+		}
 	}
 }
 
@@ -299,6 +306,10 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	if(!tap_filter_fields){
+		tap_filter_fields=dfilter_fields_new();
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
@@ -310,7 +321,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 				if(tp->tap_id==tl->tap_id){
 					gboolean passed=TRUE;
 					if(tl->code){
-						passed=dfilter_apply_edt(tl->code, edt);
+						passed=dfilter_apply_edt_with_fields(tl->code, edt, tap_filter_fields);
 					}
 					if(passed && tl->packet){
 						tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
@@ -319,6 +330,8 @@ tap_push_tapped_queue(epan_dissect_t *edt)
             }
 		}
 	}
+
+	dfilter_fields_reset(tap_filter_fields);
 }
 
 
@@ -452,6 +465,8 @@ free_tap_listener(volatile tap_listener_t *tl)
 		return;
 	dfilter_free(tl->code);
 	g_free(tl->fstring);
+	if(tl->hfids)
+		g_array_free(tl->hfids, TRUE);
 DIAG_OFF(cast-qual)
 	g_free((gpointer)tl);
 DIAG_ON(cast-qual)
@@ -560,6 +575,32 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 	return NULL;
 }
 
+/* this function sets the fields a tap listener reads from the protocol tree
+ */
+void
+set_tap_interesting_hfids(void *tapdata, const int *hfids, guint num_hfids)
+{
+	volatile tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			break;
+		}
+	}
+	if(!tl){
+		return;
+	}
+
+	if(tl->hfids){
+		g_array_free(tl->hfids, TRUE);
+		tl->hfids=NULL;
+	}
+	if(hfids && num_hfids){
+		tl->hfids=g_array_sized_new(FALSE, FALSE, sizeof(int), num_hfids);
+		g_array_append_vals(tl->hfids, hfids, num_hfids);
+	}
+}
+
 /* this function recompiles dfilter for all registered tap listeners
  */
 void
@@ -691,6 +732,9 @@ void tap_cleanup(void)
 	tap_dissector_t *elem_dl;
 	tap_dissector_t *head_dl = tap_dissector_list;
 
+	dfilter_fields_free(tap_filter_fields);
+	tap_filter_fields = NULL;
+
 	while(head_lq){
 		elem_lq = head_lq;
 		head_lq = head_lq->next;
@@ -178,6 +178,12 @@ WS_DLL_PUBLIC void draw_tap_listeners(gboolean draw_all);
  *                   	set if your tap listener "packet" routine requires the column
  *                   	strings to be constructed.
  *
+ *                   	If your listener only looks up a few fields in the protocol
+ *                   	tree, set TL_REQUIRES_PROTO_TREE and declare those fields with
+ *                   	set_tap_interesting_hfids() rather than using a filter string
+ *                   	to make them visible; everything else is then faked, which is
+ *                   	much cheaper than building the full tree.
+ *
  *                       If no flags are needed, use TL_REQUIRES_NOTHING.
  *
  * @param tap_reset  void (*reset)(void *tapdata)
@@ -213,6 +219,18 @@ WS_DLL_PUBLIC GString *register_tap_listener(const char *tapname, void *tapdata,
 /** This function sets a new dfilter to a tap listener */
 WS_DLL_PUBLIC GString *set_tap_dfilter(void *tapdata, const char *fstring);
 
+/** This function sets the fields that a tap listener reads from the protocol
+ *  tree, e.g. with proto_get_finfo_ptr_array().  Only these fields (and the
+ *  fields used in the listener's filter) are guaranteed to be present in a
+ *  tree that isn't visible; all others may be faked.
+ *  Any previously set fields are replaced.
+ *
+ * @param tapdata    the instance identifier passed to register_tap_listener().
+ * @param hfids      the header field ids, or NULL to clear them.
+ * @param num_hfids  the number of entries in hfids.
+ */
+WS_DLL_PUBLIC void set_tap_interesting_hfids(void *tapdata, const int *hfids, guint num_hfids);
+
 /** This function recompiles dfilter for all registered tap listeners */
 WS_DLL_PUBLIC void tap_listeners_dfilter_recompile(void);
 
@@ -17,7 +17,14 @@
 
 #include "tvbuff.h"
 #include "exceptions.h"
+#include "crc32-tvb.h"
+#include "in_cksum.h"
 #include "wsutil/pint.h"
+#include "wsutil/crc32.h"
+#include "wsutil/crc32_int.h"
+#include "wsutil/ws_cksum_int.h"
+#include "wsutil/ws_memchr.h"
+#include "wsutil/ws_memchr_int.h"
 
 gboolean failed = FALSE;
 
@@ -301,10 +308,10 @@ run_tests(void)
 	guint		subset_length[6];
 	guint		subset_reported_length[6];
 	guint8		temp;
-	guint8		*comp[6];
-	tvbuff_t	*tvb_comp[6];
-	guint		comp_length[6];
-	guint		comp_reported_length[6];
+	guint8		*comp[7];
+	tvbuff_t	*tvb_comp[7];
+	guint		comp_length[7];
+	guint		comp_reported_length[7];
 	int		len;
 
 	tvb_parent = tvb_new_real_data("", 0, 0);
@@ -464,6 +471,19 @@ run_tests(void)
 	tvb_composite_append(tvb_comp[5], tvb_comp[3]);
 	tvb_composite_finalize(tvb_comp[5]);
 
+	/* Many small subsets */
+	printf("Making Composite 6\n");
+	tvb_comp[6]		= tvb_new_composite();
+	comp_length[6]		= 64 * 3;
+	comp_reported_length[6]	= 64 * 4;
+	comp[6]			= (guint8*)g_malloc(comp_length[6]);
+	for (i = 0; i < 64; i++) {
+		memcpy(&comp[6][i * 3], &small[i % 3][i % 13], 3);
+		tvb_composite_append(tvb_comp[6],
+		    tvb_new_subset_length_caplen(tvb_small[i % 3], i % 13, 3, 4));
+	}
+	tvb_composite_finalize(tvb_comp[6]);
+
 	/* Test the "composite" tvbuff objects. */
 	test(tvb_comp[0], "Composite 0", comp[0], comp_length[0], comp_reported_length[0]);
 	test(tvb_comp[1], "Composite 1", comp[1], comp_length[1], comp_reported_length[1]);
@@ -471,6 +491,7 @@ run_tests(void)
 	test(tvb_comp[3], "Composite 3", comp[3], comp_length[3], comp_reported_length[3]);
 	test(tvb_comp[4], "Composite 4", comp[4], comp_length[4], comp_reported_length[4]);
 	test(tvb_comp[5], "Composite 5", comp[5], comp_length[5], comp_reported_length[5]);
+	test(tvb_comp[6], "Composite 6", comp[6], comp_length[6], comp_reported_length[6]);
 
 	/* free memory. */
 	/* Don't free: comp[0] */
@@ -479,10 +500,494 @@ run_tests(void)
 	g_free(comp[3]);
 	g_free(comp[4]);
 	g_free(comp[5]);
+	g_free(comp[6]);
 
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
 
+/* Naive versions of the searches, to check the optimized ones against. */
+static gint
+naive_find_guint16(const guint8 *data, gint offset, gint limit, guint16 needle)
+{
+	gint i;
+
+	for (i = offset; i + 1 < offset + limit; i++) {
+		if (data[i] == (needle >> 8) && data[i + 1] == (needle & 0xFF))
+			return i;
+	}
+	return -1;
+}
+
+static gint
+naive_find_eol(const guint8 *data, gint offset, gint limit)
+{
+	gint i;
+
+	for (i = offset; i < offset + limit; i++) {
+		if (data[i] == '\r' || data[i] == '\n')
+			return i;
+	}
+	return -1;
+}
+
+/* Test tvb_find_guint16() and tvb_find_line_end() at every offset and
+ * with lengths that exercise both the vector and the scalar code paths. */
+static void
+run_find_tests(void)
+{
+	tvbuff_t	*tvb;
+	tvbuff_t	*tvb_sub;
+	guint8		*data;
+	const guint	 data_length = 300;
+	gint		 offset, limit, expected, got, linelen, next_offset;
+	guint		 i;
+
+	data = g_new(guint8, data_length);
+	for (i = 0; i < data_length; i++) {
+		data[i] = 'a' + (i % 23);
+	}
+	/* Line terminators and needles at assorted alignments. */
+	data[5] = '\n';
+	data[47] = '\r';
+	data[48] = '\n';
+	data[130] = '\r';
+	data[199] = '\r';
+	data[200] = '\n';
+	data[263] = '\n';
+	data[298] = '\r';
+	data[299] = '\n';
+
+	tvb = tvb_new_real_data(data, data_length, data_length);
+	tvb_set_free_cb(tvb, g_free);
+	tvb_sub = tvb_new_subset_remaining(tvb, 0);
+
+	for (offset = 0; offset < (gint) data_length; offset++) {
+		for (limit = 0; offset + limit <= (gint) data_length; limit += 7) {
+			expected = naive_find_guint16(data, offset, limit, 0x0D0A);
+			got = tvb_find_guint16(tvb, offset, limit, 0x0D0A);
+			if (got != expected) {
+				printf("Failed tvb_find_guint16(real, %d, %d) = %d, expected %d\n",
+				    offset, limit, got, expected);
+				failed = TRUE;
+				goto done;
+			}
+			got = tvb_find_guint16(tvb_sub, offset, limit, 0x0D0A);
+			if (got != expected) {
+				printf("Failed tvb_find_guint16(subset, %d, %d) = %d, expected %d\n",
+				    offset, limit, got, expected);
+				failed = TRUE;
+				goto done;
+			}
+
+			expected = naive_find_eol(data, offset, limit);
+			linelen = tvb_find_line_end(tvb_sub, offset, limit, &next_offset, FALSE);
+			if (expected == -1 ? linelen != limit : linelen != expected - offset) {
+				printf("Failed tvb_find_line_end(%d, %d) = %d, expected EOL at %d\n",
+				    offset, limit, linelen, expected);
+				failed = TRUE;
+				goto done;
+			}
+		}
+		/* -1 means search to the end of the tvbuff */
+		expected = naive_find_guint16(data, offset, data_length - offset, 0x0D0A);
+		got = tvb_find_guint16(tvb, offset, -1, 0x0D0A);
+		if (got != expected) {
+			printf("Failed tvb_find_guint16(real, %d, -1) = %d, expected %d\n",
+			    offset, got, expected);
+			failed = TRUE;
+			goto done;
+		}
+	}
+
+	printf("Passed find tests\n");
+
+done:
+	tvb_free_chain(tvb);
+}
+
+typedef const guint8 *(*memchr_kernel_t)(const guint8 *, size_t, guint8, guint8);
+
+static const guint8 *
+naive_memchr2(const guint8 *haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+	size_t i;
+
+	for (i = 0; i < haystacklen; i++) {
+		if (haystack[i] == c1 || haystack[i] == c2)
+			return haystack + i;
+	}
+	return NULL;
+}
+
+static const guint8 *
+naive_memchr_pair(const guint8 *haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < haystacklen; i++) {
+		if (haystack[i] == c1 && haystack[i + 1] == c2)
+			return haystack + i;
+	}
+	return NULL;
+}
+
+/* Test each ws_memchr2() and ws_memchr_pair() kernel directly, not just
+ * the ones the CPU we're running on picks, and the functions that pick
+ * them, against naive loops.  The
+ * haystack starts at every alignment within 64 bytes, its length
+ * crosses the 16-, 17-, 32- and 33-byte block sizes, and the needles
+ * are put at the block edges and just past the end of the haystack. */
+static void
+run_memchr_kernel_tests(void)
+{
+	static const struct {
+		const char	*name;
+		memchr_kernel_t	 memchr2;
+		memchr_kernel_t	 memchr_pair;
+		gboolean	 supported;
+	} kernels[] = {
+		{ "portable", ws_memchr2_portable, ws_memchr_pair_portable, TRUE },
+		{ "dispatch", ws_memchr2, ws_memchr_pair, TRUE },
+#ifdef WS_MEMCHR_SSE2
+		{ "sse2", ws_memchr2_sse2, ws_memchr_pair_sse2, TRUE },
+#endif
+#ifdef WS_MEMCHR_NEON
+		{ "neon", ws_memchr2_neon, ws_memchr_pair_neon, TRUE },
+#endif
+#ifdef HAVE_AVX2
+		{ "avx2", ws_memchr2_avx2, ws_memchr_pair_avx2, FALSE },
+#endif
+	};
+	static const gint positions[] = {
+		-1, 0, 1, 14, 15, 16, 17, 30, 31, 32, 33, 63, 64, 65, 96
+	};
+	guint8		 buf[256];
+	const guint8	*haystack;
+	const guint8	*expected, *got;
+	guint		 k, offset, p;
+	size_t		 len;
+	gint		 pos, i;
+	gboolean	 supported;
+	int		 pass;
+
+	for (k = 0; k < G_N_ELEMENTS(kernels); k++) {
+		supported = kernels[k].supported;
+#ifdef HAVE_AVX2
+		if (kernels[k].memchr2 == ws_memchr2_avx2)
+			supported = ws_memchr_avx2_supported();
+#endif
+		if (!supported)
+			continue;
+		for (offset = 0; offset < 64; offset++) {
+			haystack = buf + offset;
+			for (len = 0; offset + len + 2 <= sizeof buf && len <= 130; len++) {
+				/* Needles at each position, and at the end and just past it */
+				for (p = 0; p < G_N_ELEMENTS(positions) + 2; p++) {
+					if (p < G_N_ELEMENTS(positions))
+						pos = positions[p];
+					else
+						pos = (gint)len - 2 + (gint)(p - G_N_ELEMENTS(positions)) * 2;
+					if (pos >= (gint)len + 1)
+						continue;
+					/* 0: c1 alone; 1: a c1/c2 pair starting at pos;
+					 * 2: the same pair after a c1 every third byte,
+					 * which isn't followed by c2 */
+					for (pass = 0; pass < 3; pass++) {
+						memset(buf, 'a', sizeof buf);
+						if (pass == 2) {
+							for (i = 0; i < pos; i += 3)
+								buf[offset + i] = '\r';
+						}
+						if (pos >= 0) {
+							if (pass == 0) {
+								buf[offset + pos] = '\r';
+							} else {
+								buf[offset + pos] = '\r';
+								buf[offset + pos + 1] = '\n';
+							}
+						}
+
+						expected = naive_memchr2(haystack, len, '\r', '\n');
+						got = kernels[k].memchr2(haystack, len, '\r', '\n');
+						if (got != expected) {
+							printf("Failed ws_memchr2_%s(%u, %" G_GSIZE_FORMAT ", needle at %d) = %d, expected %d\n",
+							    kernels[k].name, offset, len, pos,
+							    got ? (int)(got - haystack) : -1,
+							    expected ? (int)(expected - haystack) : -1);
+							failed = TRUE;
+							return;
+						}
+						/* And with only the second byte */
+						expected = naive_memchr2(haystack, len, 'x', '\r');
+						got = kernels[k].memchr2(haystack, len, 'x', '\r');
+						if (got != expected) {
+							printf("Failed ws_memchr2_%s(%u, %" G_GSIZE_FORMAT ", second needle at %d) = %d, expected %d\n",
+							    kernels[k].name, offset, len, pos,
+							    got ? (int)(got - haystack) : -1,
+							    expected ? (int)(expected - haystack) : -1);
+							failed = TRUE;
+							return;
+						}
+
+						expected = naive_memchr_pair(haystack, len, '\r', '\n');
+						got = kernels[k].memchr_pair(haystack, len, '\r', '\n');
+						if (got != expected) {
+							printf("Failed ws_memchr_pair_%s(%u, %" G_GSIZE_FORMAT ", pair at %d) = %d, expected %d\n",
+							    kernels[k].name, offset, len, pos,
+							    got ? (int)(got - haystack) : -1,
+							    expected ? (int)(expected - haystack) : -1);
+							failed = TRUE;
+							return;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	printf("Passed memchr kernel tests\n");
+}
+
+/* Bit-at-a-time and word-at-a-time versions of the checksums, to check
+ * the optimized ones, and the tables, against. */
+static guint32
+reference_crc32_reflected(const guint8 *data, size_t len, guint32 crc, guint32 poly)
+{
+	size_t i;
+	int bit;
+
+	for (i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (poly & (0U - (crc & 1)));
+	}
+	return crc;
+}
+
+static guint32
+reference_crc32c(const guint8 *data, size_t len, guint32 crc)
+{
+	return reference_crc32_reflected(data, len, crc, 0x82F63B78);
+}
+
+static guint32
+reference_crc32_ccitt(const guint8 *data, size_t len)
+{
+	return ~reference_crc32_reflected(data, len, CRC32_CCITT_SEED, 0xEDB88320);
+}
+
+/* The ones'-complement sum of the whole 16-bit words, folded to 16 bits */
+static guint16
+reference_sum16(const guint8 *data, size_t len)
+{
+	guint64 sum = 0;
+	guint16 word;
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		memcpy(&word, data + i, sizeof word);
+		sum += word;
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (guint16)sum;
+}
+
+static guint16
+reference_in_cksum(const guint8 *data, guint len)
+{
+	guint32 sum = 0;
+	guint16 word;
+	guint8 last[2];
+	guint i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		memcpy(&word, data + i, sizeof word);
+		sum += word;
+	}
+	if (len & 1) {
+		last[0] = data[len - 1];
+		last[1] = 0;
+		memcpy(&word, last, sizeof word);
+		sum += word;
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return ~sum & 0xffff;
+}
+
+/* Test the CRC32C, CRC-32 and Internet checksums, which have vectorized
+ * versions, at every offset and with lengths that exercise both the
+ * vector and the scalar code paths. */
+static void
+run_cksum_tests(void)
+{
+	tvbuff_t	*tvb;
+	guint8		*data;
+	const guint	 data_length = 1100;
+	guint		 offset, len, split, i;
+	guint32		 expected, got;
+	vec_t		 cksum_vec[3];
+
+	data = g_new(guint8, data_length);
+	for (i = 0; i < data_length; i++) {
+		data[i] = (guint8)(i * 131 + (i >> 8) * 7 + 0x5a);
+	}
+
+	tvb = tvb_new_real_data(data, data_length, data_length);
+	tvb_set_free_cb(tvb, g_free);
+
+	for (offset = 0; offset < 16; offset++) {
+		for (len = 0; offset + len <= data_length; len += (len < 300 ? 1 : 67)) {
+			expected = reference_crc32c(data + offset, len, CRC32C_PRELOAD);
+			got = crc32c_calculate_no_swap(data + offset, len, CRC32C_PRELOAD);
+			if (got != expected) {
+				printf("Failed crc32c_calculate_no_swap(%u, %u) = 0x%08x, expected 0x%08x\n",
+				    offset, len, got, expected);
+				failed = TRUE;
+				goto done;
+			}
+
+			expected = reference_crc32_ccitt(data + offset, len);
+			got = crc32_ccitt_tvb_offset(tvb, offset, len);
+			if (got != expected) {
+				printf("Failed crc32_ccitt_tvb_offset(%u, %u) = 0x%08x, expected 0x%08x\n",
+				    offset, len, got, expected);
+				failed = TRUE;
+				goto done;
+			}
+
+			expected = reference_in_cksum(data + offset, len);
+			got = ip_checksum_tvb(tvb, offset, len);
+			if (got != expected) {
+				printf("Failed ip_checksum_tvb(%u, %u) = 0x%04x, expected 0x%04x\n",
+				    offset, len, got, expected);
+				failed = TRUE;
+				goto done;
+			}
+
+			/* Odd and even splits into several pieces */
+			for (split = 0; split <= len; split += 5) {
+				SET_CKSUM_VEC_PTR(cksum_vec[0], data + offset, split / 2);
+				SET_CKSUM_VEC_PTR(cksum_vec[1], data + offset + split / 2, split - split / 2);
+				SET_CKSUM_VEC_PTR(cksum_vec[2], data + offset + split, len - split);
+				got = in_cksum(cksum_vec, 3);
+				if (got != expected) {
+					printf("Failed in_cksum(%u, %u, split at %u) = 0x%04x, expected 0x%04x\n",
+					    offset, len, split, got, expected);
+					failed = TRUE;
+					goto done;
+				}
+			}
+		}
+	}
+
+	printf("Passed checksum tests\n");
+
+done:
+	tvb_free_chain(tvb);
+}
+
+static gboolean
+check_cksum_kernel(const char *name, guint offset, size_t len,
+    guint32 got, guint32 expected)
+{
+	if (got == expected)
+		return TRUE;
+	printf("Failed %s(%u, %" G_GSIZE_FORMAT ") = 0x%08x, expected 0x%08x\n",
+	    name, offset, len, got, expected);
+	failed = TRUE;
+	return FALSE;
+}
+
+/* Test each checksum kernel directly, not just the one that the CPU
+ * we're running on picks, and the AVX2 sum on either side of the length
+ * at which it has to empty its 32-bit lanes (MAX_BLOCKS_PER_PASS 32-byte
+ * blocks, 1 MiB). */
+static void
+run_cksum_kernel_tests(void)
+{
+	static const size_t long_lengths[] = {
+		1024 * 1024 - 34, 1024 * 1024 - 32, 1024 * 1024 - 1,
+		1024 * 1024, 1024 * 1024 + 2, 1024 * 1024 + 32, 1024 * 1024 + 63,
+		2 * 1024 * 1024, 2 * 1024 * 1024 + 64 + 6
+	};
+	const size_t	 data_length = 2 * 1024 * 1024 + 256;
+	guint8		*data;
+	guint		 offset, i;
+	size_t		 len;
+	guint32		 expected;
+
+	data = (guint8 *)g_malloc(data_length);
+	for (i = 0; i < 1200; i++) {
+		data[i] = (guint8)(i * 131 + (i >> 8) * 7 + 0x5a);
+	}
+
+	for (offset = 0; offset < 16; offset++) {
+		for (len = 0; offset + len <= 1200; len += (len < 300 ? 1 : 67)) {
+			expected = reference_crc32c(data + offset, len, CRC32C_PRELOAD);
+			if (!check_cksum_kernel("ws_crc32c_portable", offset, len,
+			    ws_crc32c_portable(data + offset, len, CRC32C_PRELOAD), expected))
+				goto done;
+#ifdef HAVE_SSE4_2
+			if (ws_crc32c_sse42_supported() &&
+			    !check_cksum_kernel("ws_crc32c_sse42", offset, len,
+			    ws_crc32c_sse42(data + offset, len, CRC32C_PRELOAD), expected))
+				goto done;
+#endif
+
+			expected = ~reference_crc32_ccitt(data + offset, len);
+			if (!check_cksum_kernel("ws_crc32_ccitt_portable", offset, len,
+			    ws_crc32_ccitt_portable(data + offset, len, CRC32_CCITT_SEED), expected))
+				goto done;
+#ifdef HAVE_PCLMUL
+			if (len >= 64 && len % 16 == 0 && ws_crc32_pclmul_supported() &&
+			    !check_cksum_kernel("ws_crc32_pclmul", offset, len,
+			    ws_crc32_pclmul(data + offset, len, CRC32_CCITT_SEED), expected))
+				goto done;
+#endif
+
+			expected = reference_sum16(data + offset, len);
+			if (!check_cksum_kernel("ws_cksum_sum16_portable", offset, len,
+			    ws_cksum_sum16_portable(data + offset, len), expected))
+				goto done;
+#ifdef HAVE_AVX2
+			if (ws_cksum_avx2_supported() &&
+			    !check_cksum_kernel("ws_cksum_sum16_avx2", offset, len,
+			    ws_cksum_sum16_avx2(data + offset, len), expected))
+				goto done;
+#endif
+		}
+	}
+
+	/* Words of 0xffff fill the lanes fastest; a carry lost from a lane
+	 * changes the sum by 1. */
+	memset(data, 0xff, data_length);
+	for (i = 0; i < data_length; i += 4099) {
+		data[i] = (guint8)i;
+	}
+	for (offset = 0; offset < 2; offset++) {
+		for (i = 0; i < G_N_ELEMENTS(long_lengths); i++) {
+			len = long_lengths[i];
+			expected = reference_sum16(data + offset, len);
+			if (!check_cksum_kernel("ws_cksum_sum16_portable", offset, len,
+			    ws_cksum_sum16_portable(data + offset, len), expected))
+				goto done;
+#ifdef HAVE_AVX2
+			if (ws_cksum_avx2_supported() &&
+			    !check_cksum_kernel("ws_cksum_sum16_avx2", offset, len,
+			    ws_cksum_sum16_avx2(data + offset, len), expected))
+				goto done;
+#endif
+		}
+	}
+
+	printf("Passed checksum kernel tests\n");
+
+done:
+	g_free(data);
+}
+
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
 main(void)
@@ -493,6 +998,10 @@ main(void)
 
 	except_init();
 	run_tests();
+	run_find_tests();
+	run_memchr_kernel_tests();
+	run_cksum_tests();
+	run_cksum_kernel_tests();
 	except_deinit();
 	exit(failed?1:0);
 }
@@ -95,4 +95,6 @@ void tvb_add_to_chain(tvbuff_t *parent, tvbuff_t *child);
 guint tvb_offset_from_real_beginning_counter(const tvbuff_t *tvb, const guint counter);
 
 void tvb_check_offset_length(const tvbuff_t *tvb, const gint offset, gint const length_val, guint *offset_ptr, guint *length_ptr);
+
+void tvb_uncompress_cache_cleanup(void);
 #endif
@@ -880,6 +880,20 @@ WS_DLL_PUBLIC tvbuff_t *tvb_uncompress(tvbuff_t *tvb, const int offset,
 WS_DLL_PUBLIC tvbuff_t *tvb_child_uncompress(tvbuff_t *parent, tvbuff_t *tvb,
     const int offset, int comprlen);
 
+/**
+ * Like tvb_child_uncompress(), but the uncompressed data is kept in a
+ * size-bounded cache so that later dissections of the same frame don't
+ * have to decompress it again.  frame_num and layer_num are the number
+ * of the frame being dissected and the current layer number in it
+ * (pinfo->num and pinfo->curr_layer_num), and key distinguishes multiple
+ * compressed blocks in the same layer (e.g. a stream ID).  Together with
+ * offset, comprlen and the compressed data itself they identify the
+ * cache entry.
+ */
+WS_DLL_PUBLIC tvbuff_t *tvb_child_uncompress_cached(tvbuff_t *parent,
+    tvbuff_t *tvb, const int offset, int comprlen, guint32 frame_num,
+    guint8 layer_num, guint32 key);
+
 /* From tvbuff_base64.c */
 
 /** Return a tvb that contains the binary representation of a base64
@@ -15,15 +15,30 @@
 #include "tvbuff-int.h"
 #include "proto.h"	/* XXX - only used for DISSECTOR_ASSERT, probably a new header file? */
 
+/*
+ * Once the bytes read through the member tvbuffs add up to more than
+ * 1/COMPOSITE_FLATTEN_DIVISOR of the composite's length, the composite
+ * is copied into one contiguous buffer, so that further accesses don't
+ * have to go through the members at all.
+ */
+#define COMPOSITE_FLATTEN_DIVISOR	4
+
 typedef struct {
 	GSList		*tvbs;
 
 	/* Used for quick testing to see if this
 	 * is the tvbuff that a COMPOSITE is
-	 * interested in. */
+	 * interested in.  Filled in by tvb_composite_finalize();
+	 * the offsets are in increasing order, so they can be
+	 * searched with a binary search. */
+	guint		 num_members;
+	tvbuff_t	**members;
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* Number of bytes read through the member tvbuffs. */
+	guint		 bytes_accessed;
+
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -40,6 +55,7 @@ composite_free(tvbuff_t *tvb)
 
 	g_slist_free(composite->tvbs);
 
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
 	if (tvb->real_data) {
@@ -59,51 +75,89 @@ composite_offset(const tvbuff_t *tvb, const guint counter)
 	return tvb_offset_from_real_beginning_counter(member, counter);
 }
 
+/*
+ * Find the index of the member tvbuff containing abs_offset, or
+ * num_members if abs_offset is past the end of the last member.
+ */
+static guint
+composite_find_member(const tvb_comp_t *composite, guint abs_offset)
+{
+	guint low = 0;
+	guint high = composite->num_members;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (abs_offset > composite->end_offsets[mid])
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/*
+ * Copy all the members into one buffer and make that the composite's
+ * real data.
+ */
+static void
+composite_flatten(tvbuff_t *tvb)
+{
+	/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
+	void *real_data = g_malloc(tvb->length);
+	tvb_memcpy(tvb, real_data, 0, tvb->length);
+	tvb->real_data = (const guint8 *)real_data;
+}
+
+static void
+composite_account_access(tvbuff_t *tvb, tvb_comp_t *composite, guint abs_length)
+{
+	composite->bytes_accessed += abs_length;
+	if (composite->bytes_accessed > tvb->length / COMPOSITE_FLATTEN_DIVISOR)
+		composite_flatten(tvb);
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
 		/*
 		 * The range is, in fact, contiguous within member_tvb.
 		 */
+		const guint8 *ptr;
+
 		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_get_ptr(member_tvb, member_offset, abs_length);
+		ptr = tvb_get_ptr(member_tvb, member_offset, abs_length);
+		composite_account_access(tvb, composite, abs_length);
+		/* If we've just been flattened, the member data is still
+		 * valid, so the pointer can be returned as is. */
+		return ptr;
 	}
 	else {
-		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
-		void *real_data = g_malloc(tvb->length);
-		tvb_memcpy(tvb, real_data, 0, tvb->length);
-		tvb->real_data = (const guint8 *)real_data;
+		composite_flatten(tvb);
 		return tvb->real_data + abs_offset;
 	}
 
@@ -116,63 +170,60 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
+	guint	    total_length = abs_length;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
-	member_offset = abs_offset - composite->start_offsets[i];
+	DISSECTOR_ASSERT(!tvb->real_data);
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
-		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
-	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
+	/*
+	 * Copy the part that's in the first member tvb, then walk
+	 * across the following member tvbs, copying their portions
+	 * until we have copied all data.
+	 */
+	member_offset = abs_offset - composite->start_offsets[i];
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->num_members);
+		member_tvb = composite->members[i];
 		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
 
-		/* composite_memcpy() can't handle a member_length of zero. */
+		/* We can't handle a member_length of zero. */
 		DISSECTOR_ASSERT(member_length > 0);
 
+		if (member_length > abs_length)
+			member_length = abs_length;
+
 		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
+		target		+= member_length;
 		abs_length	-= member_length;
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
-
-		return target;
+		member_offset = 0;
+		i++;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	/*
+	 * Don't count a copy of the entire composite, which is what
+	 * composite_flatten() itself does.
+	 */
+	if (total_length != tvb->length)
+		composite_account_access(tvb, composite, total_length);
+
+	return _target;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -202,9 +253,12 @@ tvb_new_composite(void)
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
 
-	composite->tvbs		 = NULL;
-	composite->start_offsets = NULL;
-	composite->end_offsets	 = NULL;
+	composite->tvbs		  = NULL;
+	composite->num_members	  = 0;
+	composite->members	  = NULL;
+	composite->start_offsets  = NULL;
+	composite->end_offsets	  = NULL;
+	composite->bytes_accessed = 0;
 
 	return tvb;
 }
@@ -270,12 +324,15 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->num_members = num_members;
+	composite->members = g_new(tvbuff_t *, num_members);
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
 	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
 		DISSECTOR_ASSERT((guint) i < num_members);
 		member_tvb = (tvbuff_t *)slist->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
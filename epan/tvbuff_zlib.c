@@ -20,7 +20,10 @@
 #include <zlib.h>
 #endif
 
+#include <wsutil/crc32.h>
+
 #include "tvbuff.h"
+#include "tvbuff-int.h"
 #ifdef TVB_Z_DEBUG
 #include <wsutil/ws_printf.h> /* ws_debug_printf */
 #endif
@@ -333,6 +336,187 @@ tvb_child_uncompress(tvbuff_t *parent, tvbuff_t *tvb, const int offset, int comp
 	return new_tvb;
 }
 
+/*
+ * Cache of decompressed data, shared across re-dissections of the same
+ * frame.  Entries are keyed by frame number, layer number, a
+ * dissector-chosen key, the location of the compressed data and the
+ * compressed data itself; the offset alone doesn't say which tvbuff the
+ * data came from (several decrypted records in a frame can each start at
+ * offset 0).  Entries are evicted in least recently used order once the
+ * cache grows past TVB_UNCOMPRESS_CACHE_MAX_SIZE.  Failed decompressions
+ * are cached as well, so that we don't retry them.
+ */
+#define TVB_UNCOMPRESS_CACHE_MAX_SIZE	(32 * 1024 * 1024)
+
+typedef struct {
+	guint32		frame_num;
+	guint8		layer_num;
+	guint32		key;
+	gint		offset;
+	gint		comprlen;
+	guint32		compr_hash;	/* CRC32C of the compressed data */
+	const guint8	*compr_data;	/* comprlen bytes */
+} uncompress_cache_key_t;
+
+typedef struct {
+	uncompress_cache_key_t	key;
+	guint8		*data;		/* NULL if decompression failed */
+	guint		length;
+	GList		link;		/* position in the LRU queue */
+} uncompress_cache_entry_t;
+
+static GHashTable *uncompress_cache_table = NULL;
+static GQueue uncompress_cache_lru = G_QUEUE_INIT;
+static gsize uncompress_cache_size = 0;
+
+static guint
+uncompress_cache_hash(gconstpointer k)
+{
+	const uncompress_cache_key_t *key = (const uncompress_cache_key_t *)k;
+	guint hash_val;
+
+	hash_val = key->frame_num;
+	hash_val = (hash_val * 31) + key->layer_num;
+	hash_val = (hash_val * 31) + key->key;
+	hash_val = (hash_val * 31) + (guint)key->offset;
+	hash_val = (hash_val * 31) + (guint)key->comprlen;
+	hash_val = (hash_val * 31) + key->compr_hash;
+	return hash_val;
+}
+
+static gboolean
+uncompress_cache_equal(gconstpointer k1, gconstpointer k2)
+{
+	const uncompress_cache_key_t *key1 = (const uncompress_cache_key_t *)k1;
+	const uncompress_cache_key_t *key2 = (const uncompress_cache_key_t *)k2;
+
+	return key1->frame_num == key2->frame_num &&
+	    key1->layer_num == key2->layer_num &&
+	    key1->key == key2->key &&
+	    key1->offset == key2->offset &&
+	    key1->comprlen == key2->comprlen &&
+	    key1->compr_hash == key2->compr_hash &&
+	    (key1->comprlen == 0 ||
+	     memcmp(key1->compr_data, key2->compr_data, key1->comprlen) == 0);
+}
+
+static void
+uncompress_cache_free_entry(gpointer data)
+{
+	uncompress_cache_entry_t *entry = (uncompress_cache_entry_t *)data;
+
+	g_queue_unlink(&uncompress_cache_lru, &entry->link);
+	uncompress_cache_size -= entry->length + entry->key.comprlen;
+	g_free((guint8 *)entry->key.compr_data);
+	g_free(entry->data);
+	g_free(entry);
+}
+
+static tvbuff_t *
+uncompress_cache_entry_to_tvb(const uncompress_cache_entry_t *entry)
+{
+	guint8 *data;
+	tvbuff_t *tvb;
+
+	if (entry->data == NULL)
+		return NULL;
+
+	/*
+	 * Hand out a copy; the entry may be evicted while the tvbuff
+	 * is still in use.
+	 */
+	data = entry->length ? (guint8 *)g_memdup(entry->data, entry->length) :
+	    (guint8 *)g_strdup("");
+	tvb = tvb_new_real_data(data, entry->length, entry->length);
+	tvb_set_free_cb(tvb, g_free);
+	return tvb;
+}
+
+tvbuff_t *
+tvb_child_uncompress_cached(tvbuff_t *parent, tvbuff_t *tvb, const int offset,
+    int comprlen, guint32 frame_num, guint8 layer_num, guint32 key)
+{
+	uncompress_cache_key_t lookup_key;
+	uncompress_cache_entry_t *entry;
+	gsize entry_size;
+	tvbuff_t *new_tvb;
+
+	if (comprlen < 0 || tvb_captured_length_remaining(tvb, offset) < comprlen) {
+		/* Let tvb_uncompress() deal with it; don't cache. */
+		return tvb_child_uncompress(parent, tvb, offset, comprlen);
+	}
+
+	if (uncompress_cache_table == NULL) {
+		uncompress_cache_table = g_hash_table_new_full(uncompress_cache_hash,
+		    uncompress_cache_equal, NULL, uncompress_cache_free_entry);
+	}
+
+	lookup_key.frame_num = frame_num;
+	lookup_key.layer_num = layer_num;
+	lookup_key.key = key;
+	lookup_key.offset = offset;
+	lookup_key.comprlen = comprlen;
+	lookup_key.compr_data = tvb_get_ptr(tvb, offset, comprlen);
+	lookup_key.compr_hash = crc32c_calculate_no_swap(lookup_key.compr_data,
+	    comprlen, CRC32C_PRELOAD);
+
+	entry = (uncompress_cache_entry_t *)g_hash_table_lookup(uncompress_cache_table, &lookup_key);
+	if (entry != NULL) {
+		/* Move it to the front of the LRU queue. */
+		g_queue_unlink(&uncompress_cache_lru, &entry->link);
+		g_queue_push_head_link(&uncompress_cache_lru, &entry->link);
+		new_tvb = uncompress_cache_entry_to_tvb(entry);
+		if (new_tvb)
+			tvb_set_child_real_data_tvbuff(parent, new_tvb);
+		return new_tvb;
+	}
+
+	new_tvb = tvb_uncompress(tvb, offset, comprlen);
+
+	entry = g_new0(uncompress_cache_entry_t, 1);
+	entry->key = lookup_key;
+	entry->key.compr_data = (const guint8 *)g_memdup(lookup_key.compr_data, comprlen);
+	entry->link.data = entry;
+	if (new_tvb) {
+		entry->length = tvb_captured_length(new_tvb);
+		entry->data = (guint8 *)tvb_memdup(NULL, new_tvb, 0, entry->length);
+		if (entry->data == NULL)
+			entry->data = (guint8 *)g_strdup("");
+	}
+
+	/* The compressed copy counts towards the size as well. */
+	entry_size = entry->length + (gsize)comprlen;
+	if (entry_size > TVB_UNCOMPRESS_CACHE_MAX_SIZE) {
+		/* Too big to ever fit; don't bother. */
+		g_free((guint8 *)entry->key.compr_data);
+		g_free(entry->data);
+		g_free(entry);
+	} else {
+		while (uncompress_cache_size + entry_size > TVB_UNCOMPRESS_CACHE_MAX_SIZE) {
+			uncompress_cache_entry_t *oldest =
+			    (uncompress_cache_entry_t *)g_queue_peek_tail(&uncompress_cache_lru);
+			g_hash_table_remove(uncompress_cache_table, &oldest->key);
+		}
+		g_queue_push_head_link(&uncompress_cache_lru, &entry->link);
+		uncompress_cache_size += entry_size;
+		g_hash_table_insert(uncompress_cache_table, &entry->key, entry);
+	}
+
+	if (new_tvb)
+		tvb_set_child_real_data_tvbuff(parent, new_tvb);
+	return new_tvb;
+}
+
+void
+tvb_uncompress_cache_cleanup(void)
+{
+	if (uncompress_cache_table != NULL) {
+		g_hash_table_destroy(uncompress_cache_table);
+		uncompress_cache_table = NULL;
+	}
+	uncompress_cache_size = 0;
+}
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
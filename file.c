@@ -21,9 +21,11 @@
 #include <wsutil/tempfile.h>
 #include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
+#include <wsutil/ws_memchr.h>
 #include <version_info.h>
 
 #include <wiretap/merge.h>
+#include <wiretap/wtap_index.h>
 
 #include <epan/exceptions.h>
 #include <epan/epan.h>
@@ -84,15 +86,23 @@ static match_result match_protocol_tree(capture_file *cf, frame_data *fdata,
 static void match_subtree_text(proto_node *node, gpointer data);
 static match_result match_summary_line(capture_file *cf, frame_data *fdata,
     void *criterion);
-static match_result match_narrow_and_wide(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_narrow(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_wide(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_binary(capture_file *cf, frame_data *fdata,
-    void *criterion);
-static match_result match_regex(capture_file *cf, frame_data *fdata,
+typedef struct {
+    const guint8 *data;
+    size_t        data_len;
+} cbs_t;    /* "Counted byte string" */
+typedef gboolean (*match_data_func)(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static gboolean match_narrow_and_wide(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static gboolean match_narrow(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static gboolean match_wide(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static gboolean match_binary(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static gboolean match_regex(capture_file *cf, const cbs_t *info,
+    const guint8 *pd, guint32 buf_len, guint32 *search_pos, guint32 *search_len);
+static match_result match_packet_data(capture_file *cf, frame_data *fdata,
     void *criterion);
 static match_result match_dfilter(capture_file *cf, frame_data *fdata,
     void *criterion);
@@ -103,6 +113,9 @@ static match_result match_time_reference(capture_file *cf, frame_data *fdata,
 static gboolean find_packet(capture_file *cf,
     match_result (*match_function)(capture_file *, frame_data *, void *),
     void *criterion, search_direction dir);
+static gboolean find_packet_data(capture_file *cf, match_data_func match_function,
+    const cbs_t *info, search_direction dir);
+static gboolean select_found_packet(capture_file *cf, frame_data *new_fd);
 
 static void cf_rename_failure_alert_box(const char *filename, int err);
 static void ref_time_packets(capture_file *cf);
@@ -113,6 +126,11 @@ static void ref_time_packets(capture_file *cf);
 /* Show the progress bar after this many seconds. */
 #define PROGBAR_SHOW_DELAY 0.5
 
+/* Microseconds spent reading new records during a live capture before
+   returning to the UI, and how often (in records) we check. */
+#define TAIL_READ_TIME_LIMIT (100 * 1000)
+#define TAIL_READ_CHECK_INTERVAL 256
+
 /*
  * We could probably use g_signal_...() instead of the callbacks below but that
  * would require linking our CLI programs to libgobject and creating an object
@@ -499,6 +517,7 @@ cf_read(capture_file *cf, gboolean reloading)
   guint                tap_flags;
   gboolean             compiled;
   volatile gboolean    is_read_aborted = FALSE;
+  wtap_index_writer_t *volatile index_writer = NULL;
 
   /* The update_progress_dlg call below might end up accepting a user request to
    * trigger redissection/rescans which can modify/destroy the dissection
@@ -560,6 +579,12 @@ cf_read(capture_file *cf, gboolean reloading)
 
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
+  /* If we've been asked to, write a packet index as we go, so that the
+     next program to open this file can find its packets without reading
+     all of it. */
+  if (prefs.capture_packet_index && !cf->is_tempfile)
+    index_writer = wtap_index_writer_new(cf->provider.wth, cf->filename);
+
   TRY {
     int     count             = 0;
 
@@ -635,6 +660,8 @@ cf_read(capture_file *cf, gboolean reloading)
            hours even on fast machines) just to see that it was the wrong file. */
         break;
       }
+      if (index_writer != NULL)
+        wtap_index_writer_add(index_writer, cf->provider.wth, data_offset);
       read_record(cf, dfcode, &edt, cinfo, data_offset);
     }
   }
@@ -665,6 +692,14 @@ cf_read(capture_file *cf, gboolean reloading)
     destroy_progress_dlg(progbar);
   g_timer_destroy(prog_timer);
 
+  /* Only keep the packet index if we read the whole file. */
+  if (index_writer != NULL) {
+    if (err == 0 && !cf->stop_flag && !is_read_aborted)
+      wtap_index_writer_finish(index_writer);
+    else
+      wtap_index_writer_abort(index_writer);
+  }
+
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
 
@@ -742,10 +777,12 @@ cf_read(capture_file *cf, gboolean reloading)
 
 #ifdef HAVE_LIBPCAP
 cf_read_status_t
-cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
+cf_continue_tail(capture_file *cf, int *to_read, int *err)
 {
   gchar            *err_info;
   volatile int      newly_displayed_packets = 0;
+  volatile int      records_left = *to_read;
+  gint64            deadline;
   dfilter_t        *dfcode;
   epan_dissect_t    edt;
   gboolean          create_proto_tree;
@@ -788,6 +825,11 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
 
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
+  /* Give the UI a chance to catch up (and to show what we've read so far)
+     at high packet rates rather than dissecting everything the child has
+     written in one go. */
+  deadline = g_get_monotonic_time() + TAIL_READ_TIME_LIMIT;
+
   TRY {
     gint64 data_offset = 0;
     column_info *cinfo;
@@ -795,9 +837,15 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
     /* If any tap listeners require the columns, construct them. */
     cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
 
-    while (to_read != 0) {
+    while (records_left != 0) {
+      if ((records_left % TAIL_READ_CHECK_INTERVAL) == 0 &&
+          records_left != *to_read && g_get_monotonic_time() > deadline) {
+        break;
+      }
       wtap_cleareof(cf->provider.wth);
       if (!wtap_read(cf->provider.wth, err, &err_info, &data_offset)) {
+        /* Don't come back for records we couldn't read. */
+        records_left = 0;
         break;
       }
       if (cf->state == FILE_READ_ABORTED) {
@@ -809,7 +857,7 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
       if (read_record(cf, dfcode, &edt, (column_info *) cinfo, data_offset)) {
         newly_displayed_packets++;
       }
-      to_read--;
+      records_left--;
     }
   }
   CATCH(OutOfMemoryError) {
@@ -836,6 +884,8 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
 
   epan_dissect_cleanup(&edt);
 
+  *to_read = records_left;
+
   /*g_log(NULL, G_LOG_LEVEL_MESSAGE, "cf_continue_tail: count %u state: %u err: %u",
     cf->count, cf->state, *err);*/
 
@@ -3192,12 +3242,6 @@ match_summary_line(capture_file *cf, frame_data *fdata, void *criterion)
   return result;
 }
 
-typedef struct {
-    const guint8 *data;
-    size_t        data_len;
-} cbs_t;    /* "Counted byte string" */
-
-
 /*
  * The current match_* routines only support ASCII case insensitivity and don't
  * convert UTF-8 inputs to UTF-16 for matching.
@@ -3220,50 +3264,43 @@ cf_find_packet_data(capture_file *cf, const guint8 *string, size_t string_size,
   /* Regex, String or hex search? */
   if (cf->regex) {
     /* Regular Expression search */
-    return find_packet(cf, match_regex, NULL, dir);
+    return find_packet_data(cf, match_regex, &info, dir);
   } else if (cf->string) {
     /* String search - what type of string? */
     switch (cf->scs_type) {
 
     case SCS_NARROW_AND_WIDE:
-      return find_packet(cf, match_narrow_and_wide, &info, dir);
+      return find_packet_data(cf, match_narrow_and_wide, &info, dir);
 
     case SCS_NARROW:
-      return find_packet(cf, match_narrow, &info, dir);
+      return find_packet_data(cf, match_narrow, &info, dir);
 
     case SCS_WIDE:
-      return find_packet(cf, match_wide, &info, dir);
+      return find_packet_data(cf, match_wide, &info, dir);
 
     default:
       g_assert_not_reached();
       return FALSE;
     }
   } else
-    return find_packet(cf, match_binary, &info, dir);
+    return find_packet_data(cf, match_binary, &info, dir);
 }
 
-static match_result
-match_narrow_and_wide(capture_file *cf, frame_data *fdata, void *criterion)
+/*
+ * The match_* routines below look for a string in a packet's data.
+ * They only read the capture_file's search settings, so they can be
+ * called from the find_packet_data() worker threads.
+ */
+static gboolean
+match_narrow_and_wide(capture_file *cf, const cbs_t *info, const guint8 *pd,
+                      guint32 buf_len, guint32 *search_pos, guint32 *search_len)
 {
-  cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
   guint32       i;
   guint8        c_char;
   size_t        c_match    = 0;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
-
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
   i = 0;
   while (i < buf_len) {
     c_char = pd[i];
@@ -3273,11 +3310,10 @@ match_narrow_and_wide(capture_file *cf, frame_data *fdata, void *criterion)
       if (c_char == ascii_text[c_match]) {
         c_match += 1;
         if (c_match == textlen) {
-          result = MR_MATCHED;
-          cf->search_pos = i; /* Save the position of the last character
-                                 for highlighting the field. */
-          cf->search_len = (guint32)textlen;
-          break;
+          *search_pos = i; /* Save the position of the last character
+                              for highlighting the field. */
+          *search_len = (guint32)textlen;
+          return TRUE;
         }
       }
       else {
@@ -3288,79 +3324,58 @@ match_narrow_and_wide(capture_file *cf, frame_data *fdata, void *criterion)
     }
     i += 1;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_narrow(capture_file *cf, frame_data *fdata, void *criterion)
+static gboolean
+match_narrow(capture_file *cf, const cbs_t *info, const guint8 *pd,
+             guint32 buf_len, guint32 *search_pos, guint32 *search_len)
 {
-  guint8       *pd;
-  cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint32       i;
-  guint8        c_char;
-  size_t        c_match    = 0;
+  const guint8 *cur        = pd;
+  const guint8 *end        = pd + buf_len;
+  guint8        first_lower;
+  size_t        i;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
+  if (textlen == 0)
+    return FALSE;
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = g_ascii_toupper(c_char);
-    if (c_char == ascii_text[c_match]) {
-      c_match += 1;
-      if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
+  /* The search string has already been converted to upper case for
+     case-insensitive searches, so look for either case of its first
+     character and then check the rest. */
+  first_lower = cf->case_type ? g_ascii_tolower(ascii_text[0]) : ascii_text[0];
+  while ((size_t)(end - cur) >= textlen &&
+         (cur = ws_memchr2(cur, (size_t)(end - cur), ascii_text[0], first_lower)) != NULL &&
+         (size_t)(end - cur) >= textlen) {
+    for (i = 1; i < textlen; i++) {
+      guint8 c_char = cur[i];
+      if (cf->case_type)
+        c_char = g_ascii_toupper(c_char);
+      if (c_char != ascii_text[i])
         break;
-      }
     }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
+    if (i == textlen) {
+      *search_pos = (guint32)(cur - pd + textlen - 1); /* Save the position of the last
+                                                          character for highlighting the field. */
+      *search_len = (guint32)textlen;
+      return TRUE;
     }
-    i += 1;
+    cur++;
   }
-
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_wide(capture_file *cf, frame_data *fdata, void *criterion)
+static gboolean
+match_wide(capture_file *cf, const cbs_t *info, const guint8 *pd,
+           guint32 buf_len, guint32 *search_pos, guint32 *search_len)
 {
-  cbs_t        *info       = (cbs_t *)criterion;
   const guint8 *ascii_text = info->data;
   size_t        textlen    = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
   guint32       i;
   guint8        c_char;
   size_t        c_match    = 0;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
-
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
   i = 0;
   while (i < buf_len) {
     c_char = pd[i];
@@ -3369,11 +3384,10 @@ match_wide(capture_file *cf, frame_data *fdata, void *criterion)
     if (c_char == ascii_text[c_match]) {
       c_match += 1;
       if (c_match == textlen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)textlen;
-        break;
+        *search_pos = i; /* Save the position of the last character
+                            for highlighting the field. */
+        *search_len = (guint32)textlen;
+        return TRUE;
       }
       i += 1;
     }
@@ -3384,76 +3398,77 @@ match_wide(capture_file *cf, frame_data *fdata, void *criterion)
     }
     i += 1;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_binary(capture_file *cf, frame_data *fdata, void *criterion)
+static gboolean
+match_binary(capture_file *cf _U_, const cbs_t *info, const guint8 *pd,
+             guint32 buf_len, guint32 *search_pos, guint32 *search_len)
 {
-  cbs_t        *info        = (cbs_t *)criterion;
   const guint8 *binary_data = info->data;
   size_t        datalen     = info->data_len;
-  match_result  result;
-  guint32       buf_len;
-  guint8       *pd;
-  guint32       i;
-  size_t        c_match     = 0;
+  const guint8 *cur         = pd;
+  const guint8 *end         = pd + buf_len;
 
-  /* Load the frame's data. */
-  if (!cf_read_record(cf, fdata)) {
-    /* Attempt to get the packet failed. */
-    return MR_ERROR;
-  }
+  if (datalen == 0)
+    return FALSE;
 
-  result = MR_NOTMATCHED;
-  buf_len = fdata->cap_len;
-  pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    if (pd[i] == binary_data[c_match]) {
-      c_match += 1;
-      if (c_match == datalen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        cf->search_len = (guint32)datalen;
-        break;
-      }
-    }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
+  while ((size_t)(end - cur) >= datalen &&
+         (cur = (const guint8 *)memchr(cur, binary_data[0], (size_t)(end - cur))) != NULL &&
+         (size_t)(end - cur) >= datalen) {
+    if (memcmp(cur, binary_data, datalen) == 0) {
+      *search_pos = (guint32)(cur - pd + datalen - 1); /* Save the position of the last
+                                                          character for highlighting the field. */
+      *search_len = (guint32)datalen;
+      return TRUE;
     }
-    i += 1;
+    cur++;
   }
-  return result;
+  return FALSE;
 }
 
-static match_result
-match_regex(capture_file *cf, frame_data *fdata, void *criterion _U_)
+static gboolean
+match_regex(capture_file *cf, const cbs_t *info _U_, const guint8 *pd,
+            guint32 buf_len, guint32 *search_pos, guint32 *search_len)
 {
-    match_result  result = MR_NOTMATCHED;
+    gboolean      result = FALSE;
     GMatchInfo   *match_info = NULL;
 
-    /* Load the frame's data. */
-    if (!cf_read_record(cf, fdata)) {
-        /* Attempt to get the packet failed. */
-        return MR_ERROR;
-    }
-
-    if (g_regex_match_full(cf->regex, (const gchar *)ws_buffer_start_ptr(&cf->buf), fdata->cap_len,
+    if (g_regex_match_full(cf->regex, (const gchar *)pd, buf_len,
                            0, (GRegexMatchFlags) 0, &match_info, NULL))
     {
         gint start_pos = 0, end_pos = 0;
         g_match_info_fetch_pos (match_info, 0, &start_pos, &end_pos);
-        cf->search_pos = end_pos - 1;
-        cf->search_len = end_pos - start_pos;
-        result = MR_MATCHED;
+        *search_pos = end_pos - 1;
+        *search_len = end_pos - start_pos;
+        result = TRUE;
     }
+    g_match_info_free(match_info);
     return result;
 }
 
+typedef struct {
+    match_data_func  match_function;
+    const cbs_t     *info;
+} match_packet_data_t;
+
+static match_result
+match_packet_data(capture_file *cf, frame_data *fdata, void *criterion)
+{
+  match_packet_data_t *mpd = (match_packet_data_t *)criterion;
+
+  /* Load the frame's data. */
+  if (!cf_read_record(cf, fdata)) {
+    /* Attempt to get the packet failed. */
+    return MR_ERROR;
+  }
+
+  if ((*mpd->match_function)(cf, mpd->info, ws_buffer_start_ptr(&cf->buf),
+                             fdata->cap_len, &cf->search_pos, &cf->search_len))
+    return MR_MATCHED;
+  return MR_NOTMATCHED;
+}
+
 gboolean
 cf_find_packet_dfilter(capture_file *cf, dfilter_t *sfcode,
                        search_direction dir)
@@ -3547,7 +3562,6 @@ find_packet(capture_file *cf,
   progdlg_t   *progbar = NULL;
   GTimer      *prog_timer = g_timer_new();
   int          count;
-  gboolean     found;
   float        progbar_val;
   GTimeVal     start_time;
   gchar        status_str[100];
@@ -3680,6 +3694,14 @@ find_packet(capture_file *cf,
     destroy_progress_dlg(progbar);
   g_timer_destroy(prog_timer);
 
+  return select_found_packet(cf, new_fd);
+}
+
+static gboolean
+select_found_packet(capture_file *cf, frame_data *new_fd)
+{
+  gboolean found;
+
   if (new_fd != NULL) {
     /* Find and select */
     cf->search_in_progress = TRUE;
@@ -3701,6 +3723,272 @@ find_packet(capture_file *cf,
     return FALSE;   /* failure */
 }
 
+/*
+ * Searching packet data doesn't require dissection, so for large files
+ * we split the search between worker threads, each of which opens its
+ * own wtap handle. The frames are numbered in search order (starting
+ * after the current frame, wrapping around if the preference is set,
+ * and ending with the current frame); workers claim blocks of that
+ * order and stop as soon as an earlier match or read error has been
+ * found, so the result is the same as that of a sequential search.
+ */
+#define FIND_PARALLEL_MIN_FRAMES   10000
+#define FIND_PARALLEL_MAX_THREADS  8
+#define FIND_PARALLEL_BLOCK_FRAMES 1024
+
+typedef struct {
+  capture_file     *cf;
+  match_data_func   match_function;
+  const cbs_t      *info;
+  search_direction  dir;
+  gboolean          wrap;
+  guint32           start_framenum;
+  guint32           first_range_len; /* Frames before wrapping around */
+  guint32           num_frames;      /* Frames to search, in search order */
+  volatile gint     next_block;
+  volatile gint     frames_searched;
+  volatile gint     stop;
+  volatile gint     found_idx;       /* Earliest match in search order, or G_MAXINT */
+  volatile gint     err_idx;         /* Earliest read error in search order, or G_MAXINT */
+  guint32           search_pos;
+  guint32           search_len;
+  gboolean          open_failed;
+  int               err;             /* The error at err_idx */
+  gchar            *err_info;
+  guint             workers_running;
+  GMutex            mutex;
+  GCond             cond;
+} find_data_ctx_t;
+
+/* Map an index in search order to a frame number. */
+static guint32
+find_data_framenum(const find_data_ctx_t *ctx, guint32 idx)
+{
+  if (idx < ctx->first_range_len) {
+    return ctx->dir == SD_BACKWARD ? ctx->start_framenum - 1 - idx
+                                   : ctx->start_framenum + 1 + idx;
+  }
+  if (!ctx->wrap)
+    return ctx->start_framenum;
+  idx -= ctx->first_range_len;
+  return ctx->dir == SD_BACKWARD ? ctx->cf->count - idx : 1 + idx;
+}
+
+static gpointer
+find_data_worker(gpointer data)
+{
+  find_data_ctx_t *ctx = (find_data_ctx_t *)data;
+  wtap            *wth;
+  wtap_rec         rec;
+  Buffer           buf;
+  int              err;
+  gchar           *err_info = NULL;
+  guint32          idx, first, last;
+  frame_data      *fdata;
+  guint32          search_pos, search_len;
+
+  wth = wtap_open_offline(ctx->cf->filename, ctx->cf->open_type, &err, &err_info, TRUE);
+  if (wth == NULL) {
+    g_free(err_info);
+    g_mutex_lock(&ctx->mutex);
+    ctx->open_failed = TRUE;
+    g_mutex_unlock(&ctx->mutex);
+    g_atomic_int_set(&ctx->stop, 1);
+  } else {
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1500);
+
+    while (!g_atomic_int_get(&ctx->stop)) {
+      first = (guint32)g_atomic_int_add(&ctx->next_block, 1) * FIND_PARALLEL_BLOCK_FRAMES;
+      if (first >= ctx->num_frames || first > (guint32)g_atomic_int_get(&ctx->found_idx) ||
+          first > (guint32)g_atomic_int_get(&ctx->err_idx))
+        break;
+      last = MIN(first + FIND_PARALLEL_BLOCK_FRAMES, ctx->num_frames);
+
+      for (idx = first; idx < last; idx++) {
+        if (g_atomic_int_get(&ctx->stop) || idx > (guint32)g_atomic_int_get(&ctx->found_idx) ||
+            idx > (guint32)g_atomic_int_get(&ctx->err_idx))
+          break;
+
+        fdata = frame_data_sequence_find(ctx->cf->provider.frames, find_data_framenum(ctx, idx));
+        if (fdata == NULL || !fdata->flags.passed_dfilter)
+          continue;
+
+        if (!wtap_seek_read(wth, fdata->file_off, &rec, &buf, &err, &err_info)) {
+          /* A sequential search would stop here, but only if it didn't
+             find a match first; other workers keep searching the frames
+             before this one. */
+          g_mutex_lock(&ctx->mutex);
+          if ((gint)idx < g_atomic_int_get(&ctx->err_idx)) {
+            g_atomic_int_set(&ctx->err_idx, (gint)idx);
+            g_free(ctx->err_info);
+            ctx->err = err;
+            ctx->err_info = err_info;
+          } else {
+            g_free(err_info);
+          }
+          err_info = NULL;
+          g_mutex_unlock(&ctx->mutex);
+          break;
+        }
+
+        if ((*ctx->match_function)(ctx->cf, ctx->info, ws_buffer_start_ptr(&buf),
+                                   fdata->cap_len, &search_pos, &search_len)) {
+          g_mutex_lock(&ctx->mutex);
+          if ((gint)idx < g_atomic_int_get(&ctx->found_idx)) {
+            g_atomic_int_set(&ctx->found_idx, (gint)idx);
+            ctx->search_pos = search_pos;
+            ctx->search_len = search_len;
+          }
+          g_mutex_unlock(&ctx->mutex);
+          /* Everything else we'd search comes later. */
+          break;
+        }
+      }
+      g_atomic_int_add(&ctx->frames_searched, (gint)(idx - first));
+    }
+
+    ws_buffer_free(&buf);
+    wtap_rec_cleanup(&rec);
+    wtap_close(wth);
+  }
+
+  g_mutex_lock(&ctx->mutex);
+  ctx->workers_running--;
+  g_cond_signal(&ctx->cond);
+  g_mutex_unlock(&ctx->mutex);
+  return NULL;
+}
+
+static gboolean
+find_packet_data(capture_file *cf, match_data_func match_function,
+                 const cbs_t *info, search_direction dir)
+{
+  match_packet_data_t  mpd;
+  find_data_ctx_t      ctx;
+  GThread             *threads[FIND_PARALLEL_MAX_THREADS];
+  guint                num_threads, i;
+  frame_data          *start_fd = cf->current_frame;
+  frame_data          *new_fd = NULL;
+  progdlg_t           *progbar = NULL;
+  GTimeVal             start_time;
+  gchar                status_str[100];
+  gint                 found_idx;
+  gfloat               progbar_val;
+
+  mpd.match_function = match_function;
+  mpd.info = info;
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+  num_threads = MIN((guint)g_get_num_processors(), FIND_PARALLEL_MAX_THREADS);
+#else
+  num_threads = 1;
+#endif
+
+  /* Search sequentially on the current wtap handle if the file might
+     still be changing or if it isn't worth starting threads. */
+  if (start_fd == NULL || cf->state != FILE_READ_DONE || cf->filename == NULL ||
+      cf->count < FIND_PARALLEL_MIN_FRAMES || cf->count > G_MAXINT / 2 ||
+      num_threads < 2) {
+    return find_packet(cf, match_packet_data, &mpd, dir);
+  }
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.cf = cf;
+  ctx.match_function = match_function;
+  ctx.info = info;
+  ctx.dir = dir;
+  ctx.wrap = prefs.gui_find_wrap;
+  ctx.start_framenum = start_fd->num;
+  if (dir == SD_BACKWARD) {
+    ctx.first_range_len = ctx.start_framenum - 1;
+    ctx.num_frames = ctx.first_range_len + (ctx.wrap ? cf->count - ctx.start_framenum + 1 : 1);
+  } else {
+    ctx.first_range_len = cf->count - ctx.start_framenum;
+    ctx.num_frames = ctx.first_range_len + (ctx.wrap ? ctx.start_framenum : 1);
+  }
+  ctx.found_idx = G_MAXINT;
+  ctx.err_idx = G_MAXINT;
+  ctx.workers_running = num_threads;
+  g_mutex_init(&ctx.mutex);
+  g_cond_init(&ctx.cond);
+
+  cf->stop_flag = FALSE;
+  g_get_current_time(&start_time);
+
+  for (i = 0; i < num_threads; i++) {
+    threads[i] = g_thread_new("find_packet_data_worker", find_data_worker, &ctx);
+  }
+
+  g_mutex_lock(&ctx.mutex);
+  while (ctx.workers_running > 0) {
+    gint64 end_time = g_get_monotonic_time() + (gint64)(PROGBAR_UPDATE_INTERVAL * G_TIME_SPAN_SECOND);
+    if (g_cond_wait_until(&ctx.cond, &ctx.mutex, end_time))
+      continue;
+
+    /* Update the progress bar without holding up the workers. */
+    g_mutex_unlock(&ctx.mutex);
+    progbar_val = (gfloat) g_atomic_int_get(&ctx.frames_searched) / ctx.num_frames;
+    if (progbar == NULL)
+      progbar = delayed_create_progress_dlg(cf->window, "Searching", cf->sfilter ? cf->sfilter : "",
+        FALSE, &cf->stop_flag, &start_time, progbar_val);
+    if (progbar != NULL) {
+      g_snprintf(status_str, sizeof(status_str),
+                  "%4u of %u packets", g_atomic_int_get(&ctx.frames_searched), ctx.num_frames);
+      update_progress_dlg(progbar, progbar_val, status_str);
+    }
+    if (cf->stop_flag)
+      g_atomic_int_set(&ctx.stop, 1);
+    g_mutex_lock(&ctx.mutex);
+  }
+  g_mutex_unlock(&ctx.mutex);
+
+  for (i = 0; i < num_threads; i++) {
+    g_thread_join(threads[i]);
+  }
+  g_mutex_clear(&ctx.mutex);
+  g_cond_clear(&ctx.cond);
+
+  if (progbar != NULL)
+    destroy_progress_dlg(progbar);
+
+  if (ctx.open_failed) {
+    /* We couldn't open the file again; search it the old-fashioned way. */
+    g_free(ctx.err_info);
+    return find_packet(cf, match_packet_data, &mpd, dir);
+  }
+
+  found_idx = g_atomic_int_get(&ctx.found_idx);
+  if (cf->stop_flag) {
+    /* Well, the user decided to abort the search.  Go back to the
+       frame where we started. */
+    new_fd = start_fd;
+  } else if (g_atomic_int_get(&ctx.err_idx) < found_idx) {
+    /* We couldn't read a frame before reaching a match, if any. */
+    cfile_read_failure_alert_box(cf->filename, ctx.err, ctx.err_info);
+    ctx.err_info = NULL;  /* freed by cfile_read_failure_alert_box() */
+    new_fd = start_fd;
+  } else {
+    if (found_idx == G_MAXINT || (guint32)found_idx >= ctx.first_range_len) {
+      if (dir == SD_BACKWARD) {
+        statusbar_push_temporary_msg(ctx.wrap ? "Search reached the beginning. Continuing at end."
+                                              : "Search reached the beginning.");
+      } else {
+        statusbar_push_temporary_msg(ctx.wrap ? "Search reached the end. Continuing at beginning."
+                                              : "Search reached the end.");
+      }
+    }
+    if (found_idx != G_MAXINT) {
+      new_fd = frame_data_sequence_find(cf->provider.frames, find_data_framenum(&ctx, (guint32)found_idx));
+      cf->search_pos = ctx.search_pos;
+      cf->search_len = ctx.search_len;
+    }
+  }
+  g_free(ctx.err_info);
+
+  return select_found_packet(cf, new_fd);
+}
+
 gboolean
 cf_goto_frame(capture_file *cf, guint fnumber)
 {
@@ -165,14 +165,17 @@ gboolean cf_read_record_r(capture_file *cf, const frame_data *fdata,
 gboolean cf_read_record(capture_file *cf, frame_data *fdata);
 
 /**
- * Read packets from the "end" of a capture file.
+ * Read packets from the "end" of a capture file. To keep the UI
+ * responsive at high packet rates this stops after a short time, so
+ * some packets may be left for a later call.
  *
  * @param cf the capture file to be read from
- * @param to_read the number of packets to read
+ * @param to_read the number of packets to read; on return, the number
+ * of packets that are still to be read
  * @param err the error code, if an error had occurred
  * @return one of cf_read_status_t
  */
-cf_read_status_t cf_continue_tail(capture_file *cf, volatile int to_read, int *err);
+cf_read_status_t cf_continue_tail(capture_file *cf, int *to_read, int *err);
 
 /**
  * Fake reading packets from the "end" of a capture file.
@@ -25,6 +25,7 @@
 #include "wsutil/wsgetopt.h"
 #endif
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/crash_info.h>
 #include <wsutil/filesystem.h>
@@ -53,8 +54,14 @@ print_usage(FILE *output)
     fprintf(output, "Usage: reordercap [options] <infile> <outfile>\n");
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
-    fprintf(output, "  -n        don't write to output file if the input file is ordered.\n");
-    fprintf(output, "  -h        display this help and exit.\n");
+    fprintf(output, "  -n              don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  -w <frames>     stream the input through a reorder window holding at most\n");
+    fprintf(output, "                  <frames> frames; the input may be a pipe.\n");
+    fprintf(output, "  -t <ms>         stream the input through a reorder window spanning\n");
+    fprintf(output, "                  <ms> milliseconds; may be combined with -w.\n");
+    fprintf(output, "  -s <frames>     sort with at most <frames> frames in memory, spilling\n");
+    fprintf(output, "                  sorted runs to temporary files; the input may be a pipe.\n");
+    fprintf(output, "  -h              display this help and exit.\n");
 }
 
 /* Remember where this frame was in the file */
@@ -66,6 +73,22 @@ typedef struct FrameRecord_t {
 } FrameRecord_t;
 
 
+/* A copy of a frame, kept in memory by the window and spill modes */
+typedef struct BufferedFrame_t {
+    guint        num;
+    wtap_rec     rec;
+    guint8      *data;
+} BufferedFrame_t;
+
+/* A sorted run spilled to a temporary file, being merged */
+typedef struct MergeRun_t {
+    guint        index;
+    char        *filename;
+    wtap        *wth;
+    nstime_t     frame_time;
+} MergeRun_t;
+
+
 /**************************************************/
 /* Debugging only                                 */
 
@@ -80,6 +103,22 @@ typedef struct FrameRecord_t {
 /**************************************************/
 
 
+/* Write a record to outfile, bailing out on failure */
+static void
+rec_write(wtap_dumper *pdh, const wtap_rec *rec, const guint8 *data,
+          guint num, int file_type_subtype, const char *infile,
+          const char *outfile)
+{
+    int    err;
+    gchar  *err_info;
+
+    if (!wtap_dump(pdh, rec, data, &err, &err_info)) {
+        cfile_write_failure_message("reordercap", infile, outfile, err,
+                                    err_info, num, file_type_subtype);
+        exit(1);
+    }
+}
+
 static void
 frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
             wtap_rec *rec, Buffer *buf, const char *infile,
@@ -110,12 +149,8 @@ frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
     rec->ts = frame->frame_time;
 
     /* Dump frame to outfile */
-    if (!wtap_dump(pdh, rec, ws_buffer_start_ptr(buf), &err, &err_info)) {
-        cfile_write_failure_message("reordercap", infile, outfile, err,
-                                    err_info, frame->num,
-                                    wtap_file_type_subtype(wth));
-        exit(1);
-    }
+    rec_write(pdh, rec, ws_buffer_start_ptr(buf), frame->num,
+              wtap_file_type_subtype(wth), infile, outfile);
 }
 
 /* Comparing timestamps between 2 frames.
@@ -135,6 +170,525 @@ frames_compare(gconstpointer a, gconstpointer b)
     return nstime_cmp(time1, time2);
 }
 
+/* As frames_compare(), falling back to input order for equal timestamps */
+static int
+buffered_frames_compare(gconstpointer a, gconstpointer b)
+{
+    const BufferedFrame_t *frame1 = *(const BufferedFrame_t *const *) a;
+    const BufferedFrame_t *frame2 = *(const BufferedFrame_t *const *) b;
+    int cmp;
+
+    cmp = nstime_cmp(&frame1->rec.ts, &frame2->rec.ts);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return (frame1->num > frame2->num) - (frame1->num < frame2->num);
+}
+
+/* Runs hold consecutive stretches of the input, so ties go to the earlier run */
+static int
+merge_runs_compare(gconstpointer a, gconstpointer b)
+{
+    const MergeRun_t *run1 = *(const MergeRun_t *const *) a;
+    const MergeRun_t *run2 = *(const MergeRun_t *const *) b;
+    int cmp;
+
+    cmp = nstime_cmp(&run1->frame_time, &run2->frame_time);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return (run1->index > run2->index) - (run1->index < run2->index);
+}
+
+/**************************************************/
+/* Binary min-heap on a GPtrArray                 */
+
+static void
+heap_sift_down(GPtrArray *heap, guint i, GCompareFunc compare)
+{
+    for (;;) {
+        guint smallest = i;
+        guint left = 2 * i + 1;
+        guint right = left + 1;
+        gpointer tmp;
+
+        if (left < heap->len &&
+            compare(&heap->pdata[left], &heap->pdata[smallest]) < 0) {
+            smallest = left;
+        }
+        if (right < heap->len &&
+            compare(&heap->pdata[right], &heap->pdata[smallest]) < 0) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        tmp = heap->pdata[i];
+        heap->pdata[i] = heap->pdata[smallest];
+        heap->pdata[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void
+heap_push(GPtrArray *heap, gpointer item, GCompareFunc compare)
+{
+    guint i;
+
+    g_ptr_array_add(heap, item);
+    i = heap->len - 1;
+    while (i > 0) {
+        guint parent = (i - 1) / 2;
+        gpointer tmp;
+
+        if (compare(&heap->pdata[i], &heap->pdata[parent]) >= 0) {
+            break;
+        }
+        tmp = heap->pdata[i];
+        heap->pdata[i] = heap->pdata[parent];
+        heap->pdata[parent] = tmp;
+        i = parent;
+    }
+}
+
+static gpointer
+heap_pop(GPtrArray *heap, GCompareFunc compare)
+{
+    gpointer top = heap->pdata[0];
+
+    heap->pdata[0] = heap->pdata[heap->len - 1];
+    g_ptr_array_set_size(heap, heap->len - 1);
+    heap_sift_down(heap, 0, compare);
+    return top;
+}
+
+/**************************************************/
+/* Frames held in memory                          */
+
+/*
+ * Number of bytes of record data following a record.  File-type-specific
+ * records don't say, so the window and spill modes pass those straight
+ * through rather than buffering them.
+ */
+static gboolean
+rec_data_length(const wtap_rec *rec, guint32 *length)
+{
+    switch (rec->rec_type) {
+        case REC_TYPE_PACKET:
+            *length = rec->rec_header.packet_header.caplen;
+            return TRUE;
+        case REC_TYPE_SYSCALL:
+            *length = rec->rec_header.syscall_header.event_filelen;
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+static BufferedFrame_t *
+buffered_frame_new(const wtap_rec *rec, const guint8 *data, guint32 length,
+                   guint num)
+{
+    BufferedFrame_t *frame = g_new(BufferedFrame_t, 1);
+
+    frame->num = num;
+    frame->rec = *rec;
+    frame->rec.opt_comment = g_strdup(rec->opt_comment);
+    /* rec's options_buf belongs to the reader, and is reused */
+    ws_buffer_init(&frame->rec.options_buf, ws_buffer_length(&rec->options_buf));
+    ws_buffer_append_buffer(&frame->rec.options_buf, &rec->options_buf);
+    if (!(rec->presence_flags & WTAP_HAS_TS)) {
+        nstime_set_unset(&frame->rec.ts);
+    }
+    frame->data = (guint8 *)g_memdup(data, length);
+    return frame;
+}
+
+static void
+buffered_frame_free(BufferedFrame_t *frame)
+{
+    g_free(frame->rec.opt_comment);
+    ws_buffer_free(&frame->rec.options_buf);
+    g_free(frame->data);
+    g_free(frame);
+}
+
+/**************************************************/
+/* Bounded reorder window                         */
+
+/* Has the earliest buffered frame fallen out of the window?  A NULL
+   window_time means the window is bounded by frame count only. */
+static gboolean
+window_full(GPtrArray *window, guint window_frames,
+            const nstime_t *window_time, const nstime_t *newest)
+{
+    const BufferedFrame_t *earliest;
+    nstime_t age;
+
+    if (window->len == 0) {
+        return FALSE;
+    }
+    if (window_frames != 0 && window->len > window_frames) {
+        return TRUE;
+    }
+    if (window_time == NULL) {
+        return FALSE;
+    }
+    earliest = (const BufferedFrame_t *)window->pdata[0];
+    if (nstime_is_unset(&earliest->rec.ts)) {
+        return TRUE;
+    }
+    nstime_delta(&age, newest, &earliest->rec.ts);
+    return nstime_cmp(&age, window_time) > 0;
+}
+
+/*
+ * Stream the input through a min-heap holding the frames seen within the
+ * window, writing out the earliest whenever the window overflows.  Memory
+ * use is bounded by the window and the input is read exactly once, in
+ * order.  Frames that arrive later than the window allows are written as
+ * soon as possible and counted in late_count.
+ */
+static void
+reorder_window(wtap *wth, wtap_dumper *pdh, guint window_frames,
+               const nstime_t *window_time, const char *infile,
+               const char *outfile, guint *frame_count,
+               guint *wrong_order_count, guint *late_count)
+{
+    int file_type_subtype = wtap_file_type_subtype(wth);
+    GPtrArray *window = g_ptr_array_new();
+    nstime_t prev_time, newest, last_written;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    nstime_set_unset(&prev_time);
+    nstime_set_unset(&newest);
+    nstime_set_unset(&last_written);
+
+    while (wtap_read(wth, &err, &err_info, &data_offset)) {
+        const wtap_rec *rec = wtap_get_rec(wth);
+        BufferedFrame_t *frame;
+        guint32 length;
+
+        (*frame_count)++;
+        if (!rec_data_length(rec, &length)) {
+            rec_write(pdh, rec, wtap_get_buf_ptr(wth), *frame_count,
+                      file_type_subtype, infile, outfile);
+            continue;
+        }
+        frame = buffered_frame_new(rec, wtap_get_buf_ptr(wth), length,
+                                   *frame_count);
+
+        if (nstime_cmp(&frame->rec.ts, &prev_time) < 0) {
+            (*wrong_order_count)++;
+        }
+        prev_time = frame->rec.ts;
+        if (nstime_cmp(&frame->rec.ts, &last_written) < 0) {
+            (*late_count)++;
+        }
+        if (nstime_cmp(&frame->rec.ts, &newest) > 0) {
+            newest = frame->rec.ts;
+        }
+
+        heap_push(window, frame, buffered_frames_compare);
+        while (window_full(window, window_frames, window_time, &newest)) {
+            frame = (BufferedFrame_t *)heap_pop(window, buffered_frames_compare);
+            rec_write(pdh, &frame->rec, frame->data, frame->num,
+                      file_type_subtype, infile, outfile);
+            if (nstime_cmp(&frame->rec.ts, &last_written) > 0) {
+                last_written = frame->rec.ts;
+            }
+            buffered_frame_free(frame);
+        }
+    }
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the line. */
+        cfile_read_failure_message("reordercap", infile, err, err_info);
+    }
+
+    /* Flush what is left in the window */
+    while (window->len > 0) {
+        BufferedFrame_t *frame = (BufferedFrame_t *)heap_pop(window, buffered_frames_compare);
+
+        rec_write(pdh, &frame->rec, frame->data, frame->num,
+                  file_type_subtype, infile, outfile);
+        buffered_frame_free(frame);
+    }
+    g_ptr_array_free(window, TRUE);
+}
+
+/**************************************************/
+/* External merge sort                            */
+
+/* Open a temporary file of the same type as the input */
+static wtap_dumper *
+temp_dump_open(wtap *wth, wtapng_iface_descriptions_t *idb_inf,
+               char **filename)
+{
+    int file_type_subtype = wtap_file_type_subtype(wth);
+    wtap_dumper *pdh;
+    int err;
+
+    pdh = wtap_dump_open_tempfile_ng(filename, "reordercap",
+                                     file_type_subtype, wtap_file_encap(wth),
+                                     wtap_snapshot_length(wth), FALSE,
+                                     NULL, idb_inf, NULL, &err);
+    if (pdh == NULL) {
+        cfile_dump_open_failure_message("reordercap", "temporary file", err,
+                                        file_type_subtype);
+        exit(1);
+    }
+    return pdh;
+}
+
+/* Sort a run and write it to a temporary file, freeing its frames */
+static char *
+spill_run(GPtrArray *run, wtap *wth, wtapng_iface_descriptions_t *idb_inf,
+          const char *infile)
+{
+    int file_type_subtype = wtap_file_type_subtype(wth);
+    wtap_dumper *run_pdh;
+    char *filename;
+    int err;
+    guint i;
+
+    g_ptr_array_sort(run, buffered_frames_compare);
+
+    run_pdh = temp_dump_open(wth, idb_inf, &filename);
+    DEBUG_PRINT("Spilling %u frames to %s\n", run->len, filename);
+
+    for (i = 0; i < run->len; i++) {
+        BufferedFrame_t *frame = (BufferedFrame_t *)run->pdata[i];
+
+        rec_write(run_pdh, &frame->rec, frame->data, frame->num,
+                  file_type_subtype, infile, filename);
+        buffered_frame_free(frame);
+    }
+    g_ptr_array_set_size(run, 0);
+
+    if (!wtap_dump_close(run_pdh, &err)) {
+        cfile_close_failure_message(filename, err);
+        exit(1);
+    }
+    return filename;
+}
+
+/* Read the next frame of a run; FALSE at the end of the run */
+static gboolean
+merge_run_advance(MergeRun_t *run)
+{
+    const wtap_rec *rec;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    if (!wtap_read(run->wth, &err, &err_info, &data_offset)) {
+        if (err != 0) {
+            cfile_read_failure_message("reordercap", run->filename, err, err_info);
+            exit(1);
+        }
+        return FALSE;
+    }
+    rec = wtap_get_rec(run->wth);
+    if (rec->presence_flags & WTAP_HAS_TS) {
+        run->frame_time = rec->ts;
+    } else {
+        nstime_set_unset(&run->frame_time);
+    }
+    return TRUE;
+}
+
+/*
+ * Merge the spilled runs into outfile with a heap keyed on each run's
+ * current frame.  Every run is read front to back, so all I/O is
+ * sequential.  The run files are removed afterwards.
+ */
+static void
+merge_runs(GPtrArray *run_files, wtap_dumper *pdh, int file_type_subtype,
+           gboolean write_output, const char *infile, const char *outfile)
+{
+    GPtrArray *heap = g_ptr_array_sized_new(run_files->len);
+    MergeRun_t *runs = g_new0(MergeRun_t, run_files->len);
+    guint num = 0;
+    guint i;
+
+    for (i = 0; write_output && i < run_files->len; i++) {
+        MergeRun_t *run = &runs[i];
+        int err;
+        gchar *err_info;
+
+        run->index = i;
+        run->filename = (char *)run_files->pdata[i];
+        run->wth = wtap_open_offline(run->filename, WTAP_TYPE_AUTO, &err,
+                                     &err_info, FALSE);
+        if (run->wth == NULL) {
+            cfile_open_failure_message("reordercap", run->filename, err, err_info);
+            exit(1);
+        }
+        if (merge_run_advance(run)) {
+            heap_push(heap, run, merge_runs_compare);
+        }
+    }
+
+    while (heap->len > 0) {
+        MergeRun_t *run = (MergeRun_t *)heap->pdata[0];
+
+        rec_write(pdh, wtap_get_rec(run->wth), wtap_get_buf_ptr(run->wth),
+                  ++num, file_type_subtype, infile, outfile);
+        if (merge_run_advance(run)) {
+            heap_sift_down(heap, 0, merge_runs_compare);
+        } else {
+            heap_pop(heap, merge_runs_compare);
+        }
+    }
+
+    for (i = 0; i < run_files->len; i++) {
+        if (runs[i].wth != NULL) {
+            wtap_close(runs[i].wth);
+        }
+        ws_unlink((const char *)run_files->pdata[i]);
+    }
+    g_free(runs);
+    g_ptr_array_free(heap, TRUE);
+}
+
+/* Copy the records of a temporary file to outfile, and remove the file */
+static void
+copy_temp_file(const char *filename, wtap_dumper *pdh, int file_type_subtype,
+               const char *infile, const char *outfile)
+{
+    wtap *wth;
+    guint num = 0;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+    if (wth == NULL) {
+        cfile_open_failure_message("reordercap", filename, err, err_info);
+        exit(1);
+    }
+    while (wtap_read(wth, &err, &err_info, &data_offset)) {
+        rec_write(pdh, wtap_get_rec(wth), wtap_get_buf_ptr(wth), ++num,
+                  file_type_subtype, infile, outfile);
+    }
+    if (err != 0) {
+        cfile_read_failure_message("reordercap", filename, err, err_info);
+        exit(1);
+    }
+    wtap_close(wth);
+    ws_unlink(filename);
+}
+
+/*
+ * Sort the input in runs of at most run_frames frames.  If the input fits
+ * in a single run it is sorted and written straight from memory; otherwise
+ * each full run is spilled to disk and the runs are merged at the end.
+ *
+ * Records other than packets are written ahead of the sorted frames.  If
+ * the output is only to be written when the input is out of order, they
+ * are kept in a temporary file until we know.
+ */
+static void
+reorder_spill(wtap *wth, wtap_dumper *pdh, wtapng_iface_descriptions_t *idb_inf,
+              guint run_frames, gboolean write_output_regardless,
+              const char *infile, const char *outfile, guint *frame_count,
+              guint *wrong_order_count)
+{
+    int file_type_subtype = wtap_file_type_subtype(wth);
+    GPtrArray *run = g_ptr_array_sized_new(MIN(run_frames, 65536));
+    GPtrArray *run_files = g_ptr_array_new_with_free_func(g_free);
+    wtap_dumper *other_pdh = NULL;
+    char *other_filename = NULL;
+    nstime_t prev_time;
+    gboolean write_output;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+    guint i;
+
+    nstime_set_unset(&prev_time);
+
+    while (wtap_read(wth, &err, &err_info, &data_offset)) {
+        const wtap_rec *rec = wtap_get_rec(wth);
+        BufferedFrame_t *frame;
+        guint32 length;
+
+        (*frame_count)++;
+        if (!rec_data_length(rec, &length)) {
+            if (write_output_regardless) {
+                rec_write(pdh, rec, wtap_get_buf_ptr(wth), *frame_count,
+                          file_type_subtype, infile, outfile);
+            } else {
+                if (other_pdh == NULL) {
+                    other_pdh = temp_dump_open(wth, idb_inf, &other_filename);
+                }
+                rec_write(other_pdh, rec, wtap_get_buf_ptr(wth), *frame_count,
+                          file_type_subtype, infile, other_filename);
+            }
+            continue;
+        }
+        frame = buffered_frame_new(rec, wtap_get_buf_ptr(wth), length,
+                                   *frame_count);
+
+        if (nstime_cmp(&frame->rec.ts, &prev_time) < 0) {
+            (*wrong_order_count)++;
+        }
+        prev_time = frame->rec.ts;
+
+        g_ptr_array_add(run, frame);
+        if (run->len >= run_frames) {
+            g_ptr_array_add(run_files, spill_run(run, wth, idb_inf, infile));
+        }
+    }
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the line. */
+        cfile_read_failure_message("reordercap", infile, err, err_info);
+    }
+
+    write_output = write_output_regardless || (*wrong_order_count > 0);
+
+    if (other_pdh != NULL) {
+        if (!wtap_dump_close(other_pdh, &err)) {
+            cfile_close_failure_message(other_filename, err);
+            exit(1);
+        }
+        if (write_output) {
+            copy_temp_file(other_filename, pdh, file_type_subtype, infile,
+                           outfile);
+        } else {
+            ws_unlink(other_filename);
+        }
+        g_free(other_filename);
+    }
+
+    if (run_files->len == 0) {
+        /* Everything fit in memory */
+        if (*wrong_order_count > 0) {
+            g_ptr_array_sort(run, buffered_frames_compare);
+        }
+        for (i = 0; i < run->len; i++) {
+            BufferedFrame_t *frame = (BufferedFrame_t *)run->pdata[i];
+
+            if (write_output) {
+                rec_write(pdh, &frame->rec, frame->data, frame->num,
+                          file_type_subtype, infile, outfile);
+            }
+            buffered_frame_free(frame);
+        }
+    } else {
+        if (run->len > 0) {
+            g_ptr_array_add(run_files, spill_run(run, wth, idb_inf, infile));
+        }
+        merge_runs(run_files, pdh, file_type_subtype, write_output, infile,
+                   outfile);
+    }
+
+    g_ptr_array_free(run, TRUE);
+    g_ptr_array_free(run_files, TRUE);
+}
+
 /*
  * General errors and warnings are reported with an console message
  * in reordercap.
@@ -174,8 +728,15 @@ main(int argc, char *argv[])
     gchar *err_info;
     gint64 data_offset;
     const wtap_rec *rec;
+    guint frame_count = 0;
     guint wrong_order_count = 0;
+    guint late_count = 0;
     gboolean write_output_regardless = TRUE;
+    guint window_frames = 0;
+    guint window_ms = 0;
+    nstime_t window_time;
+    guint run_frames = 0;
+    gboolean streaming;
     guint i;
     GArray                      *shb_hdrs = NULL;
     wtapng_iface_descriptions_t *idb_inf = NULL;
@@ -236,11 +797,20 @@ main(int argc, char *argv[])
     wtap_init(TRUE);
 
     /* Process the options first */
-    while ((opt = getopt_long(argc, argv, "hnv", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hns:t:vw:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'n':
                 write_output_regardless = FALSE;
                 break;
+            case 's':
+                run_frames = get_nonzero_guint32(optarg, "frames per run");
+                break;
+            case 't':
+                window_ms = get_nonzero_guint32(optarg, "window time");
+                break;
+            case 'w':
+                window_frames = get_nonzero_guint32(optarg, "window size");
+                break;
             case 'h':
                 printf("Reordercap (Wireshark) %s\n"
                        "Reorder timestamps of input file frames into output file.\n"
@@ -274,10 +844,28 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (run_frames != 0 && (window_frames != 0 || window_ms != 0)) {
+        cmdarg_err("-s can't be used with -w or -t.");
+        ret = INVALID_OPTION;
+        goto clean_exit;
+    }
+    if (!write_output_regardless && (window_frames != 0 || window_ms != 0)) {
+        cmdarg_err("-n can't be used with -w or -t, as frames are written before the whole input has been read.");
+        ret = INVALID_OPTION;
+        goto clean_exit;
+    }
+    nstime_set_zero(&window_time);
+    window_time.secs = window_ms / 1000;
+    window_time.nsecs = (window_ms % 1000) * 1000000;
+
+    /* Only the default mode re-reads frames, so the others can read
+       from a pipe */
+    streaming = (window_frames != 0 || window_ms != 0 || run_frames != 0);
+
     /* Open infile */
     /* TODO: if reordercap is ever changed to give the user a choice of which
        open_routine reader to use, then the following needs to change. */
-    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, TRUE);
+    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, !streaming);
     if (wth == NULL) {
         cfile_open_failure_message("reordercap", infile, err, err_info);
         ret = OPEN_ERROR;
@@ -297,76 +885,95 @@ main(int argc, char *argv[])
       pdh = wtap_dump_open_ng(outfile, wtap_file_type_subtype(wth), wtap_file_encap(wth),
                               wtap_snapshot_length(wth), FALSE, shb_hdrs, idb_inf, nrb_hdrs, &err);
     }
-    g_free(idb_inf);
-    idb_inf = NULL;
 
     if (pdh == NULL) {
         cfile_dump_open_failure_message("reordercap", outfile, err,
                                         wtap_file_type_subtype(wth));
+        g_free(idb_inf);
         wtap_block_array_free(shb_hdrs);
         wtap_block_array_free(nrb_hdrs);
         ret = OUTPUT_FILE_ERROR;
         goto clean_exit;
     }
 
-    /* Allocate the array of frame pointers. */
-    frames = g_ptr_array_new();
-
-    /* Read each frame from infile */
-    while (wtap_read(wth, &err, &err_info, &data_offset)) {
-        FrameRecord_t *newFrameRecord;
-
-        rec = wtap_get_rec(wth);
-
-        newFrameRecord = g_slice_new(FrameRecord_t);
-        newFrameRecord->num = frames->len + 1;
-        newFrameRecord->offset = data_offset;
-        if (rec->presence_flags & WTAP_HAS_TS) {
-            newFrameRecord->frame_time = rec->ts;
-        } else {
-            nstime_set_unset(&newFrameRecord->frame_time);
+    if (window_frames != 0 || window_ms != 0) {
+        reorder_window(wth, pdh, window_frames,
+                       window_ms != 0 ? &window_time : NULL, infile, outfile,
+                       &frame_count, &wrong_order_count, &late_count);
+        printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+        if (late_count > 0) {
+            printf("%u frames arrived too late for the reorder window and are still out of order\n",
+                   late_count);
         }
-
-        if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
-           wrong_order_count++;
+    } else if (run_frames != 0) {
+        reorder_spill(wth, pdh, idb_inf, run_frames, write_output_regardless,
+                      infile, outfile, &frame_count, &wrong_order_count);
+        printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+        if (!write_output_regardless && (wrong_order_count == 0)) {
+            printf("Not writing output file because input file is already in order.\n");
+        }
+    } else {
+        /* Allocate the array of frame pointers. */
+        frames = g_ptr_array_new();
+
+        /* Read each frame from infile */
+        while (wtap_read(wth, &err, &err_info, &data_offset)) {
+            FrameRecord_t *newFrameRecord;
+
+            rec = wtap_get_rec(wth);
+
+            newFrameRecord = g_slice_new(FrameRecord_t);
+            newFrameRecord->num = frames->len + 1;
+            newFrameRecord->offset = data_offset;
+            if (rec->presence_flags & WTAP_HAS_TS) {
+                newFrameRecord->frame_time = rec->ts;
+            } else {
+                nstime_set_unset(&newFrameRecord->frame_time);
+            }
+
+            if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
+               wrong_order_count++;
+            }
+
+            g_ptr_array_add(frames, newFrameRecord);
+            prevFrame = newFrameRecord;
+        }
+        if (err != 0) {
+          /* Print a message noting that the read failed somewhere along the line. */
+          cfile_read_failure_message("reordercap", infile, err, err_info);
         }
 
-        g_ptr_array_add(frames, newFrameRecord);
-        prevFrame = newFrameRecord;
-    }
-    if (err != 0) {
-      /* Print a message noting that the read failed somewhere along the line. */
-      cfile_read_failure_message("reordercap", infile, err, err_info);
-    }
-
-    printf("%u frames, %u out of order\n", frames->len, wrong_order_count);
+        printf("%u frames, %u out of order\n", frames->len, wrong_order_count);
 
-    /* Sort the frames */
-    if (wrong_order_count > 0) {
-        g_ptr_array_sort(frames, frames_compare);
-    }
+        /* Sort the frames */
+        if (wrong_order_count > 0) {
+            g_ptr_array_sort(frames, frames_compare);
+        }
 
-    /* Write out each sorted frame in turn */
-    wtap_rec_init(&dump_rec);
-    ws_buffer_init(&buf, 1500);
-    for (i = 0; i < frames->len; i++) {
-        FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
+        /* Write out each sorted frame in turn */
+        wtap_rec_init(&dump_rec);
+        ws_buffer_init(&buf, 1500);
+        for (i = 0; i < frames->len; i++) {
+            FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
+
+            /* Avoid writing if already sorted and configured to */
+            if (write_output_regardless || (wrong_order_count > 0)) {
+                frame_write(frame, wth, pdh, &dump_rec, &buf, infile, outfile);
+            }
+            g_slice_free(FrameRecord_t, frame);
+        }
+        wtap_rec_cleanup(&dump_rec);
+        ws_buffer_free(&buf);
 
-        /* Avoid writing if already sorted and configured to */
-        if (write_output_regardless || (wrong_order_count > 0)) {
-            frame_write(frame, wth, pdh, &dump_rec, &buf, infile, outfile);
+        if (!write_output_regardless && (wrong_order_count == 0)) {
+            printf("Not writing output file because input file is already in order.\n");
         }
-        g_slice_free(FrameRecord_t, frame);
-    }
-    wtap_rec_cleanup(&dump_rec);
-    ws_buffer_free(&buf);
 
-    if (!write_output_regardless && (wrong_order_count == 0)) {
-        printf("Not writing output file because input file is already in order.\n");
+        /* Free the whole array */
+        g_ptr_array_free(frames, TRUE);
     }
-
-    /* Free the whole array */
-    g_ptr_array_free(frames, TRUE);
+    g_free(idb_inf);
+    idb_inf = NULL;
 
     /* Close outfile */
     if (!wtap_dump_close(pdh, &err)) {
@@ -33,6 +33,7 @@
 #include <version_info.h>
 #include <wiretap/wtap_opttypes.h>
 #include <wiretap/pcapng.h>
+#include <wiretap/wtap_index.h>
 
 #include <epan/decode_as.h>
 #include <epan/timestamp.h>
@@ -336,6 +337,8 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
   gchar       *err_info = NULL;
   gint64       data_offset;
   epan_dissect_t *edt = NULL;
+  wtap_index_writer_t *index_writer = NULL;
+  gboolean     read_all = TRUE;
 
   {
     /* Allocate a frame_data_sequence for all the frames. */
@@ -363,7 +366,15 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
       edt = epan_dissect_new(cf->epan, create_proto_tree, FALSE);
     }
 
+    /* Every packet still has to be dissected on this pass, but the
+       packet index we write here lets other programs skip reading the
+       file just to find its packets. */
+    if (prefs.capture_packet_index)
+      index_writer = wtap_index_writer_new(cf->provider.wth, cf->filename);
+
     while (wtap_read(cf->provider.wth, &err, &err_info, &data_offset)) {
+      if (index_writer != NULL)
+        wtap_index_writer_add(index_writer, cf->provider.wth, data_offset);
       if (process_packet(cf, edt, data_offset, wtap_get_rec(cf->provider.wth),
                          wtap_get_buf_ptr(cf->provider.wth))) {
         /* Stop reading if we have the maximum number of packets;
@@ -373,11 +384,19 @@ load_cap_file(capture_file *cf, int max_packet_count, gint64 max_byte_count)
          */
         if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
           err = 0; /* This is not an error */
+          read_all = FALSE;
           break;
         }
       }
     }
 
+    if (index_writer != NULL) {
+      if (err == 0 && read_all)
+        wtap_index_writer_finish(index_writer);
+      else
+        wtap_index_writer_abort(index_writer);
+    }
+
     if (edt) {
       epan_dissect_free(edt);
       edt = NULL;
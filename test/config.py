@@ -20,8 +20,10 @@ import tempfile
 commands = (
     'capinfos',
     'dumpcap',
+    'editcap',
     'mergecap',
     'rawshark',
+    'reordercap',
     'sharkd',
     'text2pcap',
     'tshark',
@@ -36,8 +38,10 @@ program_path = None
 # Strings
 cmd_capinfos = None
 cmd_dumpcap = None
+cmd_editcap = None
 cmd_mergecap = None
 cmd_rawshark = None
+cmd_reordercap = None
 cmd_tshark = None
 cmd_text2pcap = None
 cmd_wireshark = None
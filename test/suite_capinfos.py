@@ -0,0 +1,70 @@
+#
+# -*- coding: utf-8 -*-
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Capinfos tests'''
+
+import config
+import os.path
+import re
+import struct
+import subprocesstest
+import unittest
+
+dhcp_pcap = os.path.join(config.capture_dir, 'dhcp.pcap')
+dhcp_pcapng = os.path.join(config.capture_dir, 'dhcp.pcapng')
+
+def write_erf_pcap(pcap_file, num_packets, payload_len, wlen):
+    '''Write a pcap file with LINKTYPE_ERF records.
+
+    Each record has an HDLC/PoS ERF header and payload_len bytes after it,
+    of which only wlen were on the wire (the rest is padding).'''
+    rlen = 16 + payload_len
+    with open(pcap_file, 'wb') as f:
+        # Magic, version 2.4, thiszone, sigfigs, snaplen, LINKTYPE_ERF
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 197))
+        for i in range(num_packets):
+            secs = 1500000000 + i
+            f.write(struct.pack('<IIII', secs, 0, rlen, rlen))
+            # ERF timestamp, type 1 (HDLC/PoS), flags, rlen, lctr, wlen
+            f.write(struct.pack('<Q', secs << 32))
+            f.write(struct.pack('>BBHHH', 1, 0, rlen, 0, wlen))
+            f.write(bytes(bytearray(payload_len)))
+
+class case_capinfos_erf(subprocesstest.SubprocessTestCase):
+    def test_capinfos_erf_lengths(self):
+        '''Packet lengths of ERF records come from the ERF wire length.'''
+        erf_pcap = self.filename_from_id('erf.pcap')
+        write_erf_pcap(erf_pcap, 4, 64, 60)
+        capinfos_out = self.getCaptureInfo(capinfos_args=('-M', '-c', '-d', '-z'), cap_file=erf_pcap)
+        self.assertTrue(re.search(r'Number of packets:\s+4', capinfos_out))
+        self.assertTrue(re.search(r'Data size:\s+240 bytes', capinfos_out))
+        self.assertTrue(re.search(r'Average packet size:\s+60.00 bytes', capinfos_out))
+
+class case_capinfos_jobs(subprocesstest.SubprocessTestCase):
+    def test_capinfos_jobs_same_output(self):
+        '''capinfos -j reports the same infos, in the same order.'''
+        outputs = []
+        for jobs in ('1', '4'):
+            capinfos_proc = self.assertRun((config.cmd_capinfos,
+                '-M', '-T', '-j', jobs,
+                dhcp_pcap, dhcp_pcapng, dhcp_pcap,
+            ))
+            outputs.append(capinfos_proc.stdout_str)
+        self.assertEqual(outputs[0], outputs[1], 'capinfos -j output differs')
+
+class case_capinfos_open_stats(subprocesstest.SubprocessTestCase):
+    def test_capinfos_open_stats(self):
+        '''capinfos --open-stats reports which file readers were tried.'''
+        self.assertRun((config.cmd_capinfos,
+            '-t', '--open-stats',
+            dhcp_pcap, dhcp_pcapng, dhcp_pcap,
+        ))
+        self.assertTrue(self.grepOutput(r'^File reader\s+Tried\s+Matched\s+Skipped\s+Time \(ms\)'))
+        # The pcapng file's magic number rules out the pcap reader, and
+        # the pcap reader comes first, so the pcapng reader is never tried
+        # on the pcap files.
+        self.assertTrue(self.grepOutput(r'^Wireshark/tcpdump/\.\.\. - pcap\s+2\s+2\s+1\s'))
+        self.assertTrue(self.grepOutput(r'^Wireshark/\.\.\. - pcapng\s+1\s+1\s+0\s'))
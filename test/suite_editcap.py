@@ -0,0 +1,172 @@
+#
+# -*- coding: utf-8 -*-
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Editcap tests'''
+
+import config
+import os
+import os.path
+import shutil
+import struct
+import subprocesstest
+import tempfile
+import time
+import unittest
+
+# Two bursts of packets 5 ms apart, with a 20 second gap between them,
+# starting a quarter of a second into a second so that -i intervals
+# don't start on whole seconds.
+first_secs = 1500000000
+burst_packets = 1000
+packet_gap_usecs = 5000
+burst_gap_secs = 20
+
+def packet_timestamps():
+    timestamps = []
+    for burst in range(2):
+        burst_start = (first_secs + burst * (burst_gap_secs + 5)) * 1000000 + 250000
+        timestamps += [burst_start + i * packet_gap_usecs for i in range(burst_packets)]
+    return timestamps
+
+def frame_data(i):
+    # A minimal Ethernet frame that says which input frame it was
+    return struct.pack('>6s6sHI', b'\x00\x01\x02\x03\x04\x05', b'\x00\x06\x07\x08\x09\x0a', 0x88b5, i) + bytes(bytearray(42))
+
+def write_pcap(pcap_file, timestamps):
+    with open(pcap_file, 'wb') as f:
+        # Magic, version 2.4, thiszone, sigfigs, snaplen, LINKTYPE_ETHERNET
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for i, ts in enumerate(timestamps):
+            data = frame_data(i)
+            f.write(struct.pack('<IIII', ts // 1000000, ts % 1000000, len(data), len(data)))
+            f.write(data)
+
+def pcapng_block(block_type, body):
+    block_len = 12 + len(body)
+    return struct.pack('<II', block_type, block_len) + body + struct.pack('<I', block_len)
+
+def write_pcapng(pcapng_file, timestamps):
+    with open(pcapng_file, 'wb') as f:
+        # Section Header Block: byte order magic, version 1.0, unknown section length
+        f.write(pcapng_block(0x0a0d0d0a, struct.pack('<IHHq', 0x1a2b3c4d, 1, 0, -1)))
+        # Interface Description Block: LINKTYPE_ETHERNET, snaplen
+        f.write(pcapng_block(0x00000001, struct.pack('<HHI', 1, 0, 65535)))
+        for i, ts in enumerate(timestamps):
+            data = frame_data(i)
+            body = struct.pack('<IIIII', 0, ts >> 32, ts & 0xffffffff, len(data), len(data))
+            body += data + bytes(bytearray(-len(data) % 4))
+            # Enhanced Packet Block
+            f.write(pcapng_block(0x00000006, body))
+
+def local_time(secs):
+    '''The -A/-B form of a time stamp.'''
+    return time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(secs))
+
+class case_editcap_index(subprocesstest.SubprocessTestCase):
+    def setUp(self):
+        self.work_dir = tempfile.mkdtemp(prefix='editcap-test-')
+        self.addCleanup(shutil.rmtree, self.work_dir)
+
+    def make_inputs(self, extension):
+        '''Write the same capture file into two directories, and a packet
+        index next to one of them. Return the paths of both files.'''
+        paths = []
+        for sub_dir in ('plain', 'indexed'):
+            os.mkdir(os.path.join(self.work_dir, sub_dir))
+            paths.append(os.path.join(self.work_dir, sub_dir, 'in.' + extension))
+        if extension == 'pcapng':
+            write_pcapng(paths[0], packet_timestamps())
+        else:
+            write_pcap(paths[0], packet_timestamps())
+        shutil.copyfile(paths[0], paths[1])
+        self.assertRun((config.cmd_tshark,
+                '-o', 'capture.packet_index:TRUE',
+                '-2',
+                '-r', paths[1],
+                '-T', 'fields', '-e', 'frame.number',
+            ))
+        self.assertTrue(os.path.isfile(paths[1] + '.wsidx'), 'TShark did not write a packet index')
+        return paths
+
+    def run_both(self, inputs, name, editcap_args):
+        '''Run editcap on the file without an index and on the file with
+        one, writing into separate directories, and check that they wrote
+        the same files. Return the contents of the files, keyed by name.'''
+        plain_in, indexed_in = inputs
+        extension = os.path.splitext(plain_in)[1]
+        outputs = []
+        for in_file, extra_args in ((plain_in, ()), (indexed_in, ('--threads', '4'))):
+            out_dir = os.path.join(os.path.dirname(in_file), name)
+            os.mkdir(out_dir)
+            self.assertRun((config.cmd_editcap, '-v') + extra_args + editcap_args +
+                (in_file, os.path.join(out_dir, 'out' + extension)))
+            output = {}
+            for out_name in os.listdir(out_dir):
+                with open(os.path.join(out_dir, out_name), 'rb') as f:
+                    output[out_name] = f.read()
+            outputs.append(output)
+        self.assertEqual(sorted(outputs[1]), sorted(outputs[0]), 'editcap {} wrote different files'.format(name))
+        for out_name in outputs[0]:
+            self.assertEqual(outputs[1][out_name], outputs[0][out_name], 'editcap {} wrote a different {}'.format(name, out_name))
+        return outputs[0]
+
+    def check_split_count(self, extension):
+        inputs = self.make_inputs(extension)
+        # Every file full, the last file partial, one file exactly, one file partial
+        for count in (500, 700, 2 * burst_packets, 5000):
+            outputs = self.run_both(inputs, 'c{}'.format(count), ('-c', str(count)))
+            num_files = (2 * burst_packets + count - 1) // count
+            self.assertEqual(len(outputs), num_files)
+            if num_files > 1:
+                self.assertTrue(self.grepOutput('Writing {} files with'.format(num_files)))
+
+    def check_split_interval(self, extension):
+        # Packets fall exactly on every second interval boundary, and the
+        # gap between the bursts leaves intervals with no packets.
+        inputs = self.make_inputs(extension)
+        for secs in (1, 2, 7):
+            outputs = self.run_both(inputs, 'i{}'.format(secs), ('-i', str(secs)))
+            span_secs = 5 + burst_gap_secs + 5
+            self.assertEqual(len(outputs), (span_secs + secs - 1) // secs)
+            self.assertTrue(self.grepOutput('Writing {} files with'.format(len(outputs))))
+            # Empty files hold only the file header, or the SHB and IDB
+            sizes = [len(data) for data in outputs.values()]
+            self.assertTrue(min(sizes) < 200, 'no empty files for -i {}'.format(secs))
+
+    def test_editcap_split_count_pcap(self):
+        '''Split a pcap file by packet count with and without the index.'''
+        self.check_split_count('pcap')
+
+    def test_editcap_split_count_pcapng(self):
+        '''Split a pcapng file by packet count with and without the index.'''
+        self.check_split_count('pcapng')
+
+    def test_editcap_split_interval_pcap(self):
+        '''Split a pcap file by time interval with and without the index.'''
+        self.check_split_interval('pcap')
+
+    def test_editcap_split_interval_pcapng(self):
+        '''Split a pcapng file by time interval with and without the index.'''
+        self.check_split_interval('pcapng')
+
+    def test_editcap_time_range(self):
+        '''Select time ranges with -A and -B with and without the index.'''
+        ranges = (
+            # Starting before the first packet
+            (first_secs - 10, first_secs + 2),
+            # Within the first burst, on whole seconds
+            (first_secs + 1, first_secs + 3),
+            # Within the gap, with no packets
+            (first_secs + 10, first_secs + 20),
+            # Running past the last packet
+            (first_secs + 26, first_secs + 100),
+        )
+        inputs = self.make_inputs('pcap')
+        for start, stop in ranges:
+            name = 'A{}B{}'.format(start - first_secs, stop - first_secs)
+            outputs = self.run_both(inputs, name, ('-A', local_time(start), '-B', local_time(stop)))
+            self.assertEqual(len(outputs), 1)
+            self.assertTrue(self.grepOutput('using the index'))
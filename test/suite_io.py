@@ -11,7 +11,10 @@
 
 import config
 import io
+import os
 import os.path
+import shutil
+import struct
 import subprocesstest
 import sys
 import unittest
@@ -70,6 +73,129 @@ class case_tshark_io(subprocesstest.SubprocessTestCase):
         '''Read direct and write direct using TShark'''
         check_io_4_packets(self, cmd=config.cmd_tshark)
 
+class case_tshark_packet_index(subprocesstest.SubprocessTestCase):
+    def setUp(self):
+        self.capture_file = self.filename_from_id('in.pcap')
+        self.index_file = self.filename_from_id('in.pcap.wsidx')
+        # Bigger than the part of the file that the index checksums
+        shutil.copyfile(os.path.join(config.capture_dir, 'http2-data-reassembly.pcap'), self.capture_file)
+
+    def run_tshark(self, index):
+        '''Do a two-pass read of the capture file, writing every packet, and
+        return what was written.'''
+        testout_file = self.filename_from_id(testout_pcap)
+        self.assertRun((config.cmd_tshark,
+                '-o', 'capture.packet_index:{}'.format('TRUE' if index else 'FALSE'),
+                '-2',
+                '-r', self.capture_file,
+                '-F', 'pcap',
+                '-w', testout_file,
+            ))
+        with open(testout_file, 'rb') as f:
+            return f.read()
+
+    def age_index(self):
+        '''Set the index's modification time back a day, so that we can tell
+        whether it was rewritten.'''
+        index_mtime = os.stat(self.index_file).st_mtime - 24 * 60 * 60
+        os.utime(self.index_file, (index_mtime, index_mtime))
+        return index_mtime
+
+    def check_index_used(self):
+        index_mtime = self.age_index()
+        self.assertEqual(self.run_tshark(True), self.run_tshark(False))
+        self.assertEqual(os.stat(self.index_file).st_mtime, index_mtime, 'The index was rewritten')
+
+    def check_index_rewritten(self, change):
+        index_mtime = self.age_index()
+        change()
+        self.assertEqual(self.run_tshark(True), self.run_tshark(False))
+        self.assertNotEqual(os.stat(self.index_file).st_mtime, index_mtime, 'A stale index was not rewritten')
+        # The rewritten index is up to date.
+        self.check_index_used()
+
+    def write_index(self):
+        self.run_tshark(True)
+        self.assertTrue(os.path.isfile(self.index_file), 'TShark did not write a packet index')
+
+    def test_packet_index_round_trip(self):
+        '''An up-to-date index is used, and gives the same packets as the file.'''
+        self.write_index()
+        self.check_index_used()
+
+    def test_packet_index_stale_size(self):
+        '''An index for a file that has grown is rewritten.'''
+        self.write_index()
+        def append_packets():
+            with open(self.capture_file, 'rb') as f:
+                capture = f.read()
+            with open(self.capture_file, 'ab') as f:
+                f.write(capture[24:])
+        self.check_index_rewritten(append_packets)
+
+    def test_packet_index_stale_mtime(self):
+        '''An index for a file with a different modification time is rewritten.'''
+        self.write_index()
+        def touch_capture():
+            capture_mtime = os.stat(self.capture_file).st_mtime + 10
+            os.utime(self.capture_file, (capture_mtime, capture_mtime))
+        self.check_index_rewritten(touch_capture)
+
+    @unittest.skipUnless(sys.version_info >= (3, 3), 'Requires nanosecond file times')
+    def test_packet_index_stale_head(self):
+        '''An index for a file rewritten with the same size and modification
+        time is rewritten.'''
+        self.write_index()
+        def change_first_packet():
+            capture_stat = os.stat(self.capture_file)
+            with open(self.capture_file, 'r+b') as f:
+                # Flip the last byte of the first packet's data.
+                f.seek(24 + 8)
+                incl_len = struct.unpack('<I', f.read(4))[0]
+                f.seek(24 + 16 + incl_len - 1)
+                data = bytearray(f.read(1))
+                data[0] ^= 0xff
+                f.seek(24 + 16 + incl_len - 1)
+                f.write(bytes(data))
+            os.utime(self.capture_file, ns=(capture_stat.st_atime_ns, capture_stat.st_mtime_ns))
+            self.assertEqual(os.stat(self.capture_file).st_mtime_ns, capture_stat.st_mtime_ns)
+        self.check_index_rewritten(change_first_packet)
+
+    def test_packet_index_stale_version(self):
+        '''An index with a different format version is rewritten.'''
+        self.write_index()
+        with open(self.index_file, 'rb') as f:
+            index_header = f.read(6)
+        index_version = struct.unpack('=H', index_header[4:6])[0]
+        def change_index_version():
+            with open(self.index_file, 'r+b') as f:
+                f.seek(4)
+                f.write(struct.pack('=H', index_version - 1))
+        self.check_index_rewritten(change_index_version)
+        with open(self.index_file, 'rb') as f:
+            self.assertEqual(f.read(6), index_header)
+
+    def test_packet_index_mid_file_idb(self):
+        '''A pcapng file with an interface description after the first packet
+        isn't indexed.'''
+        with open(os.path.join(config.capture_dir, 'dhcp.pcapng'), 'rb') as f:
+            capture = f.read()
+        blocks = []
+        offset = 0
+        while offset < len(capture):
+            block_type, block_len = struct.unpack('<II', capture[offset:offset + 8])
+            blocks.append((block_type, capture[offset:offset + block_len]))
+            offset += block_len
+        idb = [block for block_type, block in blocks if block_type == 0x00000001][0]
+        first_epb = [i for i, (block_type, block) in enumerate(blocks) if block_type == 0x00000006][0]
+        blocks.insert(first_epb + 1, (0x00000001, idb))
+        self.capture_file = self.filename_from_id('in.pcapng')
+        self.index_file = self.filename_from_id('in.pcapng.wsidx')
+        with open(self.capture_file, 'wb') as f:
+            f.write(b''.join(block for block_type, block in blocks))
+        self.assertEqual(self.run_tshark(True), self.run_tshark(False))
+        self.assertFalse(os.path.exists(self.index_file), 'TShark indexed a file with a mid-file IDB')
+
 # The Bash version didn't test Wireshark or dumpcap
 
 class case_rawshark_io(subprocesstest.SubprocessTestCase):
@@ -0,0 +1,121 @@
+#
+# -*- coding: utf-8 -*-
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Reordercap tests'''
+
+import config
+import os.path
+import random
+import re
+import struct
+import subprocesstest
+import unittest
+
+num_frames = 2000
+
+def shuffled_timestamps(num_frames, block_size, seed):
+    '''Time stamps, in microseconds, that are out of order within blocks
+    of block_size frames. A few of them are equal.'''
+    rng = random.Random(seed)
+    timestamps = []
+    for start in range(0, num_frames, block_size):
+        block = [1500000000000000 + i * 1000 for i in range(start, min(start + block_size, num_frames))]
+        rng.shuffle(block)
+        timestamps += block
+    for i in range(0, num_frames - 1, 97):
+        timestamps[i + 1] = timestamps[i]
+    return timestamps
+
+def frame_data(i):
+    # A minimal Ethernet frame that says which input frame it was
+    return struct.pack('>6s6sHI', b'\x00\x01\x02\x03\x04\x05', b'\x00\x06\x07\x08\x09\x0a', 0x88b5, i) + bytes(bytearray(42))
+
+def write_pcap(pcap_file, timestamps):
+    with open(pcap_file, 'wb') as f:
+        # Magic, version 2.4, thiszone, sigfigs, snaplen, LINKTYPE_ETHERNET
+        f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+        for i, ts in enumerate(timestamps):
+            data = frame_data(i)
+            f.write(struct.pack('<IIII', ts // 1000000, ts % 1000000, len(data), len(data)))
+            f.write(data)
+
+def pcapng_block(block_type, body):
+    block_len = 12 + len(body)
+    return struct.pack('<II', block_type, block_len) + body + struct.pack('<I', block_len)
+
+def pcapng_option(code, value):
+    padding = bytes(bytearray(-len(value) % 4))
+    return struct.pack('<HH', code, len(value)) + value + padding
+
+def write_pcapng(pcapng_file, timestamps):
+    '''Like write_pcap(), with a comment on every tenth frame.'''
+    with open(pcapng_file, 'wb') as f:
+        # Section Header Block: byte order magic, version 1.0, unknown section length
+        f.write(pcapng_block(0x0a0d0d0a, struct.pack('<IHHq', 0x1a2b3c4d, 1, 0, -1)))
+        # Interface Description Block: LINKTYPE_ETHERNET, snaplen
+        f.write(pcapng_block(0x00000001, struct.pack('<HHI', 1, 0, 65535)))
+        for i, ts in enumerate(timestamps):
+            data = frame_data(i)
+            body = struct.pack('<IIIII', 0, ts >> 32, ts & 0xffffffff, len(data), len(data))
+            body += data + bytes(bytearray(-len(data) % 4))
+            if i % 10 == 0:
+                body += pcapng_option(1, 'frame {}'.format(i).encode('utf-8'))
+                body += pcapng_option(0, b'')
+            # Enhanced Packet Block
+            f.write(pcapng_block(0x00000006, body))
+
+class case_reordercap_modes(subprocesstest.SubprocessTestCase):
+    def check_modes(self, infile, extension):
+        '''Check that the window and spill modes write what the default
+        (in-memory) sort writes.'''
+        outputs = {}
+        reports = {}
+        for mode_args in ((), ('-s', '100'), ('-s', '100000'), ('-w', '64'), ('-t', '100'), ('-w', '64', '-t', '100')):
+            name = ''.join(mode_args) or 'default'
+            testout_file = self.filename_from_id('testout-{}.{}'.format(name, extension))
+            reordercap_proc = self.assertRun((config.cmd_reordercap,) + mode_args + (infile, testout_file))
+            reports[name] = reordercap_proc.stdout_str.splitlines()[0]
+            with open(testout_file, 'rb') as f:
+                outputs[name] = f.read()
+        self.assertTrue(re.match(r'{} frames, [1-9]\d* out of order'.format(num_frames), reports['default']))
+        for name in outputs:
+            self.assertEqual(reports[name], reports['default'], 'reordercap {} report differs'.format(name))
+            self.assertEqual(outputs[name], outputs['default'], 'reordercap {} output differs'.format(name))
+
+    def test_reordercap_modes_pcap(self):
+        '''Reorder a pcap file in each mode.'''
+        infile = self.filename_from_id('testin.pcap')
+        write_pcap(infile, shuffled_timestamps(num_frames, 32, 1))
+        self.check_modes(infile, 'pcap')
+
+    def test_reordercap_modes_pcapng(self):
+        '''Reorder a pcapng file with packet comments in each mode.'''
+        infile = self.filename_from_id('testin.pcapng')
+        write_pcapng(infile, shuffled_timestamps(num_frames, 32, 2))
+        self.check_modes(infile, 'pcapng')
+
+    def test_reordercap_window_too_small(self):
+        '''A reorder window that is too small is reported.'''
+        infile = self.filename_from_id('testin.pcap')
+        testout_file = self.filename_from_id('testout.pcap')
+        write_pcap(infile, shuffled_timestamps(num_frames, 32, 3))
+        self.assertRun((config.cmd_reordercap, '-w', '4', infile, testout_file))
+        self.assertTrue(self.grepOutput('arrived too late for the reorder window'))
+
+class case_reordercap_in_order(subprocesstest.SubprocessTestCase):
+    def test_reordercap_in_order_not_written(self):
+        '''-n doesn't write the frames of an ordered file, in either sort mode.'''
+        infile = self.filename_from_id('testin.pcap')
+        write_pcap(infile, shuffled_timestamps(num_frames, 1, 4))
+        outputs = []
+        for mode_args in ((), ('-s', '100')):
+            testout_file = self.filename_from_id('testout{}.pcap'.format(len(mode_args)))
+            self.assertRun((config.cmd_reordercap, '-n') + mode_args + (infile, testout_file))
+            self.assertTrue(self.grepOutput('{} frames, 0 out of order'.format(num_frames)))
+            self.assertTrue(self.grepOutput('Not writing output file'))
+            with open(testout_file, 'rb') as f:
+                outputs.append(f.read())
+        self.assertEqual(outputs[0], outputs[1], 'reordercap -n -s output differs')
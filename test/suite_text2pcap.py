@@ -249,6 +249,60 @@ class case_text2pcap_pcap(subprocesstest.SubprocessTestCase):
         '''Test text2pcap with sip.pcapng.'''
         check_text2pcap(self, sip_pcapng, 'pcapng')
 
+class case_text2pcap_threads(subprocesstest.SubprocessTestCase):
+    def test_text2pcap_threads(self):
+        '''Test that text2pcap --threads writes the same file.'''
+        testin_file = self.filename_from_id(testin_txt)
+        tshark_cmd = '{cmd} -r {cf} -x > {of}'.format(
+            cmd = config.cmd_tshark,
+            cf = wpa_induction_pcap_gz,
+            of = testin_file,
+        )
+        self.assertRun(tshark_cmd, shell=True, env=os.environ.copy())
+
+        outputs = []
+        for threads in ('1', '2', '4'):
+            testout_file = self.filename_from_id('testout-{}.pcapng'.format(threads))
+            self.assertRun((config.cmd_text2pcap,
+                '-q', '-n', '-D',
+                '-T', '1000,80',
+                '--threads', threads,
+                testin_file,
+                testout_file,
+            ))
+            with open(testout_file, 'rb') as f:
+                outputs.append(f.read())
+        self.assertEqual(outputs[0], outputs[1], 'text2pcap --threads 2 output differs')
+        self.assertEqual(outputs[0], outputs[2], 'text2pcap --threads 4 output differs')
+        cap_info = check_capinfos_info(self, self.filename_from_id('testout-4.pcapng'))
+        self.assertGreater(cap_info['packets'], 500)
+
+class case_text2pcap_line_decoder(subprocesstest.SubprocessTestCase):
+    def test_text2pcap_line_decoder(self):
+        '''Test that hex dump lines are decoded the same way as by the scanner.'''
+        # With -d -d every line goes through the scanner, which prints
+        # each token; otherwise most lines are decoded by parse_hex_line().
+        testin_file = self.filename_from_id(testin_txt)
+        tshark_cmd = '{cmd} -r {cf} -x > {of}'.format(
+            cmd = config.cmd_tshark,
+            cf = wpa_induction_pcap_gz,
+            of = testin_file,
+        )
+        self.assertRun(tshark_cmd, shell=True, env=os.environ.copy())
+
+        for extra_args in ((), ('-a',)):
+            outputs = []
+            for debug_args in ((), ('-d', '-d')):
+                testout_file = self.filename_from_id('testout-{}.pcap'.format(len(debug_args)))
+                self.assertRun((config.cmd_text2pcap,) + debug_args + extra_args + (
+                    testin_file,
+                    testout_file,
+                ))
+                with open(testout_file, 'rb') as f:
+                    outputs.append(f.read())
+            self.assertEqual(outputs[0], outputs[1],
+                'text2pcap {} output differs from the scanner\'s'.format(' '.join(extra_args)))
+
 class case_text2pcap_eol_hash(subprocesstest.SubprocessTestCase):
     def test_text2pcap_eol_hash(self):
         '''Test text2pcap hash sign at the end-of-line.'''
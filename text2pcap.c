@@ -102,6 +102,8 @@
 #include <wsutil/crash_info.h>
 #include <version_info.h>
 #include <wsutil/inet_addr.h>
+#include <wsutil/crc32.h>
+#include <wsutil/ws_cksum.h>
 
 #ifdef _WIN32
 #include <io.h>     /* for _setmode */
@@ -131,6 +133,8 @@
 
 #include "wiretap/wtap.h"
 
+#define LONGOPT_THREADS 0x10000
+
 #ifdef _WIN32
 #include <wsutil/unicode-utils.h>
 #endif /* _WIN32 */
@@ -307,13 +311,13 @@ static hdr_ip_t HDR_IP = {0x45, 0, 0, 0x3412, 0, 0, 0xff, 0, 0,
 #define IP_DST 0x0202020a
 #endif
 
-static struct {         /* pseudo header for checksum calculation */
+typedef struct {        /* pseudo header for checksum calculation */
     guint32 src_addr;
     guint32 dest_addr;
     guint8  zero;
     guint8  protocol;
     guint16 length;
-} pseudoh;
+} pseudo_hdr_t;
 
 
 /* headers taken from glibc */
@@ -334,12 +338,12 @@ typedef struct {
 
 static hdr_ipv6_t HDR_IPv6;
 
-static struct {                 /* pseudo header ipv6 for checksum calculation */
+typedef struct {                /* pseudo header ipv6 for checksum calculation */
     struct  e_in6_addr src_addr6;
     struct  e_in6_addr dst_addr6;
     guint32 protocol;
     guint32 zero;
-} pseudoh6;
+} pseudo_hdr6_t;
 
 
 typedef struct {
@@ -386,7 +390,43 @@ typedef struct {
 
 static hdr_data_chunk_t HDR_DATA_CHUNK = {0, 0, 0, 0, 0, 0, 0};
 
-static char tempbuf[64];
+/* ----- Packet queue ------------------------------------------------------------*/
+
+/*
+ * A packet that has been read and is waiting to be written.  Its headers
+ * and checksums are filled in by build_packet(), either inline or, with
+ * --threads, on a pool of worker threads; the packets are written out in
+ * the order in which they were read.
+ */
+typedef struct {
+    guint8      *buf;           /* room for headers, data and trailers */
+    guint32      length;        /* length of the packet in buf */
+    gboolean     cont;          /* packet continues in the next one */
+    gboolean     first;         /* packet starts a message */
+    gboolean     is_inbound;
+    time_t       ts_sec;
+    guint32      ts_nsec;
+    guint32      direction;
+    guint32      tcp_seq_num;   /* network byte order */
+    guint32      tcp_ack_num;   /* network byte order */
+    guint32      tsn;
+    guint16      ssn;
+    ws_in6_addr  ip6_src;
+    ws_in6_addr  ip6_dst;
+    gboolean     done;          /* build_packet() has finished */
+} packet_job_t;
+
+/* Room after the packet data for SCTP padding or an Ethernet trailer */
+#define PACKET_TRAILER_MAX_LEN  60
+
+static guint        num_threads = 1;
+static GThreadPool *build_pool  = NULL;
+static GQueue       pending_jobs = G_QUEUE_INIT;
+static GMutex       pending_jobs_mutex;
+static GCond        pending_jobs_cond;
+
+/* Packets allowed to be waiting to be written before reading stops */
+#define MAX_PENDING_JOBS    (num_threads * 64)
 
 /*----------------------------------------------------------------------
  * Stuff for writing a PCap file
@@ -427,8 +467,15 @@ write_byte(const char *str)
 {
     guint32 num;
 
-    if (parse_num(str, FALSE, &num) != EXIT_SUCCESS)
+    /*
+     * The scanner only hands us bytes as two hex digits, so don't
+     * bother with strtoul() for them.
+     */
+    if (str != NULL && g_ascii_isxdigit(str[0]) && g_ascii_isxdigit(str[1])) {
+        num = (g_ascii_xdigit_value(str[0]) << 4) | g_ascii_xdigit_value(str[1]);
+    } else if (parse_num(str, FALSE, &num) != EXIT_SUCCESS) {
         return EXIT_FAILURE;
+    }
 
     packet_buf[curr_offset] = (guint8) num;
     curr_offset++;
@@ -440,19 +487,15 @@ write_byte(const char *str)
 }
 
 /*----------------------------------------------------------------------
- * Write a number of bytes into current packet
+ * Write a number of bytes into a packet being built
  */
 
 static void
-write_bytes (const char bytes[], guint32 nbytes)
+write_bytes (guint8 *buf, guint32 *offset, const void *bytes, guint32 nbytes)
 {
-    guint32 i;
-
-    if (curr_offset + nbytes < WTAP_MAX_PACKET_SIZE_STANDARD) {
-        for (i = 0; i < nbytes; i++) {
-            packet_buf[curr_offset] = bytes[i];
-            curr_offset++;
-        }
+    if (*offset + nbytes < WTAP_MAX_PACKET_SIZE_STANDARD) {
+        memcpy(buf + *offset, bytes, nbytes);
+        *offset += nbytes;
     }
 }
 
@@ -471,19 +514,15 @@ unwrite_bytes (guint32 nbytes)
 static guint16
 in_checksum (void *buf, guint32 count)
 {
-    guint32 sum = 0;
-    guint16 *addr = (guint16 *)buf;
+    guint32 sum;
+    guint8 *addr = (guint8 *)buf;
 
-    while (count > 1) {
-        /*  This is the inner loop */
-        sum += g_ntohs(* (guint16 *) addr);
-        addr++;
-        count -= 2;
-    }
+    /*  Add up the whole words; the sum is in host byte order */
+    sum = g_ntohs(ws_cksum_sum16(addr, count));
 
     /*  Add left-over byte, if any */
-    if (count > 0)
-        sum += g_ntohs(* (guint8 *) addr);
+    if (count & 1)
+        sum += g_ntohs(addr[count - 1]);
 
     /*  Fold 32-bit sum to 16 bits */
     while (sum>>16)
@@ -493,92 +532,6 @@ in_checksum (void *buf, guint32 count)
     return g_htons(sum);
 }
 
-/* The CRC32C code is taken from draft-ietf-tsvwg-sctpcsum-01.txt.
- * That code is copyrighted by D. Otis and has been modified.
- */
-
-#define CRC32C(c,d) (c=(c>>8)^crc_c[(c^(d))&0xFF])
-static guint32 crc_c[256] =
-{
-0x00000000U, 0xF26B8303U, 0xE13B70F7U, 0x1350F3F4U,
-0xC79A971FU, 0x35F1141CU, 0x26A1E7E8U, 0xD4CA64EBU,
-0x8AD958CFU, 0x78B2DBCCU, 0x6BE22838U, 0x9989AB3BU,
-0x4D43CFD0U, 0xBF284CD3U, 0xAC78BF27U, 0x5E133C24U,
-0x105EC76FU, 0xE235446CU, 0xF165B798U, 0x030E349BU,
-0xD7C45070U, 0x25AFD373U, 0x36FF2087U, 0xC494A384U,
-0x9A879FA0U, 0x68EC1CA3U, 0x7BBCEF57U, 0x89D76C54U,
-0x5D1D08BFU, 0xAF768BBCU, 0xBC267848U, 0x4E4DFB4BU,
-0x20BD8EDEU, 0xD2D60DDDU, 0xC186FE29U, 0x33ED7D2AU,
-0xE72719C1U, 0x154C9AC2U, 0x061C6936U, 0xF477EA35U,
-0xAA64D611U, 0x580F5512U, 0x4B5FA6E6U, 0xB93425E5U,
-0x6DFE410EU, 0x9F95C20DU, 0x8CC531F9U, 0x7EAEB2FAU,
-0x30E349B1U, 0xC288CAB2U, 0xD1D83946U, 0x23B3BA45U,
-0xF779DEAEU, 0x05125DADU, 0x1642AE59U, 0xE4292D5AU,
-0xBA3A117EU, 0x4851927DU, 0x5B016189U, 0xA96AE28AU,
-0x7DA08661U, 0x8FCB0562U, 0x9C9BF696U, 0x6EF07595U,
-0x417B1DBCU, 0xB3109EBFU, 0xA0406D4BU, 0x522BEE48U,
-0x86E18AA3U, 0x748A09A0U, 0x67DAFA54U, 0x95B17957U,
-0xCBA24573U, 0x39C9C670U, 0x2A993584U, 0xD8F2B687U,
-0x0C38D26CU, 0xFE53516FU, 0xED03A29BU, 0x1F682198U,
-0x5125DAD3U, 0xA34E59D0U, 0xB01EAA24U, 0x42752927U,
-0x96BF4DCCU, 0x64D4CECFU, 0x77843D3BU, 0x85EFBE38U,
-0xDBFC821CU, 0x2997011FU, 0x3AC7F2EBU, 0xC8AC71E8U,
-0x1C661503U, 0xEE0D9600U, 0xFD5D65F4U, 0x0F36E6F7U,
-0x61C69362U, 0x93AD1061U, 0x80FDE395U, 0x72966096U,
-0xA65C047DU, 0x5437877EU, 0x4767748AU, 0xB50CF789U,
-0xEB1FCBADU, 0x197448AEU, 0x0A24BB5AU, 0xF84F3859U,
-0x2C855CB2U, 0xDEEEDFB1U, 0xCDBE2C45U, 0x3FD5AF46U,
-0x7198540DU, 0x83F3D70EU, 0x90A324FAU, 0x62C8A7F9U,
-0xB602C312U, 0x44694011U, 0x5739B3E5U, 0xA55230E6U,
-0xFB410CC2U, 0x092A8FC1U, 0x1A7A7C35U, 0xE811FF36U,
-0x3CDB9BDDU, 0xCEB018DEU, 0xDDE0EB2AU, 0x2F8B6829U,
-0x82F63B78U, 0x709DB87BU, 0x63CD4B8FU, 0x91A6C88CU,
-0x456CAC67U, 0xB7072F64U, 0xA457DC90U, 0x563C5F93U,
-0x082F63B7U, 0xFA44E0B4U, 0xE9141340U, 0x1B7F9043U,
-0xCFB5F4A8U, 0x3DDE77ABU, 0x2E8E845FU, 0xDCE5075CU,
-0x92A8FC17U, 0x60C37F14U, 0x73938CE0U, 0x81F80FE3U,
-0x55326B08U, 0xA759E80BU, 0xB4091BFFU, 0x466298FCU,
-0x1871A4D8U, 0xEA1A27DBU, 0xF94AD42FU, 0x0B21572CU,
-0xDFEB33C7U, 0x2D80B0C4U, 0x3ED04330U, 0xCCBBC033U,
-0xA24BB5A6U, 0x502036A5U, 0x4370C551U, 0xB11B4652U,
-0x65D122B9U, 0x97BAA1BAU, 0x84EA524EU, 0x7681D14DU,
-0x2892ED69U, 0xDAF96E6AU, 0xC9A99D9EU, 0x3BC21E9DU,
-0xEF087A76U, 0x1D63F975U, 0x0E330A81U, 0xFC588982U,
-0xB21572C9U, 0x407EF1CAU, 0x532E023EU, 0xA145813DU,
-0x758FE5D6U, 0x87E466D5U, 0x94B49521U, 0x66DF1622U,
-0x38CC2A06U, 0xCAA7A905U, 0xD9F75AF1U, 0x2B9CD9F2U,
-0xFF56BD19U, 0x0D3D3E1AU, 0x1E6DCDEEU, 0xEC064EEDU,
-0xC38D26C4U, 0x31E6A5C7U, 0x22B65633U, 0xD0DDD530U,
-0x0417B1DBU, 0xF67C32D8U, 0xE52CC12CU, 0x1747422FU,
-0x49547E0BU, 0xBB3FFD08U, 0xA86F0EFCU, 0x5A048DFFU,
-0x8ECEE914U, 0x7CA56A17U, 0x6FF599E3U, 0x9D9E1AE0U,
-0xD3D3E1ABU, 0x21B862A8U, 0x32E8915CU, 0xC083125FU,
-0x144976B4U, 0xE622F5B7U, 0xF5720643U, 0x07198540U,
-0x590AB964U, 0xAB613A67U, 0xB831C993U, 0x4A5A4A90U,
-0x9E902E7BU, 0x6CFBAD78U, 0x7FAB5E8CU, 0x8DC0DD8FU,
-0xE330A81AU, 0x115B2B19U, 0x020BD8EDU, 0xF0605BEEU,
-0x24AA3F05U, 0xD6C1BC06U, 0xC5914FF2U, 0x37FACCF1U,
-0x69E9F0D5U, 0x9B8273D6U, 0x88D28022U, 0x7AB90321U,
-0xAE7367CAU, 0x5C18E4C9U, 0x4F48173DU, 0xBD23943EU,
-0xF36E6F75U, 0x0105EC76U, 0x12551F82U, 0xE03E9C81U,
-0x34F4F86AU, 0xC69F7B69U, 0xD5CF889DU, 0x27A40B9EU,
-0x79B737BAU, 0x8BDCB4B9U, 0x988C474DU, 0x6AE7C44EU,
-0xBE2DA0A5U, 0x4C4623A6U, 0x5F16D052U, 0xAD7D5351U,
-};
-
-static guint32
-crc32c (const guint8* buf, unsigned int len, guint32 crc32_init)
-{
-    unsigned int i;
-    guint32 crc;
-
-    crc = crc32_init;
-    for (i = 0; i < len; i++)
-        CRC32C(crc, buf[i]);
-
-    return crc;
-}
-
 static guint32
 finalize_crc32c (guint32 crc)
 {
@@ -608,261 +561,418 @@ number_of_padding_bytes (guint32 length)
 }
 
 /*----------------------------------------------------------------------
- * Write current packet out
+ * Build the headers and trailers of a queued packet
+ *
+ * This only uses the packet itself and the options, which don't change
+ * once the input has started being read, so it can be done on a worker
+ * thread.
  */
-static int
-write_current_packet (gboolean cont)
+static void
+build_packet (packet_job_t *job)
 {
-    guint32  length         = 0;
+    hdr_ethernet_t   eth_hdr   = HDR_ETHERNET;
+    hdr_ip_t         ip_hdr    = HDR_IP;
+    hdr_ipv6_t       ip6_hdr;
+    hdr_udp_t        udp_hdr   = HDR_UDP;
+    hdr_tcp_t        tcp_hdr   = HDR_TCP;
+    hdr_sctp_t       sctp_hdr  = HDR_SCTP;
+    hdr_data_chunk_t chunk_hdr = HDR_DATA_CHUNK;
+    pseudo_hdr_t     pseudoh;
+    pseudo_hdr6_t    pseudoh6;
+    guint8  *buf            = job->buf;
+    guint32  length         = job->length;
+    guint32  offset         = 0;
     guint16  padding_length = 0;
-    int      err;
     guint16  ihatemacros;
-    gboolean success;
+    gboolean isInbound      = job->is_inbound;
 
-    if (curr_offset > header_length) {
-        /* Write the packet */
+    memset(&ip6_hdr, 0, sizeof(ip6_hdr));
+    memset(&pseudoh, 0, sizeof(pseudoh));
+    memset(&pseudoh6, 0, sizeof(pseudoh6));
 
-        /* Is direction indication on with an inbound packet? */
-        gboolean isInbound = has_direction && (direction == 2);
+    /* Compute padding length */
+    if (hdr_sctp) {
+        padding_length = number_of_padding_bytes(length - header_length );
+    } else {
+        padding_length = 0;
+    }
 
-        /* if defined IPv6 we should rewrite hdr_ethernet_proto anyways */
-        if (hdr_ipv6) {
-            hdr_ethernet_proto = 0x86DD;
-            hdr_ip = FALSE;
-        }
+    /* Write Ethernet header */
+    if (hdr_ethernet) {
+        eth_hdr.l3pid = g_htons(hdr_ethernet_proto);
+        write_bytes(buf, &offset, &eth_hdr, sizeof(eth_hdr));
+    }
 
-        /* Compute packet length */
-        length = curr_offset;
-        if (hdr_sctp) {
-            padding_length = number_of_padding_bytes(length - header_length );
-        } else {
-            padding_length = 0;
+    /* Write IP header */
+    if (hdr_ip) {
+        if (isInbound) {
+            ip_hdr.src_addr = hdr_ip_dest_addr ? hdr_ip_dest_addr : IP_DST;
+            ip_hdr.dest_addr = hdr_ip_src_addr? hdr_ip_src_addr : IP_SRC;
         }
-        /* Reset curr_offset, since we now write the headers */
-        curr_offset = 0;
-
-        /* Write Ethernet header */
-        if (hdr_ethernet) {
-            HDR_ETHERNET.l3pid = g_htons(hdr_ethernet_proto);
-            write_bytes((const char *)&HDR_ETHERNET, sizeof(HDR_ETHERNET));
+        else {
+            ip_hdr.src_addr = hdr_ip_src_addr? hdr_ip_src_addr : IP_SRC;
+            ip_hdr.dest_addr = hdr_ip_dest_addr ? hdr_ip_dest_addr : IP_DST;
         }
 
-        /* Write IP header */
-        if (hdr_ip) {
-            if (isInbound) {
-                HDR_IP.src_addr = hdr_ip_dest_addr ? hdr_ip_dest_addr : IP_DST;
-                HDR_IP.dest_addr = hdr_ip_src_addr? hdr_ip_src_addr : IP_SRC;
-            }
-            else {
-                HDR_IP.src_addr = hdr_ip_src_addr? hdr_ip_src_addr : IP_SRC;
-                HDR_IP.dest_addr = hdr_ip_dest_addr ? hdr_ip_dest_addr : IP_DST;
-            }
+        ip_hdr.packet_length = g_htons(length - ip_offset + padding_length);
+        ip_hdr.protocol = (guint8) hdr_ip_proto;
+        ip_hdr.hdr_checksum = 0;
+        ip_hdr.hdr_checksum = in_checksum(&ip_hdr, sizeof(ip_hdr));
+        write_bytes(buf, &offset, &ip_hdr, sizeof(ip_hdr));
+    } else if (hdr_ipv6) {
+        ip6_hdr.ip6_src = job->ip6_src;
+        ip6_hdr.ip6_dst = job->ip6_dst;
+
+        ip6_hdr.ip6_ctlun.ip6_un2_vfc &= 0x0F;
+        ip6_hdr.ip6_ctlun.ip6_un2_vfc |= (6<< 4);
+        ip6_hdr.ip6_ctlun.ip6_un1.ip6_un1_plen = g_htons(length - ip_offset + padding_length);
+        ip6_hdr.ip6_ctlun.ip6_un1.ip6_un1_nxt  = (guint8) hdr_ip_proto;
+        ip6_hdr.ip6_ctlun.ip6_un1.ip6_un1_hlim = 32;
+        write_bytes(buf, &offset, &ip6_hdr, sizeof(ip6_hdr));
+
+        /* initialize pseudo ipv6 header for checksum calculation */
+        pseudoh6.src_addr6  = ip6_hdr.ip6_src;
+        pseudoh6.dst_addr6  = ip6_hdr.ip6_dst;
+        pseudoh6.zero       = 0;
+        pseudoh6.protocol   = (guint8) hdr_ip_proto;
+        ihatemacros         = g_ntohs(ip6_hdr.ip6_ctlun.ip6_un1.ip6_un1_plen);
+        pseudoh.length      = g_htons(length - ihatemacros + sizeof(udp_hdr));
+    }
 
-            HDR_IP.packet_length = g_htons(length - ip_offset + padding_length);
-            HDR_IP.protocol = (guint8) hdr_ip_proto;
-            HDR_IP.hdr_checksum = 0;
-            HDR_IP.hdr_checksum = in_checksum(&HDR_IP, sizeof(HDR_IP));
-            write_bytes((const char *)&HDR_IP, sizeof(HDR_IP));
-        } else if (hdr_ipv6) {
-            if (memcmp(isInbound ? &hdr_ipv6_dest_addr : &hdr_ipv6_src_addr, &NO_IPv6_ADDRESS, sizeof(ws_in6_addr)))
-                memcpy(&HDR_IPv6.ip6_src, isInbound ? &hdr_ipv6_dest_addr : &hdr_ipv6_src_addr, sizeof(ws_in6_addr));
-            if (memcmp(isInbound ? &hdr_ipv6_src_addr : &hdr_ipv6_dest_addr, &NO_IPv6_ADDRESS, sizeof(ws_in6_addr)))
-                memcpy(&HDR_IPv6.ip6_dst, isInbound ? &hdr_ipv6_src_addr : &hdr_ipv6_dest_addr, sizeof(ws_in6_addr));
-
-            HDR_IPv6.ip6_ctlun.ip6_un2_vfc &= 0x0F;
-            HDR_IPv6.ip6_ctlun.ip6_un2_vfc |= (6<< 4);
-            HDR_IPv6.ip6_ctlun.ip6_un1.ip6_un1_plen = g_htons(length - ip_offset + padding_length);
-            HDR_IPv6.ip6_ctlun.ip6_un1.ip6_un1_nxt  = (guint8) hdr_ip_proto;
-            HDR_IPv6.ip6_ctlun.ip6_un1.ip6_un1_hlim = 32;
-            write_bytes((const char *)&HDR_IPv6, sizeof(HDR_IPv6));
-
-            /* initialize pseudo ipv6 header for checksum calculation */
-            pseudoh6.src_addr6  = HDR_IPv6.ip6_src;
-            pseudoh6.dst_addr6  = HDR_IPv6.ip6_dst;
-            pseudoh6.zero       = 0;
-            pseudoh6.protocol   = (guint8) hdr_ip_proto;
-            ihatemacros         = g_ntohs(HDR_IPv6.ip6_ctlun.ip6_un1.ip6_un1_plen);
-            pseudoh.length      = g_htons(length - ihatemacros + sizeof(HDR_UDP));
-        }
+    if (!hdr_ipv6) {
+        /* initialize pseudo header for checksum calculation */
+        pseudoh.src_addr    = ip_hdr.src_addr;
+        pseudoh.dest_addr   = ip_hdr.dest_addr;
+        pseudoh.zero        = 0;
+        pseudoh.protocol    = (guint8) hdr_ip_proto;
+        pseudoh.length      = g_htons(length - header_length + sizeof(udp_hdr));
+    }
 
-        if (!hdr_ipv6) {
-            /* initialize pseudo header for checksum calculation */
-            pseudoh.src_addr    = HDR_IP.src_addr;
-            pseudoh.dest_addr   = HDR_IP.dest_addr;
-            pseudoh.zero        = 0;
-            pseudoh.protocol    = (guint8) hdr_ip_proto;
-            pseudoh.length      = g_htons(length - header_length + sizeof(HDR_UDP));
-        }
+    /* Write UDP header */
+    if (hdr_udp) {
+        guint16 x16;
+        guint32 u;
+
+        /* initialize the UDP header */
+        udp_hdr.source_port = isInbound ? g_htons(hdr_dest_port): g_htons(hdr_src_port);
+        udp_hdr.dest_port = isInbound ? g_htons(hdr_src_port) : g_htons(hdr_dest_port);
+        udp_hdr.length      = pseudoh.length;
+        udp_hdr.checksum = 0;
+        /* Note: g_ntohs()/g_htons() macro arg may be eval'd twice so calc value before invoking macro */
+        x16  = hdr_ipv6 ? in_checksum(&pseudoh6, sizeof(pseudoh6)) : in_checksum(&pseudoh, sizeof(pseudoh));
+        u    = g_ntohs(x16);
+        x16  = in_checksum(&udp_hdr, sizeof(udp_hdr));
+        u   += g_ntohs(x16);
+        x16  = in_checksum(buf + header_length, length - header_length);
+        u   += g_ntohs(x16);
+        x16  = (u & 0xffff) + (u>>16);
+        udp_hdr.checksum = g_htons(x16);
+        if (udp_hdr.checksum == 0) /* differentiate between 'none' and 0 */
+            udp_hdr.checksum = g_htons(1);
+        write_bytes(buf, &offset, &udp_hdr, sizeof(udp_hdr));
+    }
 
-        /* Write UDP header */
-        if (hdr_udp) {
-            guint16 x16;
-            guint32 u;
-
-            /* initialize the UDP header */
-            HDR_UDP.source_port = isInbound ? g_htons(hdr_dest_port): g_htons(hdr_src_port);
-            HDR_UDP.dest_port = isInbound ? g_htons(hdr_src_port) : g_htons(hdr_dest_port);
-            HDR_UDP.length      = pseudoh.length;
-            HDR_UDP.checksum = 0;
-            /* Note: g_ntohs()/g_htons() macro arg may be eval'd twice so calc value before invoking macro */
-            x16  = hdr_ipv6 ? in_checksum(&pseudoh6, sizeof(pseudoh6)) : in_checksum(&pseudoh, sizeof(pseudoh));
-            u    = g_ntohs(x16);
-            x16  = in_checksum(&HDR_UDP, sizeof(HDR_UDP));
-            u   += g_ntohs(x16);
-            x16  = in_checksum(packet_buf + header_length, length - header_length);
-            u   += g_ntohs(x16);
-            x16  = (u & 0xffff) + (u>>16);
-            HDR_UDP.checksum = g_htons(x16);
-            if (HDR_UDP.checksum == 0) /* differentiate between 'none' and 0 */
-                HDR_UDP.checksum = g_htons(1);
-            write_bytes((const char *)&HDR_UDP, sizeof(HDR_UDP));
+    /* Write TCP header */
+    if (hdr_tcp) {
+        guint16 x16;
+        guint32 u;
+
+         /* initialize pseudo header for checksum calculation */
+        pseudoh.src_addr    = ip_hdr.src_addr;
+        pseudoh.dest_addr   = ip_hdr.dest_addr;
+        pseudoh.zero        = 0;
+        pseudoh.protocol    = (guint8) hdr_ip_proto;
+        pseudoh.length      = g_htons(length - header_length + sizeof(tcp_hdr));
+        /* initialize the TCP header */
+        tcp_hdr.source_port = isInbound ? g_htons(hdr_dest_port): g_htons(hdr_src_port);
+        tcp_hdr.dest_port = isInbound ? g_htons(hdr_src_port) : g_htons(hdr_dest_port);
+        /* set ack number if we have direction */
+        if (has_direction) {
+            tcp_hdr.flags = 0x10;
+            tcp_hdr.ack_num = job->tcp_ack_num;
         }
-
-        /* Write TCP header */
-        if (hdr_tcp) {
-            guint16 x16;
-            guint32 u;
-
-             /* initialize pseudo header for checksum calculation */
-            pseudoh.src_addr    = HDR_IP.src_addr;
-            pseudoh.dest_addr   = HDR_IP.dest_addr;
-            pseudoh.zero        = 0;
-            pseudoh.protocol    = (guint8) hdr_ip_proto;
-            pseudoh.length      = g_htons(length - header_length + sizeof(HDR_TCP));
-            /* initialize the TCP header */
-            HDR_TCP.source_port = isInbound ? g_htons(hdr_dest_port): g_htons(hdr_src_port);
-            HDR_TCP.dest_port = isInbound ? g_htons(hdr_src_port) : g_htons(hdr_dest_port);
-            /* set ack number if we have direction */
-            if (has_direction) {
-                HDR_TCP.flags = 0x10;
-                HDR_TCP.ack_num = g_ntohl(isInbound ? tcp_out_seq_num : tcp_in_seq_num);
-                HDR_TCP.ack_num = g_htonl(HDR_TCP.ack_num);
-            }
-            else {
-                HDR_TCP.flags = 0;
-                HDR_TCP.ack_num = 0;
-            }
-            HDR_TCP.seq_num = isInbound ? tcp_in_seq_num : tcp_out_seq_num;
-            HDR_TCP.window = g_htons(0x2000);
-            HDR_TCP.checksum = 0;
-            /* Note: g_ntohs()/g_htons() macro arg may be eval'd twice so calc value before invoking macro */
-            x16  = in_checksum(&pseudoh, sizeof(pseudoh));
-            u    = g_ntohs(x16);
-            x16  = in_checksum(&HDR_TCP, sizeof(HDR_TCP));
-            u   += g_ntohs(x16);
-            x16  = in_checksum(packet_buf + header_length, length - header_length);
-            u   += g_ntohs(x16);
-            x16  = (u & 0xffff) + (u>>16);
-            HDR_TCP.checksum = g_htons(x16);
-            if (HDR_TCP.checksum == 0) /* differentiate between 'none' and 0 */
-                HDR_TCP.checksum = g_htons(1);
-            write_bytes((const char *)&HDR_TCP, sizeof(HDR_TCP));
-            if (isInbound) {
-                tcp_in_seq_num = g_ntohl(tcp_in_seq_num) + length - header_length;
-                tcp_in_seq_num = g_htonl(tcp_in_seq_num);
-            }
-            else {
-                tcp_out_seq_num = g_ntohl(tcp_out_seq_num) + length - header_length;
-                tcp_out_seq_num = g_htonl(tcp_out_seq_num);
-            }
+        else {
+            tcp_hdr.flags = 0;
+            tcp_hdr.ack_num = 0;
         }
+        tcp_hdr.seq_num = job->tcp_seq_num;
+        tcp_hdr.window = g_htons(0x2000);
+        tcp_hdr.checksum = 0;
+        /* Note: g_ntohs()/g_htons() macro arg may be eval'd twice so calc value before invoking macro */
+        x16  = in_checksum(&pseudoh, sizeof(pseudoh));
+        u    = g_ntohs(x16);
+        x16  = in_checksum(&tcp_hdr, sizeof(tcp_hdr));
+        u   += g_ntohs(x16);
+        x16  = in_checksum(buf + header_length, length - header_length);
+        u   += g_ntohs(x16);
+        x16  = (u & 0xffff) + (u>>16);
+        tcp_hdr.checksum = g_htons(x16);
+        if (tcp_hdr.checksum == 0) /* differentiate between 'none' and 0 */
+            tcp_hdr.checksum = g_htons(1);
+        write_bytes(buf, &offset, &tcp_hdr, sizeof(tcp_hdr));
+    }
 
-        /* Compute DATA chunk header */
-        if (hdr_data_chunk) {
-            hdr_data_chunk_bits = 0;
-            if (packet_start == 0) {
-                hdr_data_chunk_bits |= 0x02;
-            }
-            if (!cont) {
-                hdr_data_chunk_bits |= 0x01;
-            }
-            HDR_DATA_CHUNK.type   = hdr_data_chunk_type;
-            HDR_DATA_CHUNK.bits   = hdr_data_chunk_bits;
-            HDR_DATA_CHUNK.length = g_htons(length - header_length + sizeof(HDR_DATA_CHUNK));
-            HDR_DATA_CHUNK.tsn    = g_htonl(hdr_data_chunk_tsn);
-            HDR_DATA_CHUNK.sid    = g_htons(hdr_data_chunk_sid);
-            HDR_DATA_CHUNK.ssn    = g_htons(hdr_data_chunk_ssn);
-            HDR_DATA_CHUNK.ppid   = g_htonl(hdr_data_chunk_ppid);
-            hdr_data_chunk_tsn++;
-            if (!cont) {
-                hdr_data_chunk_ssn++;
-            }
-        }
+    /* Compute DATA chunk header */
+    if (hdr_data_chunk) {
+        guint8 bits = 0;
 
-        /* Write SCTP common header */
-        if (hdr_sctp) {
-            guint32 zero = 0;
-
-            HDR_SCTP.src_port  = isInbound ? g_htons(hdr_sctp_dest): g_htons(hdr_sctp_src);
-            HDR_SCTP.dest_port = isInbound ? g_htons(hdr_sctp_src) : g_htons(hdr_sctp_dest);
-            HDR_SCTP.tag       = g_htonl(hdr_sctp_tag);
-            HDR_SCTP.checksum  = g_htonl(0);
-            HDR_SCTP.checksum  = crc32c((guint8 *)&HDR_SCTP, sizeof(HDR_SCTP), ~0);
-            if (hdr_data_chunk) {
-                HDR_SCTP.checksum  = crc32c((guint8 *)&HDR_DATA_CHUNK, sizeof(HDR_DATA_CHUNK), HDR_SCTP.checksum);
-                HDR_SCTP.checksum  = crc32c((guint8 *)packet_buf + header_length, length - header_length, HDR_SCTP.checksum);
-                HDR_SCTP.checksum  = crc32c((guint8 *)&zero, padding_length, HDR_SCTP.checksum);
-            } else {
-                HDR_SCTP.checksum  = crc32c((guint8 *)packet_buf + header_length, length - header_length, HDR_SCTP.checksum);
-            }
-            HDR_SCTP.checksum = finalize_crc32c(HDR_SCTP.checksum);
-            HDR_SCTP.checksum  = g_htonl(HDR_SCTP.checksum);
-            write_bytes((const char *)&HDR_SCTP, sizeof(HDR_SCTP));
+        if (job->first) {
+            bits |= 0x02;
+        }
+        if (!job->cont) {
+            bits |= 0x01;
         }
+        chunk_hdr.type   = hdr_data_chunk_type;
+        chunk_hdr.bits   = bits;
+        chunk_hdr.length = g_htons(length - header_length + sizeof(chunk_hdr));
+        chunk_hdr.tsn    = g_htonl(job->tsn);
+        chunk_hdr.sid    = g_htons(hdr_data_chunk_sid);
+        chunk_hdr.ssn    = g_htons(job->ssn);
+        chunk_hdr.ppid   = g_htonl(hdr_data_chunk_ppid);
+    }
 
-        /* Write DATA chunk header */
+    /* Write SCTP common header */
+    if (hdr_sctp) {
+        guint32 zero = 0;
+
+        sctp_hdr.src_port  = isInbound ? g_htons(hdr_sctp_dest): g_htons(hdr_sctp_src);
+        sctp_hdr.dest_port = isInbound ? g_htons(hdr_sctp_src) : g_htons(hdr_sctp_dest);
+        sctp_hdr.tag       = g_htonl(hdr_sctp_tag);
+        sctp_hdr.checksum  = g_htonl(0);
+        sctp_hdr.checksum  = crc32c_calculate_no_swap(&sctp_hdr, sizeof(sctp_hdr), ~0U);
         if (hdr_data_chunk) {
-            write_bytes((const char *)&HDR_DATA_CHUNK, sizeof(HDR_DATA_CHUNK));
+            sctp_hdr.checksum  = crc32c_calculate_no_swap(&chunk_hdr, sizeof(chunk_hdr), sctp_hdr.checksum);
+            sctp_hdr.checksum  = crc32c_calculate_no_swap(buf + header_length, length - header_length, sctp_hdr.checksum);
+            sctp_hdr.checksum  = crc32c_calculate_no_swap(&zero, padding_length, sctp_hdr.checksum);
+        } else {
+            sctp_hdr.checksum  = crc32c_calculate_no_swap(buf + header_length, length - header_length, sctp_hdr.checksum);
         }
+        sctp_hdr.checksum = finalize_crc32c(sctp_hdr.checksum);
+        sctp_hdr.checksum  = g_htonl(sctp_hdr.checksum);
+        write_bytes(buf, &offset, &sctp_hdr, sizeof(sctp_hdr));
+    }
 
-        /* Reset curr_offset, since we now write the trailers */
-        curr_offset = length;
+    /* Write DATA chunk header */
+    if (hdr_data_chunk) {
+        write_bytes(buf, &offset, &chunk_hdr, sizeof(chunk_hdr));
+    }
 
-        /* Write DATA chunk padding */
-        if (hdr_data_chunk && (padding_length > 0)) {
-            memset(tempbuf, 0, padding_length);
-            write_bytes((const char *)&tempbuf, padding_length);
-            length += padding_length;
-        }
+    /*
+     * The trailers are zeroes, and the space after the packet data
+     * was zeroed when the packet was queued.
+     */
+
+    /* Add DATA chunk padding */
+    if (hdr_data_chunk && (padding_length > 0)) {
+        length += padding_length;
+    }
+
+    /* Add Ethernet trailer */
+    if (hdr_ethernet && (length < 60)) {
+        length = 60;
+    }
+
+    job->length = length;
+}
+
+/* Without --threads, each packet is built in this job */
+static packet_job_t inline_job;
+static guint8       inline_job_buf[WTAP_MAX_PACKET_SIZE_STANDARD + PACKET_TRAILER_MAX_LEN];
+
+/*----------------------------------------------------------------------
+ * Queue the current packet to be built and written
+ *
+ * Everything that depends on the packets before this one is worked out
+ * here, in input order.  If job is NULL, the job and its buffer are
+ * allocated with a single g_malloc().
+ */
+static packet_job_t *
+new_packet_job (packet_job_t *job, gboolean cont)
+{
+    gboolean      isInbound;
+
+    /* Is direction indication on with an inbound packet? */
+    isInbound = has_direction && (direction == 2);
+
+    if (job == NULL) {
+        job = (packet_job_t *)g_malloc(sizeof(packet_job_t) + curr_offset + PACKET_TRAILER_MAX_LEN);
+        job->buf = (guint8 *)(job + 1);
+    }
+    memcpy(job->buf + header_length, packet_buf + header_length, curr_offset - header_length);
+    memset(job->buf + curr_offset, 0, PACKET_TRAILER_MAX_LEN);
+    job->length     = curr_offset;
+    job->cont       = cont;
+    job->first      = (packet_start == 0);
+    job->is_inbound = isInbound;
+    job->ts_sec     = ts_sec;
+    job->ts_nsec    = ts_nsec;
+    job->direction  = direction;
+    job->done       = FALSE;
+
+    /* The IPv6 addresses are kept from one packet to the next */
+    if (hdr_ipv6) {
+        if (memcmp(isInbound ? &hdr_ipv6_dest_addr : &hdr_ipv6_src_addr, &NO_IPv6_ADDRESS, sizeof(ws_in6_addr)))
+            memcpy(&HDR_IPv6.ip6_src, isInbound ? &hdr_ipv6_dest_addr : &hdr_ipv6_src_addr, sizeof(ws_in6_addr));
+        if (memcmp(isInbound ? &hdr_ipv6_src_addr : &hdr_ipv6_dest_addr, &NO_IPv6_ADDRESS, sizeof(ws_in6_addr)))
+            memcpy(&HDR_IPv6.ip6_dst, isInbound ? &hdr_ipv6_src_addr : &hdr_ipv6_dest_addr, sizeof(ws_in6_addr));
+        job->ip6_src = HDR_IPv6.ip6_src;
+        job->ip6_dst = HDR_IPv6.ip6_dst;
+    }
 
-        /* Write Ethernet trailer */
-        if (hdr_ethernet && (length < 60)) {
-            memset(tempbuf, 0, 60 - length);
-            write_bytes((const char *)&tempbuf, 60 - length);
-            length = 60;
+    if (hdr_tcp) {
+        job->tcp_seq_num = isInbound ? tcp_in_seq_num : tcp_out_seq_num;
+        job->tcp_ack_num = isInbound ? tcp_out_seq_num : tcp_in_seq_num;
+        if (isInbound) {
+            tcp_in_seq_num = g_ntohl(tcp_in_seq_num) + curr_offset - header_length;
+            tcp_in_seq_num = g_htonl(tcp_in_seq_num);
         }
-        if (use_pcapng) {
-            success = pcapng_write_enhanced_packet_block(output_file,
-                                                         NULL,
-                                                         ts_sec, ts_nsec,
-                                                         length, length,
-                                                         0,
-                                                         1000000000,
-                                                         packet_buf, direction,
-                                                         &bytes_written, &err);
-        } else {
-            success = libpcap_write_packet(output_file,
-                                           ts_sec, ts_nsec/1000,
-                                           length, length,
-                                           packet_buf,
-                                           &bytes_written, &err);
+        else {
+            tcp_out_seq_num = g_ntohl(tcp_out_seq_num) + curr_offset - header_length;
+            tcp_out_seq_num = g_htonl(tcp_out_seq_num);
         }
-        if (!success) {
-            fprintf(stderr, "File write error [%s] : %s\n",
-                    output_filename, g_strerror(err));
-            return EXIT_FAILURE;
+    }
+
+    if (hdr_data_chunk) {
+        job->tsn = hdr_data_chunk_tsn;
+        job->ssn = hdr_data_chunk_ssn;
+        hdr_data_chunk_tsn++;
+        if (!cont) {
+            hdr_data_chunk_ssn++;
         }
-        if (ts_fmt == NULL) {
-            /* fake packet counter */
-            if (use_pcapng)
-                ts_nsec++;
-            else
-                ts_nsec += 1000;
+    }
+
+    if (ts_fmt == NULL) {
+        /* fake packet counter */
+        if (use_pcapng)
+            ts_nsec++;
+        else
+            ts_nsec += 1000;
+    }
+
+    return job;
+}
+
+static void
+free_packet_job (packet_job_t *job)
+{
+    g_free(job);
+}
+
+/*----------------------------------------------------------------------
+ * Write a packet that has been built to the output file
+ */
+static int
+write_packet (packet_job_t *job)
+{
+    int      err;
+    gboolean success;
+
+    if (use_pcapng) {
+        success = pcapng_write_enhanced_packet_block(output_file,
+                                                     NULL,
+                                                     job->ts_sec, job->ts_nsec,
+                                                     job->length, job->length,
+                                                     0,
+                                                     1000000000,
+                                                     job->buf, job->direction,
+                                                     &bytes_written, &err);
+    } else {
+        success = libpcap_write_packet(output_file,
+                                       job->ts_sec, job->ts_nsec/1000,
+                                       job->length, job->length,
+                                       job->buf,
+                                       &bytes_written, &err);
+    }
+    if (!success) {
+        fprintf(stderr, "File write error [%s] : %s\n",
+                output_filename, g_strerror(err));
+        return EXIT_FAILURE;
+    }
+    if (!quiet) {
+        fprintf(stderr, "Wrote packet of %u bytes.\n", job->length);
+    }
+    num_packets_written++;
+    return EXIT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+ * Build a queued packet on a worker thread
+ */
+static void
+build_packet_job (gpointer data, gpointer user_data _U_)
+{
+    packet_job_t *job = (packet_job_t *)data;
+
+    build_packet(job);
+
+    /* write_pending_packets() only ever waits for the oldest job */
+    g_mutex_lock(&pending_jobs_mutex);
+    job->done = TRUE;
+    if (g_queue_peek_head(&pending_jobs) == job)
+        g_cond_signal(&pending_jobs_cond);
+    g_mutex_unlock(&pending_jobs_mutex);
+}
+
+/*----------------------------------------------------------------------
+ * Write out the queued packets that have been built, in the order in
+ * which they were read, waiting for them to be built until no more than
+ * max_pending are left in the queue
+ */
+static int
+write_pending_packets (guint max_pending)
+{
+    packet_job_t *job;
+    int           ret = EXIT_SUCCESS;
+
+    g_mutex_lock(&pending_jobs_mutex);
+    while ((job = (packet_job_t *)g_queue_peek_head(&pending_jobs)) != NULL) {
+        if (!job->done) {
+            if (g_queue_get_length(&pending_jobs) <= max_pending)
+                break;
+            g_cond_wait(&pending_jobs_cond, &pending_jobs_mutex);
+            continue;
         }
-        if (!quiet) {
-            fprintf(stderr, "Wrote packet of %u bytes.\n", length);
+        g_queue_pop_head(&pending_jobs);
+        g_mutex_unlock(&pending_jobs_mutex);
+
+        ret = write_packet(job);
+        free_packet_job(job);
+
+        g_mutex_lock(&pending_jobs_mutex);
+        if (ret != EXIT_SUCCESS)
+            break;
+    }
+    g_mutex_unlock(&pending_jobs_mutex);
+    return ret;
+}
+
+/*----------------------------------------------------------------------
+ * Write current packet out
+ */
+static int
+write_current_packet (gboolean cont)
+{
+    packet_job_t *job;
+    int           ret;
+
+    if (curr_offset > header_length) {
+        /* Write the packet */
+        if (build_pool == NULL) {
+            inline_job.buf = inline_job_buf;
+            job = new_packet_job(&inline_job, cont);
+            build_packet(job);
+            ret = write_packet(job);
+            if (ret != EXIT_SUCCESS)
+                return EXIT_FAILURE;
+        } else {
+            job = new_packet_job(NULL, cont);
+            g_mutex_lock(&pending_jobs_mutex);
+            g_queue_push_tail(&pending_jobs, job);
+            g_mutex_unlock(&pending_jobs_mutex);
+            g_thread_pool_push(build_pool, job, NULL);
+            if (write_pending_packets(MAX_PENDING_JOBS) != EXIT_SUCCESS)
+                return EXIT_FAILURE;
         }
-        num_packets_written++;
     }
 
     packet_start += curr_offset - header_length;
@@ -1355,6 +1465,179 @@ fail_null_str:
     return EXIT_FAILURE;
 }
 
+/*----------------------------------------------------------------------
+ * Would the parser take this offset, at the start of a line, as the
+ * start of a line of packet bytes?  This follows the T_OFFSET cases of
+ * the INIT and START_OF_LINE states in parse_token().
+ */
+static gboolean
+offset_starts_bytes (guint32 num)
+{
+    switch (state) {
+    case INIT:
+        return num == 0;
+    case START_OF_LINE:
+        return (num == 0) || ((num - packet_start) == curr_offset - header_length) ||
+            (num < curr_offset);
+    default:
+        return FALSE;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Hand the tokens of a line in the usual hex dump layout
+ *
+ *   <hex offset> <hex byte> <hex byte> ... [<ASCII dump>]
+ *
+ * straight to the parser, without the scanner.  The tokens are the ones
+ * the scanner would produce, except that everything after the last byte
+ * is handed over as a single T_TEXT token; the parser ignores the rest
+ * of the line after the first token that isn't a byte anyway.
+ *
+ * Returns FALSE, without having done anything, if the line has any other
+ * layout, or if the parser wouldn't take the offset as the start of a
+ * line of bytes; the line must then be scanned.  Otherwise returns TRUE,
+ * with the result of parse_token() in *ret.
+ *
+ * The line must end with '\n'.
+ */
+static gboolean
+parse_hex_line (char *line, int *ret)
+{
+    char    *p = line;
+    int      num_digits;
+
+    while (g_ascii_isxdigit(*p))
+        p++;
+    num_digits = (int)(p - line);
+    if (num_digits == 0)
+        return FALSE;
+    if (*p == ':') {
+        /* "0010:00" would be scanned as text */
+        if (p[1] != ' ' && p[1] != '\t')
+            return FALSE;
+    } else if (*p == ' ' || *p == '\t') {
+        /* "00 " would be scanned as a byte */
+        if (num_digits == 2)
+            return FALSE;
+    } else {
+        return FALSE;
+    }
+    if (!offset_starts_bytes((guint32)strtoul(line, NULL, 16)))
+        return FALSE;
+
+    if ((*ret = parse_token(T_OFFSET, line)) != EXIT_SUCCESS)
+        return TRUE;
+    p++;
+
+    for (;;) {
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (g_ascii_isxdigit(p[0]) && g_ascii_isxdigit(p[1])) {
+            if (p[2] == ' ' || p[2] == '\t') {
+                if ((*ret = parse_token(T_BYTE, p)) != EXIT_SUCCESS)
+                    return TRUE;
+                p += 3;
+                continue;
+            }
+            if (p[2] == '\n' || (p[2] == '\r' && p[3] == '\n')) {
+                *ret = parse_token(T_BYTE, p);
+                break;
+            }
+        }
+        if (*p != '\n' && !(p[0] == '\r' && p[1] == '\n'))
+            *ret = parse_token(T_TEXT, p);
+        break;
+    }
+    if (*ret == EXIT_SUCCESS)
+        *ret = parse_token(T_EOL, NULL);
+    return TRUE;
+}
+
+/* Bytes of input read at a time */
+#define INPUT_READ_SIZE     (64 * 1024)
+
+/*----------------------------------------------------------------------
+ * Read the input a line at a time, and parse each line with
+ * parse_hex_line(), or, if that can't handle it, with the scanner
+ */
+static int
+scan_input (FILE *fp)
+{
+    char     *buf;
+    size_t    buf_size = 16 * INPUT_READ_SIZE;
+    size_t    start = 0;    /* buf[start..end) hasn't been parsed yet */
+    size_t    end = 0;
+    gboolean  eof = FALSE;
+    int       ret = EXIT_SUCCESS;
+
+    /*
+     * parse_hex_line() only knows about hex offsets, and it doesn't
+     * print the tokens the way the scanner does in debug mode.
+     */
+    if (offset_base != 16 || debug >= 2) {
+        text2pcap_in = fp;
+        return text2pcap_scan();
+    }
+
+    buf = (char *)g_malloc(buf_size + 1);
+    while (ret == EXIT_SUCCESS) {
+        char   *line = buf + start;
+        char   *first_nl;
+        char   *nl;
+        char    saved;
+        size_t  nread;
+
+        /*
+         * The scanner takes a '\r' after a '\n' as part of that line,
+         * and might join it to the text on the next line, so those
+         * lines are scanned together.
+         */
+        first_nl = (char *)memchr(line, '\n', end - start);
+        nl = first_nl;
+        while (nl != NULL && nl + 1 < buf + end && nl[1] == '\r')
+            nl = (char *)memchr(nl + 1, '\n', buf + end - (nl + 1));
+
+        if (nl != NULL && (nl + 1 < buf + end || eof)) {
+            /* buf has room for a '\0' after the last byte */
+            saved = nl[1];
+            nl[1] = '\0';
+            if (nl != first_nl || !parse_hex_line(line, &ret))
+                ret = text2pcap_scan_line(line, (int)(nl + 1 - line));
+            nl[1] = saved;
+            start += nl + 1 - line;
+            continue;
+        }
+        if (eof) {
+            /* The last line has no line end */
+            if (end > start)
+                ret = text2pcap_scan_line(line, (int)(end - start));
+            break;
+        }
+
+        /* Keep the start of the line, and read more */
+        memmove(buf, line, end - start);
+        end -= start;
+        start = 0;
+        if (buf_size - end < INPUT_READ_SIZE) {
+            buf_size *= 2;
+            buf = (char *)g_realloc(buf, buf_size + 1);
+        }
+        nread = fread(buf + end, 1, INPUT_READ_SIZE, fp);
+        if (nread == 0) {
+            if (ferror(fp)) {
+                fprintf(stderr, "Error reading %s: %s\n", input_filename, g_strerror(errno));
+                ret = EXIT_FAILURE;
+            }
+            eof = TRUE;
+        }
+        end += nread;
+    }
+    text2pcap_scan_end();
+    g_free(buf);
+    return ret;
+}
+
 /*----------------------------------------------------------------------
  * Print usage string and exit
  */
@@ -1438,6 +1721,8 @@ print_usage (FILE *output)
             "  -d                     show detailed debug of parser states.\n"
             "  -q                     generate no output at all (automatically disables -d).\n"
             "  -n                     use pcapng instead of pcap as output format.\n"
+            "  --threads <threads>    build packet headers and checksums on <threads>\n"
+            "                         worker threads; default is 1 (no worker threads).\n"
             "",
             WTAP_MAX_PACKET_SIZE_STANDARD);
 }
@@ -1455,6 +1740,7 @@ parse_options (int argc, char *argv[])
     static const struct option long_options[] = {
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'v'},
+        {"threads", required_argument, NULL, LONGOPT_THREADS},
         {0, 0, 0, 0 }
     };
     struct tm *now_tm;
@@ -1496,6 +1782,14 @@ parse_options (int argc, char *argv[])
         case 'q': quiet = TRUE; debug = FALSE; break;
         case 'l': pcap_link_type = (guint32)strtol(optarg, NULL, 0); break;
         case 'm': max_offset = (guint32)strtol(optarg, NULL, 0); break;
+        case LONGOPT_THREADS:
+            num_threads = (guint)strtol(optarg, &p, 10);
+            if (p == optarg || *p != '\0' || num_threads < 1 || num_threads > 256) {
+                fprintf(stderr, "Bad argument for '--threads': %s\n", optarg);
+                print_usage(stderr);
+                return EXIT_FAILURE;
+            }
+            break;
         case 'n': use_pcapng = TRUE; break;
         case 'o':
             if (optarg[0] != 'h' && optarg[0] != 'o' && optarg[0] != 'd') {
@@ -1907,13 +2201,34 @@ main(int argc, char *argv[])
     }
     curr_offset = header_length;
 
-    text2pcap_in = input_file;
-    if (text2pcap_scan() == EXIT_SUCCESS) {
+    /* if defined IPv6 we should rewrite hdr_ethernet_proto anyways */
+    if (hdr_ipv6) {
+        hdr_ethernet_proto = 0x86DD;
+        hdr_ip = FALSE;
+    }
+
+    if (num_threads > 1) {
+        build_pool = g_thread_pool_new(build_packet_job, NULL, num_threads,
+                                       TRUE, NULL);
+    }
+
+    if (scan_input(input_file) == EXIT_SUCCESS) {
         if (write_current_packet(FALSE) != EXIT_SUCCESS)
             ret = EXIT_FAILURE;
+        else if (write_pending_packets(0) != EXIT_SUCCESS)
+            ret = EXIT_FAILURE;
     } else {
         ret = EXIT_FAILURE;
     }
+    if (build_pool != NULL) {
+        packet_job_t *job;
+
+        /* Let the workers finish, and discard anything left unwritten */
+        g_thread_pool_free(build_pool, FALSE, TRUE);
+        build_pool = NULL;
+        while ((job = (packet_job_t *)g_queue_pop_head(&pending_jobs)) != NULL)
+            free_packet_job(job);
+    }
     if (debug)
         fprintf(stderr, "\n-------------------------\n");
     if (!quiet) {
@@ -28,6 +28,10 @@ typedef enum {
 int parse_token(token_t token, char *str);
 
 int text2pcap_scan(void);
+/* Scan len bytes of input, which end at the end of a line (or of the input) */
+int text2pcap_scan_line(const char *line, int len);
+/* Free the scanner after calls to text2pcap_scan_line() */
+void text2pcap_scan_end(void);
 
 #endif
 
@@ -55,6 +55,7 @@
 #include <version_info.h>
 #include <wiretap/wtap_opttypes.h>
 #include <wiretap/pcapng.h>
+#include <wiretap/wtap_index.h>
 
 #include "globals.h"
 #include <epan/timestamp.h>
@@ -144,6 +145,7 @@
 #ifdef HAVE_JSONGLIB
 #define LONGOPT_ELASTIC_MAPPING_FILTER (65536+1002)
 #endif
+#define LONGOPT_READ_AHEAD (65536+1003)
 
 #if 0
 #define tshark_debug(...) g_warning(__VA_ARGS__)
@@ -194,6 +196,7 @@ static gchar **protocolfilter = NULL;
 static pf_flags protocolfilter_flags = PF_NONE;
 
 static gboolean no_duplicate_keys = FALSE;
+static guint32 read_ahead_mb = 0;
 static proto_node_children_grouper_func node_children_grouper = proto_node_group_children_by_unique;
 
 /* The line separator used between packets, changeable via the -S option */
@@ -444,6 +447,8 @@ print_usage(FILE *output)
   fprintf(output, "  --elastic-mapping-filter <protocols> If -G elastic-mapping is specified, put only the\n");
   fprintf(output, "                           specified protocols within the mapping file\n");
 #endif
+  fprintf(output, "  --read-ahead <MB>        read the capture file ahead in the background, using\n");
+  fprintf(output, "                           buffers totalling <MB> megabytes\n");
 
   fprintf(output, "\n");
   fprintf(output, "Miscellaneous:\n");
@@ -687,6 +692,7 @@ main(int argc, char *argv[])
 #ifdef HAVE_JSONGLIB
     {"elastic-mapping-filter", required_argument, NULL, LONGOPT_ELASTIC_MAPPING_FILTER},
 #endif
+    {"read-ahead", required_argument, NULL, LONGOPT_READ_AHEAD},
     {0, 0, 0, 0 }
   };
   gboolean             arg_error = FALSE;
@@ -1467,6 +1473,9 @@ main(int argc, char *argv[])
       no_duplicate_keys = TRUE;
       node_children_grouper = proto_node_group_children_by_json_key;
       break;
+    case LONGOPT_READ_AHEAD: /* read the capture file ahead in the background */
+      read_ahead_mb = get_nonzero_guint32(optarg, "read-ahead buffer size");
+      break;
     default:
     case '?':        /* Bad flag - print usage message */
       switch(optopt) {
@@ -2030,6 +2039,9 @@ main(int argc, char *argv[])
       goto clean_exit;
     }
 
+    if (read_ahead_mb != 0)
+      wtap_set_read_ahead(cfile.provider.wth, read_ahead_mb);
+
     /* Start statistics taps; we do so after successfully opening the
        capture file, so we know we have something to compute stats
        on, and after registering all dissectors, so that MATE will
@@ -2970,6 +2982,35 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
   return passed;
 }
 
+/*
+ * Do the first pass over the packets from a packet index rather than
+ * from the file.  The index has everything frame_data_init() needs,
+ * but not the packet data, so this can only be done if we're not
+ * dissecting on the first pass.
+ */
+static void
+process_index_first_pass(capture_file *cf, wtap_index_t *pkt_index,
+                         int max_packet_count, gint64 max_byte_count)
+{
+  wtap_rec rec;
+  guint32  i;
+  gint64   data_offset;
+
+  wtap_rec_init(&rec);
+  for (i = 0; i < wtap_index_get_num_records(pkt_index); i++) {
+    data_offset = wtap_index_get_rec(pkt_index, i, &rec);
+    if (process_packet_first_pass(cf, NULL, data_offset, &rec, NULL)) {
+      if (wtap_index_get_entry(pkt_index, i)->flags & WTAP_INDEX_ENTRY_HAS_COMMENT)
+        cf->provider.prev_cap->flags.has_phdr_comment = 1;
+
+      /* Same limits as when reading the file. */
+      if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count))
+        break;
+    }
+  }
+  wtap_rec_cleanup(&rec);
+}
+
 static gboolean
 process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
                            frame_data *fdata, wtap_rec *rec,
@@ -3078,6 +3119,9 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
   Buffer       buf;
   epan_dissect_t *edt = NULL;
   char                        *shb_user_appl;
+  wtap_index_t        *pkt_index = NULL;
+  wtap_index_writer_t *index_writer = NULL;
+  gboolean             read_all = TRUE;
 
   wtap_rec_init(&rec);
 
@@ -3194,24 +3238,55 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
       edt = epan_dissect_new(cf->epan, create_proto_tree, FALSE);
     }
 
-    tshark_debug("tshark: reading records for first pass");
-    while (wtap_read(cf->provider.wth, &err, &err_info, &data_offset)) {
-      if (process_packet_first_pass(cf, edt, data_offset, wtap_get_rec(cf->provider.wth),
-                                    wtap_get_buf_ptr(cf->provider.wth))) {
-        /* Stop reading if we have the maximum number of packets;
-         * When the -c option has not been used, max_packet_count
-         * starts at 0, which practically means, never stop reading.
-         * (unless we roll over max_packet_count ?)
-         */
-        if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
-          tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
-                        max_packet_count, data_offset, max_byte_count);
-          err = 0; /* This is not an error */
-          break;
+    /*
+     * If we're not dissecting on the first pass, all it does is find the
+     * packets, and an up-to-date packet index can tell us where they are
+     * without our reading the file.  Otherwise, write an index as we
+     * read, for the next time.
+     */
+    if (prefs.capture_packet_index) {
+      if (edt == NULL)
+        pkt_index = wtap_index_open(cf->provider.wth, cf->filename);
+      if (pkt_index == NULL)
+        index_writer = wtap_index_writer_new(cf->provider.wth, cf->filename);
+    }
+
+    if (pkt_index != NULL) {
+      tshark_debug("tshark: getting records for first pass from packet index");
+      process_index_first_pass(cf, pkt_index, max_packet_count, max_byte_count);
+      wtap_index_close(pkt_index);
+      pkt_index = NULL;
+    } else {
+      tshark_debug("tshark: reading records for first pass");
+      while (wtap_read(cf->provider.wth, &err, &err_info, &data_offset)) {
+        if (index_writer != NULL)
+          wtap_index_writer_add(index_writer, cf->provider.wth, data_offset);
+        if (process_packet_first_pass(cf, edt, data_offset, wtap_get_rec(cf->provider.wth),
+                                      wtap_get_buf_ptr(cf->provider.wth))) {
+          /* Stop reading if we have the maximum number of packets;
+           * When the -c option has not been used, max_packet_count
+           * starts at 0, which practically means, never stop reading.
+           * (unless we roll over max_packet_count ?)
+           */
+          if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
+            tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
+                          max_packet_count, data_offset, max_byte_count);
+            err = 0; /* This is not an error */
+            read_all = FALSE;
+            break;
+          }
         }
       }
     }
 
+    if (index_writer != NULL) {
+      if (err == 0 && read_all)
+        wtap_index_writer_finish(index_writer);
+      else
+        wtap_index_writer_abort(index_writer);
+      index_writer = NULL;
+    }
+
     /*
      * If we got a read error on the first pass, remember the error, so
      * but do the second pass, so we can at least process the packets we
@@ -3475,6 +3550,19 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
   }
 
 out:
+  if (read_ahead_mb != 0 && !really_quiet) {
+    gint64 stall_usecs;
+    guint stalls;
+
+    /*
+     * Report how often, and for how long, we had to wait for the
+     * read-ahead to catch up, so the buffer size can be tuned.
+     */
+    wtap_get_read_stalls(cf->provider.wth, &stall_usecs, &stalls);
+    fprintf(stderr, "Read-ahead: %u stall%s, %.3f seconds waiting for data\n",
+            stalls, plurality(stalls, "", "s"), (double)stall_usecs / 1000000.0);
+  }
+
   wtap_close(cf->provider.wth);
   cf->provider.wth = NULL;
 
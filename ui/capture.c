@@ -122,6 +122,7 @@ capture_start(capture_options *capture_opts, capture_session *cap_session, info_
 
     cap_session->state = CAPTURE_PREPARING;
     cap_session->count = 0;
+    cap_session->count_pending = 0;
     g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Start ...");
     source = get_iface_list_string(capture_opts, IFLIST_SHOW_FILTER);
     cf_set_tempfile_source((capture_file *)cap_session->cf, source->str);
@@ -424,6 +425,7 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
             if(capture_opts->real_time_mode) {
                 capture_callback_invoke(capture_cb_capture_update_finished, cap_session);
                 cf_finish_tail((capture_file *)cap_session->cf, &err);
+                cap_session->count_pending = 0;
                 cf_close((capture_file *)cap_session->cf);
             } else {
                 capture_callback_invoke(capture_cb_capture_fixed_finished, cap_session);
@@ -494,8 +496,12 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
     g_assert(capture_opts->save_file);
 
     if(capture_opts->real_time_mode) {
-        /* Read from the capture file the number of records the child told us it added. */
-        switch (cf_continue_tail((capture_file *)cap_session->cf, to_read, &err)) {
+        /* Read from the capture file the number of records the child told us it added,
+           along with any we didn't get to last time. cf_continue_tail might not read
+           all of them; the GUI should call us again (with to_read 0) while
+           cap_session->count_pending is non-zero. */
+        cap_session->count_pending += to_read;
+        switch (cf_continue_tail((capture_file *)cap_session->cf, &cap_session->count_pending, &err)) {
 
             case CF_READ_OK:
             case CF_READ_ERROR:
@@ -519,7 +525,7 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
         capture_callback_invoke(capture_cb_capture_fixed_continue, cap_session);
     }
 
-    if(capture_opts->show_info)
+    if(capture_opts->show_info && to_read > 0)
         capture_info_new_packets(to_read, cap_session->cap_data_info);
 }
 
@@ -655,6 +661,7 @@ capture_input_closed(capture_session *cap_session, gchar *msg)
 
             /* Read what remains of the capture file. */
             status = cf_finish_tail((capture_file *)cap_session->cf, &err);
+            cap_session->count_pending = 0;
 
             /* Tell the GUI we are not doing a capture any more.
                Must be done after the cf_finish_tail(), so file lengths are
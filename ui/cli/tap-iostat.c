@@ -1381,6 +1381,10 @@ register_io_tap(io_stat_t *io, int i, const char *filter)
         g_string_free(error_string, TRUE);
         exit(1);
     }
+    if (hfi) {
+        /* Make sure the field is in the tree even if it's not in the filter */
+        set_tap_interesting_hfids(&io->items[i], &io->items[i].hf_index, 1);
+    }
 }
 
 static void
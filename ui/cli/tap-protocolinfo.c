@@ -115,6 +115,8 @@ protocolinfo_init(const char *opt_arg, void *userdata _U_)
 
 		exit(1);
 	}
+	/* The field need not be in the filter to be in the tree */
+	set_tap_interesting_hfids(rs, &rs->hf_index, 1);
 }
 
 static stat_tap_ui protocolinfo_ui = {
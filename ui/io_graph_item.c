@@ -275,6 +275,89 @@ double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val
     return value;
 }
 
+/* Add the values of src to dst. */
+static void
+merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, io_graph_item_unit_t item_unit)
+{
+    gboolean first = (dst->fields == 0);
+
+    if (src->first_frame_in_invl != 0 &&
+        (dst->first_frame_in_invl == 0 || src->first_frame_in_invl < dst->first_frame_in_invl)) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl > dst->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    /* Only one of the int, float, double and time values is in use, the
+     * others are zero, so we can simply merge all of them. */
+    if (src->fields != 0) {
+        if (first || src->int_max > dst->int_max || src->float_max > dst->float_max ||
+            src->double_max > dst->double_max || nstime_cmp(&src->time_max, &dst->time_max) > 0) {
+            if (item_unit == IOG_ITEM_UNIT_CALC_MAX) {
+                dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+            }
+        }
+        if (first || src->int_min < dst->int_min || src->float_min < dst->float_min ||
+            src->double_min < dst->double_min || nstime_cmp(&src->time_min, &dst->time_min) < 0) {
+            if (item_unit == IOG_ITEM_UNIT_CALC_MIN) {
+                dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+            }
+        }
+        if (first) {
+            dst->int_max = src->int_max;
+            dst->int_min = src->int_min;
+            dst->float_max = src->float_max;
+            dst->float_min = src->float_min;
+            dst->double_max = src->double_max;
+            dst->double_min = src->double_min;
+            dst->time_max = src->time_max;
+            dst->time_min = src->time_min;
+        } else {
+            dst->int_max = MAX(dst->int_max, src->int_max);
+            dst->int_min = MIN(dst->int_min, src->int_min);
+            dst->float_max = MAX(dst->float_max, src->float_max);
+            dst->float_min = MIN(dst->float_min, src->float_min);
+            dst->double_max = MAX(dst->double_max, src->double_max);
+            dst->double_min = MIN(dst->double_min, src->double_min);
+            if (nstime_cmp(&src->time_max, &dst->time_max) > 0) {
+                dst->time_max = src->time_max;
+            }
+            if (nstime_cmp(&src->time_min, &dst->time_min) < 0) {
+                dst->time_min = src->time_min;
+            }
+        }
+    }
+
+    dst->frames += src->frames;
+    dst->bytes += src->bytes;
+    dst->fields += src->fields;
+    dst->int_tot += src->int_tot;
+    dst->float_tot += src->float_tot;
+    dst->double_tot += src->double_tot;
+    /* For LOAD this sums the time spent in each of the finer intervals. */
+    nstime_add(&dst->time_tot, &src->time_tot);
+}
+
+int rollup_io_graph_items(io_graph_item_t *dst_items, const io_graph_item_t *src_items, int src_count, int factor, io_graph_item_unit_t item_unit)
+{
+    int dst_count;
+    int i;
+
+    if (src_count <= 0 || factor <= 0) {
+        return 0;
+    }
+
+    dst_count = (src_count - 1) / factor + 1;
+    reset_io_graph_items(dst_items, dst_count);
+
+    for (i = 0; i < src_count; i++) {
+        merge_io_graph_item(&dst_items[i / factor], &src_items[i], item_unit);
+    }
+
+    return dst_count;
+}
+
 /*
  * Editor modelines
  *
@@ -126,6 +126,22 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
  */
 double get_io_graph_item(const io_graph_item_t *items, io_graph_item_unit_t val_units, int idx, int hf_index, const capture_file *cap_file, int interval, int cur_idx);
 
+/** Roll up items at one interval into items at a coarser interval.
+ *
+ * Interval i of the source is added to interval i / factor of the
+ * destination, so that the destination has the same values as if the
+ * packets had been tapped at the coarser interval.
+ *
+ * @param dst_items [out] Array for the coarser items. Must have room for
+ *                        src_count / factor + 1 items.
+ * @param src_items [in] Array containing the finer items.
+ * @param src_count [in] The number of items in src_items.
+ * @param factor [in] Ratio of the coarser to the finer interval.
+ * @param item_unit [in] The type of unit calculated. From IOG_ITEM_UNITS.
+ * @return The number of items in dst_items.
+ */
+int rollup_io_graph_items(io_graph_item_t *dst_items, const io_graph_item_t *src_items, int src_count, int factor, io_graph_item_unit_t item_unit);
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
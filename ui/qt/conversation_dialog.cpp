@@ -677,6 +677,7 @@ void ConversationTreeWidget::tapReset(void *conv_hash_ptr)
     if (!conv_tree) return;
 
     conv_tree->clear();
+    conv_tree->conv_items_.clear();
     reset_conversation_table_data(&conv_tree->hash_);
     conv_tree->min_rel_start_time_ = 0;
     conv_tree->max_rel_stop_time_ = 0;
@@ -736,18 +737,17 @@ void ConversationTreeWidget::updateItems() {
         return;
     }
 
-    setSortingEnabled(false);
+    if (conv_items_.isEmpty() && hash_.conv_array->len > 0) {
+        conv_item_t *conv_item = &g_array_index(hash_.conv_array, conv_item_t, 0);
+        min_rel_start_time_ = nstime_to_sec(&conv_item->start_time);
+        max_rel_stop_time_ = nstime_to_sec(&conv_item->stop_time);
+    }
 
-    QList<QTreeWidgetItem *>new_items;
-    for (int i = topLevelItemCount(); i < (int) hash_.conv_array->len; i++) {
+    QList<TrafficTableTreeWidgetItem *>new_items;
+    for (int i = conv_items_.size(); i < (int) hash_.conv_array->len; i++) {
         ConversationTreeWidgetItem *ctwi = new ConversationTreeWidgetItem(hash_.conv_array, i, &resolve_names_);
         new_items << ctwi;
 
-        if (i == 0) {
-            min_rel_start_time_ = nstime_to_sec(&(ctwi->convItem()->start_time));
-            max_rel_stop_time_ = nstime_to_sec(&(ctwi->convItem()->stop_time));
-        }
-
         for (int col = 0; col < columnCount(); col++) {
             switch (col) {
             case CONV_COLUMN_SRC_ADDR:
@@ -759,25 +759,25 @@ void ConversationTreeWidget::updateItems() {
             }
         }
     }
-    addTopLevelItems(new_items);
 
-    for (int i = 0; i < topLevelItemCount(); i++) {
-        ConversationTreeWidgetItem *ctwi = dynamic_cast<ConversationTreeWidgetItem *>(topLevelItem(i));
+    // Only conversations added or updated since the last draw can move
+    // the timeline bounds.
+    for (guint i = 0; hash_.changed_idx && i < hash_.changed_idx->len; i++) {
+        conv_item_t *conv_item = &g_array_index(hash_.conv_array, conv_item_t, g_array_index(hash_.changed_idx, guint, i));
 
-        if (ctwi) {
-            double item_rel_start = nstime_to_sec(&(ctwi->convItem()->start_time));
-            if (item_rel_start < min_rel_start_time_) {
-                min_rel_start_time_ = item_rel_start;
-            }
+        double item_rel_start = nstime_to_sec(&conv_item->start_time);
+        if (item_rel_start < min_rel_start_time_) {
+            min_rel_start_time_ = item_rel_start;
+        }
 
-            double item_rel_stop = nstime_to_sec(&(ctwi->convItem()->stop_time));
-            if (item_rel_stop > max_rel_stop_time_) {
-                max_rel_stop_time_ = item_rel_stop;
-            }
+        double item_rel_stop = nstime_to_sec(&conv_item->stop_time);
+        if (item_rel_stop > max_rel_stop_time_) {
+            max_rel_stop_time_ = item_rel_stop;
         }
     }
 
-    setSortingEnabled(true);
+    mergeItems(new_items);
+    conversation_table_clear_changes(&hash_);
 
     if (resize) {
         for (int col = 0; col < columnCount(); col++) {
@@ -432,6 +432,7 @@ void EndpointTreeWidget::tapReset(void *conv_hash_ptr)
     if (!endp_tree) return;
 
     endp_tree->clear();
+    endp_tree->conv_items_.clear();
     reset_hostlist_table_data(&endp_tree->hash_);
 }
 
@@ -458,10 +459,8 @@ void EndpointTreeWidget::updateItems()
         return;
     }
 
-    setSortingEnabled(false);
-
-    QList<QTreeWidgetItem *>new_items;
-    for (int i = topLevelItemCount(); i < (int) hash_.conv_array->len; i++) {
+    QList<TrafficTableTreeWidgetItem *>new_items;
+    for (int i = conv_items_.size(); i < (int) hash_.conv_array->len; i++) {
         EndpointTreeWidgetItem *etwi = new EndpointTreeWidgetItem(hash_.conv_array, i, &resolve_names_);
         new_items << etwi;
 
@@ -471,8 +470,8 @@ void EndpointTreeWidget::updateItems()
             }
         }
     }
-    addTopLevelItems(new_items);
-    setSortingEnabled(true);
+    mergeItems(new_items);
+    hostlist_table_clear_changes(&hash_);
 
     if (resize) {
         for (int col = 0; col < columnCount(); col++) {
@@ -39,7 +39,8 @@
 
 #include "ui/qt/widgets/wireshark_file_dialog.h"
 
-#include <QElapsedTimer>
+#include <algorithm>
+
 #include <QKeyEvent>
 #include <QMessageBox>
 #include <QPrintDialog>
@@ -47,6 +48,7 @@
 #include <QScrollBar>
 #include <QTextEdit>
 #include <QTextStream>
+#include <QThread>
 
 // To do:
 // - Show text while tapping.
@@ -56,8 +58,83 @@
 // - User's Guide documents the "Raw" type as "same as ASCII, but saving binary
 //   data". However it currently displays hex-encoded data.
 
-// Matches SplashOverlay.
-static int info_update_freq_ = 100;
+static QString format_follow_chunk(const follow_chunk_t *chunk, show_type_t show_type,
+                                   show_stream_t show_stream, guint32 prev_packet_num,
+                                   guint yaml_peer_num);
+
+// Searches the formatted text of each chunk in the background so that
+// finding something far away in a large stream doesn't block the UI.
+// The payload records must not be modified or freed while a search is
+// running; see FollowStreamDialog::cancelFind.
+class FollowFindThread : public QThread
+{
+public:
+    FollowFindThread(const follow_info_t *follow_info, const QVector<guint> &visible_chunks,
+                     const QVector<guint> &yaml_peer_nums,
+                     int start, int count, show_type_t show_type,
+                     const QString &text, bool use_regex) :
+        follow_info_(follow_info),
+        visible_chunks_(visible_chunks),
+        yaml_peer_nums_(yaml_peer_nums),
+        start_(start),
+        count_(count),
+        show_type_(show_type),
+        show_stream_(follow_info->show_stream),
+        text_(text),
+        regex_(text),
+        use_regex_(use_regex),
+        found_(-1)
+    {
+        canceled_.store(0);
+    }
+
+    void cancel() { canceled_.store(1); }
+    // Index into visible_chunks of the first matching chunk, or -1.
+    int found() const { return found_; }
+
+protected:
+    void run()
+    {
+        int num_chunks = visible_chunks_.size();
+
+        for (int i = 0; i < count_ && canceled_.load() == 0; i++) {
+            int idx = (start_ + i) % num_chunks;
+            const follow_chunk_t *chunk = &g_array_index(follow_info_->chunks, follow_chunk_t, visible_chunks_[idx]);
+            guint32 prev_packet_num = 0;
+            if (idx > 0) {
+                prev_packet_num = g_array_index(follow_info_->chunks, follow_chunk_t, visible_chunks_[idx - 1]).record->packet_num;
+            }
+            QString chunk_text = format_follow_chunk(chunk, show_type_, show_stream_, prev_packet_num,
+                                                     yaml_peer_nums_[idx]);
+
+            // Match QTextEdit::find, which is case insensitive for plain text.
+            bool match;
+            if (use_regex_) {
+                match = regex_.indexIn(chunk_text) >= 0;
+            } else {
+                match = chunk_text.contains(text_, Qt::CaseInsensitive);
+            }
+            if (match) {
+                found_ = idx;
+                return;
+            }
+        }
+    }
+
+private:
+    const follow_info_t *follow_info_;
+    QVector<guint> visible_chunks_;
+    QVector<guint> yaml_peer_nums_;
+    int start_;
+    int count_;
+    show_type_t show_type_;
+    show_stream_t show_stream_;
+    QString text_;
+    QRegExp regex_;
+    bool use_regex_;
+    int found_;
+    QAtomicInt canceled_;
+};
 
 FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_type_t type) :
     WiresharkDialog(parent, cf),
@@ -66,14 +143,11 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_
     follow_type_(type),
     follower_(NULL),
     show_type_(SHOW_ASCII),
-    truncated_(false),
-    client_buffer_count_(0),
-    server_buffer_count_(0),
     client_packet_count_(0),
     server_packet_count_(0),
-    last_packet_(0),
-    last_from_server_(0),
     turns_(0),
+    cur_page_(0),
+    find_thread_(NULL),
     use_regex_find_(false),
     terminating_(false)
 {
@@ -102,6 +176,8 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_
     follow_info_.show_stream = BOTH_HOSTS;
 
     ui->teStreamContent->installEventFilter(this);
+    ui->pageLabel->setVisible(false);
+    ui->pageSpinBox->setVisible(false);
 
     connect(ui->leFind, SIGNAL(useRegexFind(bool)), this, SLOT(useRegexFind(bool)));
 
@@ -144,6 +220,7 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_
 
 FollowStreamDialog::~FollowStreamDialog()
 {
+    cancelFind();
     delete ui;
     resetStream(); // Frees payload
 }
@@ -153,6 +230,7 @@ void FollowStreamDialog::printStream()
 #ifndef QT_NO_PRINTER
     QPrinter printer(QPrinter::HighResolution);
     QPrintDialog dialog(&printer, this);
+    // XXX - This only prints the current page.
     if (dialog.exec() == QDialog::Accepted)
         ui->teStreamContent->print(&printer);
 #endif
@@ -221,8 +299,9 @@ void FollowStreamDialog::updateWidgets(bool follow_in_progress)
     ui->cbDirections->setEnabled(enable);
     ui->cbCharset->setEnabled(enable);
     ui->streamNumberSpinBox->setEnabled(enable);
+    ui->pageSpinBox->setEnabled(enable);
     ui->leFind->setEnabled(enable);
-    ui->bFind->setEnabled(enable);
+    ui->bFind->setEnabled(enable && !find_thread_);
     b_filter_out_->setEnabled(enable);
     b_print_->setEnabled(enable);
     b_save_->setEnabled(enable);
@@ -239,32 +318,84 @@ void FollowStreamDialog::useRegexFind(bool use_regex)
         ui->lFind->setText(tr("Find:"));
 }
 
-void FollowStreamDialog::findText(bool go_back)
+bool FollowStreamDialog::findInPage()
 {
-    if (ui->leFind->text().isEmpty()) return;
-
     /* Version check due to find on teStreamContent. Expects regex since 5.3
      * http://doc.qt.io/qt-5/qplaintextedit.html#find-1 */
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 3, 0))
-    bool found;
     if (use_regex_find_) {
         QRegExp regex(ui->leFind->text());
-        found = ui->teStreamContent->find(regex);
-    } else {
-        found = ui->teStreamContent->find(ui->leFind->text());
+        return ui->teStreamContent->find(regex);
+    }
+#endif
+    return ui->teStreamContent->find(ui->leFind->text());
+}
+
+void FollowStreamDialog::findText(bool go_back)
+{
+    if (ui->leFind->text().isEmpty() || find_thread_) return;
+
+    if (findInPage()) {
+        ui->teStreamContent->setFocus();
+        return;
+    }
+
+    // Search the following pages, wrapping around to the start of this
+    // one if go_back is set, in the background.
+    int num_chunks = visible_chunks_.size();
+    int start = cur_page_ + 1 < page_starts_.size() ? page_starts_[cur_page_ + 1] : num_chunks;
+    int count = num_chunks - start;
+    if (go_back) {
+        count = num_chunks;
     }
-#else
-    bool found = ui->teStreamContent->find(ui->leFind->text());
+    if (count < 1) return;
+
+    bool use_regex = false;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 3, 0))
+    use_regex = use_regex_find_;
 #endif
+    find_thread_ = new FollowFindThread(&follow_info_, visible_chunks_, yaml_peer_nums_, start % num_chunks, count,
+                                        show_type_, ui->leFind->text(), use_regex);
+    connect(find_thread_, SIGNAL(finished()), this, SLOT(findFinished()));
+    ui->bFind->setEnabled(false);
+    find_thread_->start();
+}
+
+void FollowStreamDialog::findFinished()
+{
+    // We might have been canceled and restarted since this was queued.
+    if (!find_thread_ || !find_thread_->isFinished()) return;
+
+    int idx = find_thread_->found();
+    delete find_thread_;
+    find_thread_ = NULL;
+    ui->bFind->setEnabled(true);
 
-    if (found) {
+    if (idx < 0) return;
+
+    int page = pageForVisibleChunk(idx);
+    if (page != cur_page_) {
+        showPage(page);
+    }
+    QTextCursor cursor = ui->teStreamContent->textCursor();
+    cursor.setPosition(chunk_text_pos_.value(idx - page_starts_[page]));
+    ui->teStreamContent->setTextCursor(cursor);
+    if (findInPage()) {
         ui->teStreamContent->setFocus();
-    } else if (go_back) {
-        ui->teStreamContent->moveCursor(QTextCursor::Start);
-        findText(false);
     }
 }
 
+void FollowStreamDialog::cancelFind()
+{
+    if (!find_thread_) return;
+
+    find_thread_->cancel();
+    find_thread_->wait();
+    delete find_thread_;
+    find_thread_ = NULL;
+    ui->bFind->setEnabled(true);
+}
+
 void FollowStreamDialog::saveAs()
 {
     QString file_name = WiresharkFileDialog::getSaveFileName(this, wsApp->windowTitleString(tr("Save Stream Content As" UTF8_HORIZONTAL_ELLIPSIS)));
@@ -278,16 +409,25 @@ void FollowStreamDialog::saveAs()
         return;
     }
 
-    // Unconditionally save data as UTF-8 (even if data is decoded as UTF-16).
-    QByteArray bytes = ui->teStreamContent->toPlainText().toUtf8();
-    if (show_type_ == SHOW_RAW) {
-        // The "Raw" format is currently displayed as hex data and needs to be
-        // converted to binary data.
-        bytes = QByteArray::fromHex(bytes);
+    // The text edit only holds the current page, so format and write
+    // each chunk in turn.
+    for (int i = 0; i < visible_chunks_.size(); i++) {
+        const follow_chunk_t *chunk = visibleChunk(i);
+        qint64 written;
+        if (show_type_ == SHOW_RAW) {
+            // The "Raw" format is currently displayed as hex data. Save
+            // the binary data.
+            written = file.write((const char *) chunk->record->data->data, chunk->record->data->len);
+        } else {
+            // Unconditionally save data as UTF-8 (even if data is decoded as UTF-16).
+            written = file.write(format_follow_chunk(chunk, show_type_, follow_info_.show_stream,
+                                                     previousPacket(i), yaml_peer_nums_[i]).toUtf8());
+        }
+        if (written < 0) {
+            write_failure_alert_box(file_name.toUtf8().constData(), errno);
+            return;
+        }
     }
-
-    QDataStream out(&file);
-    out.writeRawData(bytes.constData(), bytes.size());
 }
 
 void FollowStreamDialog::helpButton()
@@ -365,6 +505,13 @@ void FollowStreamDialog::on_leFind_returnPressed()
     findText();
 }
 
+void FollowStreamDialog::on_pageSpinBox_valueChanged(int page_num)
+{
+    if (page_num > 0 && page_num - 1 != cur_page_) {
+        showPage(page_num - 1);
+    }
+}
+
 void FollowStreamDialog::on_streamNumberSpinBox_valueChanged(int stream_num)
 {
     if (file_closed_) return;
@@ -395,8 +542,14 @@ void FollowStreamDialog::resetStream()
     GList *cur;
     follow_record_t *follow_record;
 
+    cancelFind();
     filter_out_filter_.clear();
     text_pos_to_packet_.clear();
+    visible_chunks_.clear();
+    yaml_peer_nums_.clear();
+    page_starts_.clear();
+    chunk_text_pos_.clear();
+    follow_info_free_index(&follow_info_);
     if (!data_out_filename_.isEmpty()) {
         ws_unlink(data_out_filename_.toUtf8().constData());
     }
@@ -436,18 +589,11 @@ void FollowStreamDialog::resetStream()
 frs_return_t
 FollowStreamDialog::readStream()
 {
-
-    ui->teStreamContent->clear();
-    text_pos_to_packet_.clear();
-
-    truncated_ = false;
     frs_return_t ret;
 
-    client_buffer_count_ = 0;
-    server_buffer_count_ = 0;
+    cancelFind();
     client_packet_count_ = 0;
     server_packet_count_ = 0;
-    last_packet_ = 0;
     turns_ = 0;
 
     switch(follow_type_) {
@@ -465,8 +611,6 @@ FollowStreamDialog::readStream()
         break;
     }
 
-    ui->teStreamContent->moveCursor(QTextCursor::Start);
-
     return ret;
 }
 
@@ -476,19 +620,54 @@ FollowStreamDialog::followStream()
     readStream();
 }
 
-const int FollowStreamDialog::max_document_length_ = 500 * 1000 * 1000; // Just a guess
-void FollowStreamDialog::addText(QString text, gboolean is_from_server, guint32 packet_num)
+// Just a guess. Hex dumps are about five times this size.
+const guint64 FollowStreamDialog::max_page_bytes_ = 1024 * 1024;
+
+const follow_chunk_t *FollowStreamDialog::visibleChunk(int idx) const
 {
-    if (truncated_) {
-        return;
-    }
+    return &g_array_index(follow_info_.chunks, follow_chunk_t, visible_chunks_[idx]);
+}
 
-    int char_count = ui->teStreamContent->document()->characterCount();
-    if (char_count + text.length() > max_document_length_) {
-        text.truncate(max_document_length_ - char_count);
-        truncated_ = true;
+// Packet number of the chunk shown before visible chunk idx, or 0.
+guint32 FollowStreamDialog::previousPacket(int idx) const
+{
+    return idx > 0 ? visibleChunk(idx - 1)->record->packet_num : 0;
+}
+
+int FollowStreamDialog::pageForVisibleChunk(int idx) const
+{
+    QVector<int>::const_iterator it = std::upper_bound(page_starts_.constBegin(), page_starts_.constEnd(), idx);
+    return (int) (it - page_starts_.constBegin()) - 1;
+}
+
+void FollowStreamDialog::showPage(int page)
+{
+    ui->teStreamContent->clear();
+    text_pos_to_packet_.clear();
+    chunk_text_pos_.clear();
+    cur_page_ = page;
+
+    if (page >= 0 && page < page_starts_.size()) {
+        int end = page + 1 < page_starts_.size() ? page_starts_[page + 1] : visible_chunks_.size();
+
+        for (int i = page_starts_[page]; i < end; i++) {
+            const follow_chunk_t *chunk = visibleChunk(i);
+            chunk_text_pos_ << ui->teStreamContent->document()->characterCount() - 1;
+            addText(format_follow_chunk(chunk, show_type_, follow_info_.show_stream, previousPacket(i),
+                                        yaml_peer_nums_[i]),
+                    chunk->record->is_server, chunk->record->packet_num);
+        }
     }
 
+    ui->teStreamContent->moveCursor(QTextCursor::Start);
+
+    ui->pageSpinBox->blockSignals(true);
+    ui->pageSpinBox->setValue(cur_page_ + 1);
+    ui->pageSpinBox->blockSignals(false);
+}
+
+void FollowStreamDialog::addText(QString text, gboolean is_from_server, guint32 packet_num)
+{
     setUpdatesEnabled(false);
     int cur_pos = ui->teStreamContent->verticalScrollBar()->value();
     ui->teStreamContent->moveCursor(QTextCursor::End);
@@ -505,15 +684,7 @@ void FollowStreamDialog::addText(QString text, gboolean is_from_server, guint32
     ui->teStreamContent->insertPlainText(text);
     text_pos_to_packet_[ui->teStreamContent->textCursor().anchor()] = packet_num;
 
-    if (truncated_) {
-        tcf = ui->teStreamContent->currentCharFormat();
-        tcf.setBackground(palette().window().color());
-        tcf.setForeground(palette().windowText().color());
-        ui->teStreamContent->insertPlainText("\n" + tr("[Stream output truncated]"));
-        ui->teStreamContent->moveCursor(QTextCursor::End);
-    } else {
-        ui->teStreamContent->verticalScrollBar()->setValue(cur_pos);
-    }
+    ui->teStreamContent->verticalScrollBar()->setValue(cur_pos);
     setUpdatesEnabled(true);
 }
 
@@ -575,23 +746,30 @@ static inline void sanitize_buffer(char *buffer, size_t nchars) {
     }
 }
 
-frs_return_t
-FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_server, guint32 packet_num,
-                                guint32 *global_pos)
+static QString format_follow_chunk(const follow_chunk_t *chunk, show_type_t show_type,
+                                   show_stream_t show_stream, guint32 prev_packet_num,
+                                   guint yaml_peer_num)
 {
     gchar initbuf[256];
     guint32 current_pos;
     static const gchar hexchars[16] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+    gboolean is_from_server = chunk->record->is_server;
+    guint32 packet_num = chunk->record->packet_num;
+    QString text;
+
+    // We want a deep copy.
+    QByteArray bytes((const char *) chunk->record->data->data, chunk->record->data->len);
+    char *buffer = bytes.data();
+    size_t nchars = bytes.size();
 
-    switch (show_type_) {
+    switch (show_type) {
 
     case SHOW_EBCDIC:
     {
         /* If our native arch is ASCII, call: */
         EBCDIC_to_ASCII((guint8*)buffer, (guint) nchars);
         sanitize_buffer(buffer, nchars);
-        QByteArray ba = QByteArray(buffer, (int)nchars);
-        addText(ba, is_from_server, packet_num);
+        text = QString::fromLatin1(buffer, (int)nchars);
         break;
     }
 
@@ -601,8 +779,7 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
          * ASCII_TO_EBCDIC(buffer, nchars);
          */
         sanitize_buffer(buffer, nchars);
-        QByteArray ba = QByteArray(buffer, (int)nchars);
-        addText(ba, is_from_server, packet_num);
+        text = QString::fromLatin1(buffer, (int)nchars);
         break;
     }
 
@@ -611,8 +788,7 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
         // The QString docs say that invalid characters will be replaced with
         // replacement characters or removed. It would be nice if we could
         // explicitly choose one or the other.
-        QString utf8 = QString::fromUtf8(buffer, (int)nchars);
-        addText(utf8, is_from_server, packet_num);
+        text = QString::fromUtf8(buffer, (int)nchars);
         break;
     }
 
@@ -620,12 +796,14 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
     {
         // QString::fromUtf16 calls QUtf16::convertToUnicode, casting buffer
         // back to a const char * and doubling nchars.
-        QString utf16 = QString::fromUtf16((const unsigned short *)buffer, (int)nchars / 2);
-        addText(utf16, is_from_server, packet_num);
+        text = QString::fromUtf16((const unsigned short *)buffer, (int)nchars / 2);
         break;
     }
 
     case SHOW_HEXDUMP:
+    {
+        guint64 global_pos = chunk->dir_offset;
+
         current_pos = 0;
         while (current_pos < nchars) {
             gchar hexbuf[256];
@@ -635,11 +813,11 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
             /* is_from_server indentation : put 4 spaces at the
              * beginning of the string */
             /* XXX - We might want to prepend each line with "C" or "S" instead. */
-            if (is_from_server && follow_info_.show_stream == BOTH_HOSTS) {
+            if (is_from_server && show_stream == BOTH_HOSTS) {
                 memset(cur, ' ', 4);
                 cur += 4;
             }
-            cur += g_snprintf(cur, 20, "%08X  ", *global_pos);
+            cur += g_snprintf(cur, 20, "%08" G_GINT64_MODIFIER "X  ", global_pos);
             /* 49 is space consumed by hex chars */
             ascii_start = cur + 49 + 2;
             for (i = 0; i < 16 && current_pos + i < nchars; i++) {
@@ -665,21 +843,22 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
                 }
             }
             current_pos += i;
-            (*global_pos) += i;
+            global_pos += i;
             *cur++ = '\n';
             *cur = 0;
 
-            addText(hexbuf, is_from_server, packet_num);
+            text += QString::fromLatin1(hexbuf);
         }
         break;
+    }
 
     case SHOW_CARRAY:
         current_pos = 0;
-        g_snprintf(initbuf, sizeof(initbuf), "char peer%d_%d[] = { /* Packet %u */\n",
+        g_snprintf(initbuf, sizeof(initbuf), "char peer%d_%u[] = { /* Packet %u */\n",
                    is_from_server ? 1 : 0,
-                   is_from_server ? server_buffer_count_++ : client_buffer_count_++,
+                   chunk->dir_index,
                    packet_num);
-        addText(initbuf, is_from_server, packet_num);
+        text = QString::fromLatin1(initbuf);
 
         while (current_pos < nchars) {
             gchar hexbuf[256];
@@ -709,36 +888,31 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
             }
 
             current_pos += i;
-            (*global_pos) += i;
             hexbuf[cur++] = '\n';
             hexbuf[cur] = 0;
-            addText(hexbuf, is_from_server, packet_num);
+            text += QString::fromLatin1(hexbuf);
         }
         break;
 
     case SHOW_YAML:
     {
-        QString yaml_text;
-
         const int base64_raw_len = 57; // Encodes to 76 bytes, common in RFCs
         current_pos = 0;
 
-        if (packet_num != last_packet_) {
-            yaml_text.append(QString("# Packet %1\npeer%2_%3: !!binary |\n")
+        if (packet_num != prev_packet_num) {
+            text.append(QString("# Packet %1\npeer%2_%3: !!binary |\n")
                     .arg(packet_num)
                     .arg(is_from_server ? 1 : 0)
-                    .arg(is_from_server ? server_buffer_count_++ : client_buffer_count_++));
+                    .arg(yaml_peer_num));
         }
         while (current_pos < nchars) {
             int len = current_pos + base64_raw_len < nchars ? base64_raw_len : (int) nchars - current_pos;
             QByteArray base64_data(&buffer[current_pos], len);
 
-            yaml_text += "  " + base64_data.toBase64() + "\n";
+            text += "  " + base64_data.toBase64() + "\n";
 
             current_pos += len;
-            (*global_pos) += len;
         }
-        addText(yaml_text, is_from_server, packet_num);
         break;
     }
 
@@ -746,29 +920,12 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
     {
         QByteArray ba = QByteArray(buffer, (int)nchars).toHex();
         ba += '\n';
-        addText(ba, is_from_server, packet_num);
+        text = QString::fromLatin1(ba);
         break;
     }
     }
 
-    if (last_packet_ == 0) {
-        last_from_server_ = is_from_server;
-    }
-
-    if (packet_num != last_packet_) {
-        last_packet_ = packet_num;
-        if (is_from_server) {
-            server_packet_count_++;
-        } else {
-            client_packet_count_++;
-        }
-        if (last_from_server_ != is_from_server) {
-            last_from_server_ = is_from_server;
-            turns_++;
-        }
-    }
-
-    return FRS_OK;
+    return text;
 }
 
 bool FollowStreamDialog::follow(QString previous_filter, bool use_stream_index, int stream_num)
@@ -968,55 +1125,67 @@ void FollowStreamDialog::captureEvent(CaptureEvent e)
 frs_return_t
 FollowStreamDialog::readFollowStream()
 {
-    guint32 global_client_pos = 0, global_server_pos = 0;
-    guint32 *global_pos;
-    gboolean skip;
-    GList* cur;
-    frs_return_t frs_return;
-    follow_record_t *follow_record;
-    QElapsedTimer elapsed_timer;
+    guint64 page_bytes = 0;
+    guint32 last_packet = 0;
+    gboolean last_from_server = FALSE;
+    guint yaml_peer_count[2] = { 0, 0 };
 
-    elapsed_timer.start();
+    if (!follow_info_.chunks) {
+        follow_info_index_payload(&follow_info_);
+    }
 
-    for (cur = g_list_last(follow_info_.payload); cur; cur = g_list_previous(cur)) {
-        if (dialogClosed()) break;
+    visible_chunks_.clear();
+    yaml_peer_nums_.clear();
+    page_starts_.clear();
 
-        follow_record = (follow_record_t *)cur->data;
-        skip = FALSE;
-        if (!follow_record->is_server) {
-            global_pos = &global_client_pos;
-            if(follow_info_.show_stream == FROM_SERVER) {
-                skip = TRUE;
-            }
-        } else {
-            global_pos = &global_server_pos;
-            if (follow_info_.show_stream == FROM_CLIENT) {
-                skip = TRUE;
-            }
+    for (guint i = 0; i < follow_info_.chunks->len; i++) {
+        const follow_chunk_t *chunk = &g_array_index(follow_info_.chunks, follow_chunk_t, i);
+        gboolean is_from_server = chunk->record->is_server;
+
+        if ((is_from_server && follow_info_.show_stream == FROM_CLIENT) ||
+                (!is_from_server && follow_info_.show_stream == FROM_SERVER)) {
+            continue;
         }
 
-        QByteArray buffer;
-        if (!skip) {
-            // We want a deep copy.
-            buffer.clear();
-            buffer.append((const char *) follow_record->data->data,
-                                     follow_record->data->len);
-            frs_return = showBuffer(
-                        buffer.data(),
-                        follow_record->data->len,
-                        follow_record->is_server,
-                        follow_record->packet_num,
-                        global_pos);
-            if(frs_return == FRS_PRINT_ERROR)
-                return frs_return;
-            if (elapsed_timer.elapsed() > info_update_freq_) {
-                fillHintLabel(ui->teStreamContent->textCursor().position());
-                wsApp->processEvents();
-                elapsed_timer.start();
+        if (page_starts_.isEmpty() || page_bytes >= max_page_bytes_) {
+            page_starts_ << visible_chunks_.size();
+            page_bytes = 0;
+        }
+        page_bytes += chunk->record->data->len;
+        visible_chunks_ << i;
+
+        if (last_packet == 0) {
+            last_from_server = is_from_server;
+        }
+
+        if (chunk->record->packet_num != last_packet) {
+            last_packet = chunk->record->packet_num;
+            if (is_from_server) {
+                server_packet_count_++;
+            } else {
+                client_packet_count_++;
             }
+            if (last_from_server != is_from_server) {
+                last_from_server = is_from_server;
+                turns_++;
+            }
+            // YAML starts a new "peerN_M" entry here.
+            yaml_peer_count[is_from_server ? 1 : 0]++;
         }
+        yaml_peer_nums_ << yaml_peer_count[is_from_server ? 1 : 0] - 1;
     }
 
+    bool paged = page_starts_.size() > 1;
+    ui->pageSpinBox->blockSignals(true);
+    ui->pageSpinBox->setMaximum(qMax(page_starts_.size(), 1));
+    ui->pageSpinBox->blockSignals(false);
+    ui->pageSpinBox->setToolTip(tr("%Ln page(s).", "", page_starts_.size()));
+    ui->pageLabel->setToolTip(ui->pageSpinBox->toolTip());
+    ui->pageLabel->setVisible(paged);
+    ui->pageSpinBox->setVisible(paged);
+
+    showPage(0);
+
     return FRS_OK;
 }
 
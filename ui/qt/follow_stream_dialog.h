@@ -29,11 +29,14 @@
 #include <QFile>
 #include <QMap>
 #include <QPushButton>
+#include <QVector>
 
 namespace Ui {
 class FollowStreamDialog;
 }
 
+class FollowFindThread;
+
 class FollowStreamDialog : public WiresharkDialog
 {
     Q_OBJECT
@@ -67,8 +70,10 @@ private slots:
     void printStream();
     void fillHintLabel(int text_pos);
     void goToPacketForTextPos(int text_pos);
+    void findFinished();
 
     void on_streamNumberSpinBox_valueChanged(int stream_num);
+    void on_pageSpinBox_valueChanged(int page_num);
 
     void on_buttonBox_rejected();
 
@@ -81,16 +86,19 @@ private:
     void resetStream(void);
     void updateWidgets(bool follow_in_progress);
     void updateWidgets() { updateWidgets(false); } // Needed for WiresharkDialog?
-    frs_return_t
-    showBuffer(char *buffer, size_t nchars, gboolean is_from_server,
-                guint32 packet_num, guint32 *global_pos);
 
     frs_return_t readStream();
     frs_return_t readFollowStream();
     frs_return_t readSslStream();
 
     void followStream();
+    const follow_chunk_t *visibleChunk(int idx) const;
+    guint32 previousPacket(int idx) const;
+    int pageForVisibleChunk(int idx) const;
+    void showPage(int page);
     void addText(QString text, gboolean is_from_server, guint32 packet_num);
+    bool findInPage();
+    void cancelFind();
 
     Ui::FollowStreamDialog  *ui;
 
@@ -105,20 +113,23 @@ private:
     register_follow_t*      follower_;
     show_type_t             show_type_;
     QString                 data_out_filename_;
-    static const int        max_document_length_;
-    bool                    truncated_;
+    static const guint64    max_page_bytes_;
     QString                 previous_filter_;
     QString                 filter_out_filter_;
     QString                 output_filter_;
-    int                     client_buffer_count_;
-    int                     server_buffer_count_;
     int                     client_packet_count_;
     int                     server_packet_count_;
-    guint32                 last_packet_;
-    gboolean                last_from_server_;
     int                     turns_;
     QMap<int,guint32>       text_pos_to_packet_;
 
+    // Only one page of the stream is rendered at a time.
+    QVector<guint>          visible_chunks_;    // follow_info_.chunks indices for the selected direction(s)
+    QVector<guint>          yaml_peer_nums_;    // YAML "peerN_M" number of each visible chunk's packet
+    QVector<int>            page_starts_;       // visible_chunks_ index of the first chunk of each page
+    QVector<int>            chunk_text_pos_;    // Text position of each chunk on the current page
+    int                     cur_page_;
+    FollowFindThread        *find_thread_;
+
     bool                    use_regex_find_;
 
     bool                    terminating_;
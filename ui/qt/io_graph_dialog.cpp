@@ -1156,14 +1156,19 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 {
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
     bool need_retap = false;
+    bool need_recalc = false;
 
     if (uat_model_ != NULL) {
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
             if (iog) {
-                iog->setInterval(interval);
+                bool iog_retap = iog->setInterval(interval);
                 if (iog->visible()) {
-                    need_retap = true;
+                    if (iog_retap) {
+                        need_retap = true;
+                    } else {
+                        need_recalc = true;
+                    }
                 }
             }
         }
@@ -1171,6 +1176,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else if (need_recalc) {
+        scheduleRecalc(true);
     }
 
     updateLegend();
@@ -1493,6 +1500,11 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     bars_(NULL),
     val_units_(IOG_ITEM_UNIT_FIRST),
     hf_index_(-1),
+    interval_(0),
+    tap_interval_(0),
+    tap_cur_idx_(-1),
+    tap_truncated_(false),
+    items_(tap_items_),
     cur_idx_(-1)
 {
     Q_ASSERT(parent_ != NULL);
@@ -1703,6 +1715,8 @@ void IOGraph::setValueUnits(int val_units)
         val_units_ = (io_graph_item_unit_t)val_units;
 
         if (old_val_units != val_units) {
+            // The frame with the extreme value depends on the unit.
+            clearRollupItems();
             setFilter(filter_); // Check config & prime vu field
             if (val_units < IOG_ITEM_UNIT_CALC_SUM) {
                 emit requestRecalc();
@@ -1778,8 +1792,13 @@ int IOGraph::packetFromTime(double ts)
 
 void IOGraph::clearAllData()
 {
+    tap_interval_ = interval_;
+    tap_cur_idx_ = -1;
+    tap_truncated_ = false;
+    reset_io_graph_items(tap_items_, max_io_items_);
+    rollup_items_.clear();
+    items_ = tap_items_;
     cur_idx_ = -1;
-    reset_io_graph_items(items_, max_io_items_);
     if (graph_) {
         graph_->clearData();
     }
@@ -1797,6 +1816,8 @@ void IOGraph::recalcGraphData(capture_file *cap_file, bool enable_scaling)
     double mavg_cumulated = 0;
     QCPAxis *x_axis = NULL;
 
+    selectIntervalItems();
+
     if (graph_) {
         graph_->clearData();
         x_axis = graph_->keyAxis();
@@ -1977,9 +1998,56 @@ void IOGraph::reloadValueUnitField()
     }
 }
 
-void IOGraph::setInterval(int interval)
+bool IOGraph::setInterval(int interval)
 {
     interval_ = interval;
+    return !selectIntervalItems();
+}
+
+void IOGraph::clearRollupItems()
+{
+    if (rollup_items_.isEmpty()) {
+        return;
+    }
+    rollup_items_.clear();
+    // Until the next recalc.
+    items_ = tap_items_;
+    cur_idx_ = (interval_ == tap_interval_) ? tap_cur_idx_ : -1;
+}
+
+// Point items_ at the items for interval_, rolling them up from the tapped
+// items if needed. Returns false if they can't be derived from the tapped
+// items, i.e. if interval_ isn't a multiple of the tapped interval or if
+// some packets didn't fit in the tapped items.
+bool IOGraph::selectIntervalItems()
+{
+    if (tap_interval_ <= 0 || interval_ < tap_interval_ || interval_ % tap_interval_ != 0 ||
+            (tap_truncated_ && interval_ != tap_interval_)) {
+        items_ = tap_items_;
+        cur_idx_ = tap_cur_idx_;
+        return false;
+    }
+
+    if (interval_ == tap_interval_) {
+        items_ = tap_items_;
+        cur_idx_ = tap_cur_idx_;
+        return true;
+    }
+
+    if (!rollup_items_.contains(interval_)) {
+        QVector<io_graph_item_t> &rollup = rollup_items_[interval_];
+        int factor = interval_ / tap_interval_;
+        int count = tap_cur_idx_ + 1;
+
+        if (count > 0) {
+            rollup.resize((count - 1) / factor + 1);
+            rollup_io_graph_items(rollup.data(), tap_items_, count, factor, val_units_);
+        }
+    }
+    const QVector<io_graph_item_t> &rollup = rollup_items_[interval_];
+    items_ = rollup.constData();
+    cur_idx_ = rollup.size() - 1;
+    return true;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -2008,18 +2076,22 @@ gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *e
         return FALSE;
     }
 
-    int idx = get_io_graph_index(pinfo, iog->interval_);
+    int idx = get_io_graph_index(pinfo, iog->tap_interval_);
     bool recalc = false;
 
     /* some sanity checks */
     if ((idx < 0) || (idx >= max_io_items_)) {
-        iog->cur_idx_ = max_io_items_ - 1;
+        iog->tap_cur_idx_ = max_io_items_ - 1;
+        iog->tap_truncated_ = true;
         return FALSE;
     }
 
+    /* rolled up items are out of date now */
+    iog->clearRollupItems();
+
     /* update num_items */
-    if (idx > iog->cur_idx_) {
-        iog->cur_idx_ = (guint32) idx;
+    if (idx > iog->tap_cur_idx_) {
+        iog->tap_cur_idx_ = (guint32) idx;
         recalc = true;
     }
 
@@ -2037,7 +2109,7 @@ gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *e
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(iog->items_, idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    if (!update_io_graph_item(iog->tap_items_, idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->tap_interval_)) {
         return FALSE;
     }
 
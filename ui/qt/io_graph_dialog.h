@@ -24,8 +24,10 @@
 #include <ui/qt/models/uat_delegate.h>
 
 #include <QIcon>
+#include <QMap>
 #include <QMenu>
 #include <QTextStream>
+#include <QVector>
 
 class QRubberBand;
 class QTimer;
@@ -63,7 +65,8 @@ public:
     const QString valueUnitField() { return vu_field_; }
     void setValueUnitField(const QString &vu_field);
     unsigned int movingAveragePeriod() { return moving_avg_period_; }
-    void setInterval(int interval);
+    // Returns true if the graph has to be retapped for the new interval.
+    bool setInterval(int interval);
     bool addToLegend();
     bool removeFromLegend();
     QCPGraph *graph() { return graph_; }
@@ -95,6 +98,8 @@ private:
     static void tapDraw(void *iog_ptr);
 
     void calculateScaledValueUnit();
+    bool selectIntervalItems();
+    void clearRollupItems();
     template<class DataMap> double maxValueFromGraphData(const DataMap &map);
     template<class DataMap> void scaleGraphData(DataMap &map, int scalar);
 
@@ -115,7 +120,17 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
-    io_graph_item_t items_[max_io_items_];
+    // Packets are tapped into tap_items_ at tap_interval_. Coarser intervals
+    // are rolled up from them on demand and kept in rollup_items_, so that
+    // zooming out doesn't require a retap.
+    io_graph_item_t tap_items_[max_io_items_];
+    int tap_interval_;
+    int tap_cur_idx_;
+    // Packets didn't fit in tap_items_, so rollups would be incomplete.
+    bool tap_truncated_;
+    QMap<int, QVector<io_graph_item_t> > rollup_items_;
+    // The items for interval_.
+    const io_graph_item_t *items_;
     int cur_idx_;
 };
 
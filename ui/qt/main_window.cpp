@@ -286,6 +286,7 @@ MainWindow::MainWindow(QWidget *parent) :
 #ifdef HAVE_LIBPCAP
     , capture_interfaces_dialog_(NULL)
     , info_data_()
+    , pending_read_queued_(false)
 #endif
     , display_filter_dlg_(NULL)
     , capture_filter_dlg_(NULL)
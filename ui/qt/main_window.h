@@ -199,6 +199,7 @@ private:
     capture_session cap_session_;
     CaptureInterfacesDialog *capture_interfaces_dialog_;
     info_data_t info_data_;
+    bool pending_read_queued_;
 #endif
     FilterDialog *display_filter_dlg_;
     FilterDialog *capture_filter_dlg_;
@@ -314,7 +315,9 @@ public slots:
 #ifdef HAVE_LIBPCAP
     void captureCapturePrepared(capture_session *);
     void captureCaptureUpdateStarted(capture_session *);
+    void captureCaptureUpdateContinue(capture_session *);
     void captureCaptureUpdateFinished(capture_session *);
+    void readPendingCapturePackets();
     void captureCaptureFixedFinished(capture_session *cap_session);
     void captureCaptureFailed(capture_session *);
 #endif
@@ -33,6 +33,7 @@ DIAG_ON(frame-larger-than=)
 
 #ifdef HAVE_LIBPCAP
 #include "ui/capture.h"
+#include <capchild/capture_sync.h>
 #endif
 
 #include "ui/commandline.h"
@@ -159,6 +160,7 @@ DIAG_ON(frame-larger-than=)
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QTimer>
 #include <QToolBar>
 #include <QDesktopServices>
 #include <QUrl>
@@ -513,6 +515,23 @@ void MainWindow::captureCaptureUpdateStarted(capture_session *session) {
     setForCapturedPackets(true);
 }
 
+// cf_continue_tail reads for a limited amount of time so that we can
+// repaint. If it left packets behind, come back for them even if the
+// capture child doesn't have anything new for us.
+void MainWindow::captureCaptureUpdateContinue(capture_session *session) {
+    if (session->count_pending > 0 && !pending_read_queued_) {
+        pending_read_queued_ = true;
+        QTimer::singleShot(0, this, SLOT(readPendingCapturePackets()));
+    }
+}
+
+void MainWindow::readPendingCapturePackets() {
+    pending_read_queued_ = false;
+    if (cap_session_.state == CAPTURE_RUNNING && cap_session_.count_pending > 0) {
+        capture_input_new_packets(&cap_session_, 0);
+    }
+}
+
 void MainWindow::captureCaptureUpdateFinished(capture_session *) {
 
     /* The capture isn't stopping any more - it's stopped. */
@@ -699,6 +718,9 @@ void MainWindow::captureEventHandler(CaptureEvent ev)
         case CaptureEvent::Started:
             captureCaptureUpdateStarted(ev.capSession());
             break;
+        case CaptureEvent::Continued:
+            captureCaptureUpdateContinue(ev.capSession());
+            break;
         case CaptureEvent::Finished:
             captureCaptureUpdateFinished(ev.capSession());
             break;
@@ -14,8 +14,10 @@
 #include "file.h"
 
 #include <wsutil/nstime.h>
+#include <epan/app_mem_usage.h>
 #include <epan/column.h>
 #include <epan/prefs.h>
+#include <epan/timestamp.h>
 
 #include "ui/packet_list_utils.h"
 #include "ui/recent.h"
@@ -26,11 +28,13 @@
 #include <ui/qt/utils/color_utils.h>
 #include "wireshark_application.h"
 
+#include <QAtomicInt>
 #include <QColor>
 #include <QElapsedTimer>
 #include <QFontMetrics>
 #include <QModelIndex>
 #include <QElapsedTimer>
+#include <QThread>
 
 // Print timing information
 //#define DEBUG_PACKET_LIST_MODEL 1
@@ -41,13 +45,27 @@
 
 static const int reserved_packets_ = 100000;
 
+static gsize packet_list_text_mem_usage(void)
+{
+    return PacketListRecord::stringPoolSize();
+}
+
+static const ws_mem_usage_t packet_list_text_usage_ = { "Packet list text", packet_list_text_mem_usage, NULL };
+
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     QAbstractItemModel(parent),
+    rows_generation_(0),
     number_to_row_(QVector<int>()),
     max_row_height_(0),
     max_line_count_(1),
     idle_dissection_row_(0)
 {
+    static bool mem_usage_registered = false;
+    if (!mem_usage_registered) {
+        memory_usage_component_register(&packet_list_text_usage_);
+        mem_usage_registered = true;
+    }
+
     setCaptureFile(cf);
     PacketListRecord::clearStringPool();
 
@@ -70,6 +88,7 @@ PacketListModel::~PacketListModel()
 void PacketListModel::setCaptureFile(capture_file *cf)
 {
     cap_file_ = cf;
+    rows_generation_++;
     resetColumns();
 }
 
@@ -127,6 +146,7 @@ void PacketListModel::clear() {
     beginResetModel();
     qDeleteAll(physical_rows_);
     physical_rows_.resize(0);
+    rows_generation_++;
     visible_rows_.resize(0);
     new_visible_rows_.resize(0);
     number_to_row_.resize(0);
@@ -297,6 +317,277 @@ capture_file *PacketListModel::sort_cap_file_;
 
 QElapsedTimer busy_timer_;
 const int busy_timeout_ = 65; // ms, approximately 15 fps
+
+// Sorting is done on an array of keys extracted from the records up front,
+// so that comparisons don't have to look up column strings or parse numbers.
+// The keys are plain values (numbers, time stamps and strings copied into
+// a pool owned by the sort), so the worker threads that sort them never
+// touch the records, the frame data or epan.
+struct PacketListSortKey {
+    PacketListRecord *record;   // Only used once the sort is done.
+    guint32 frame_num;
+    bool ref_time;
+    nstime_t ts;        // Time stamp or time delta for time columns.
+    guint64 uint_val;   // Frame number, length or cumulative bytes.
+    const char *str;    // Column string. NULL for frame data columns.
+    double num;         // Numeric value for numeric columns, if num_ok.
+    bool num_ok;
+};
+
+// The part of a frame data column that a key holds.
+enum PacketListSortKeyType {
+    sort_key_none_,     // Everything compares equal.
+    sort_key_uint_,     // uint_val, then frame number.
+    sort_key_time_,     // Reference time flag, ts, then frame number.
+    sort_key_string_    // str or num, then frame number.
+};
+
+// Mirrors frame_data_compare().
+static PacketListSortKeyType frameDataSortKeyType(gint col_fmt)
+{
+    switch (col_fmt) {
+    case COL_NUMBER:
+    case COL_PACKET_LENGTH:
+    case COL_CUMULATIVE_BYTES:
+        return sort_key_uint_;
+
+    case COL_CLS_TIME:
+        return timestamp_get_type() == TS_NOT_SET ? sort_key_none_ : sort_key_time_;
+
+    case COL_ABS_TIME:
+    case COL_ABS_YMD_TIME:
+    case COL_ABS_YDOY_TIME:
+    case COL_UTC_TIME:
+    case COL_UTC_YMD_TIME:
+    case COL_UTC_YDOY_TIME:
+    case COL_REL_TIME:
+    case COL_DELTA_TIME:
+    case COL_DELTA_TIME_DIS:
+        return sort_key_time_;
+    }
+    return sort_key_none_;
+}
+
+// Fills in the frame data part of a key. This reads other frames' time
+// stamps through epan, so it has to be done on the GUI thread.
+static void setFrameDataSortKey(PacketListSortKey &key, const struct epan_session *epan, const frame_data *fdata, gint col_fmt)
+{
+    guint32 prev_num = 0;
+
+    switch (col_fmt) {
+    case COL_NUMBER:
+        key.uint_val = fdata->num;
+        return;
+
+    case COL_PACKET_LENGTH:
+        key.uint_val = fdata->pkt_len;
+        return;
+
+    case COL_CUMULATIVE_BYTES:
+        key.uint_val = fdata->cum_bytes;
+        return;
+
+    case COL_CLS_TIME:
+        switch (timestamp_get_type()) {
+        case TS_RELATIVE:
+            col_fmt = COL_REL_TIME;
+            break;
+        case TS_DELTA:
+            col_fmt = COL_DELTA_TIME;
+            break;
+        case TS_DELTA_DIS:
+            col_fmt = COL_DELTA_TIME_DIS;
+            break;
+        default:
+            col_fmt = COL_ABS_TIME;
+            break;
+        }
+        break;
+    }
+
+    switch (col_fmt) {
+    case COL_REL_TIME:
+        prev_num = fdata->frame_ref_num;
+        break;
+    case COL_DELTA_TIME:
+        prev_num = fdata->num - 1;
+        break;
+    case COL_DELTA_TIME_DIS:
+        prev_num = fdata->prev_dis_num;
+        break;
+    default:
+        key.ts = fdata->abs_ts;
+        return;
+    }
+    frame_delta_abs_time(epan, fdata, prev_num, &key.ts);
+}
+
+class PacketListSortKeyLess
+{
+public:
+    PacketListSortKeyLess(PacketListSortKeyType key_type, bool numeric, Qt::SortOrder order, QAtomicInt *cancel) :
+        key_type_(key_type),
+        numeric_(numeric),
+        ascending_(order == Qt::AscendingOrder),
+        cancel_(cancel)
+    {}
+
+    bool operator()(const PacketListSortKey &k1, const PacketListSortKey &k2) const
+    {
+        // Once cancelled, everything compares equal, which finishes the
+        // sort quickly. The result is thrown away.
+        if (cancel_->load()) {
+            return false;
+        }
+
+        int cmp_val = compare(k1, k2);
+
+        return ascending_ ? cmp_val < 0 : cmp_val > 0;
+    }
+
+private:
+    PacketListSortKeyType key_type_;
+    bool numeric_;
+    bool ascending_;
+    QAtomicInt *cancel_;
+
+    int compare(const PacketListSortKey &k1, const PacketListSortKey &k2) const
+    {
+        int cmp_val = 0;
+
+        switch (key_type_) {
+        case sort_key_none_:
+            return 0;
+
+        case sort_key_uint_:
+            cmp_val = (k1.uint_val > k2.uint_val) - (k1.uint_val < k2.uint_val);
+            break;
+
+        case sort_key_time_:
+            // A reference time sorts before any other time.
+            if (k1.ref_time != k2.ref_time) {
+                return k1.ref_time ? -1 : 1;
+            }
+            cmp_val = nstime_cmp(&k1.ts, &k2.ts);
+            break;
+
+        case sort_key_string_:
+            if (k1.str == k2.str) {
+                cmp_val = 0;
+            } else if (numeric_) {
+                // Custom column with numeric data (or something like a port number).
+                if (!k1.num_ok && !k2.num_ok) {
+                    cmp_val = 0;
+                } else if (!k1.num_ok || (k2.num_ok && k1.num < k2.num)) {
+                    // either k1 is invalid (and sort it before others) or both
+                    // k1 and k2 are valid (sort normally)
+                    cmp_val = -1;
+                } else if (!k2.num_ok || (k1.num_ok && k1.num > k2.num)) {
+                    cmp_val = 1;
+                }
+            } else {
+                cmp_val = strcmp(k1.str, k2.str);
+            }
+            break;
+        }
+
+        if (cmp_val == 0) {
+            // All else being equal, compare frame numbers.
+            cmp_val = (k1.frame_num > k2.frame_num) - (k1.frame_num < k2.frame_num);
+        }
+        return cmp_val;
+    }
+};
+
+// Sorts a range of keys, or merges two adjacent sorted ranges.
+class PacketListSortThread : public QThread
+{
+public:
+    PacketListSortThread(PacketListSortKey *first, PacketListSortKey *middle, PacketListSortKey *last, const PacketListSortKeyLess &less) :
+        first_(first),
+        middle_(middle),
+        last_(last),
+        less_(less)
+    {}
+
+protected:
+    void run()
+    {
+        if (middle_) {
+            std::inplace_merge(first_, middle_, last_, less_);
+        } else {
+            std::sort(first_, last_, less_);
+        }
+    }
+
+private:
+    PacketListSortKey *first_;
+    PacketListSortKey *middle_;
+    PacketListSortKey *last_;
+    PacketListSortKeyLess less_;
+};
+
+// Don't bother with more than one thread for small lists.
+const int min_rows_per_sort_thread_ = 50000;
+
+// Wait for the threads to finish. As with the single threaded sort, user
+// input and socket notifiers (new packets from a live capture) are held
+// off until the sort is done, so that only the busy indicator is updated.
+// If the rows change anyway, the sort is cancelled.
+static void waitForSortThreads(QList<PacketListSortThread *> &threads, const unsigned *rows_generation, unsigned sort_generation, QAtomicInt *cancel)
+{
+    foreach (PacketListSortThread *thread, threads) {
+        while (!thread->wait(busy_timeout_)) {
+            wsApp->processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers, 1);
+            if (*rows_generation != sort_generation) {
+                cancel->store(1);
+            }
+        }
+    }
+    qDeleteAll(threads);
+    threads.clear();
+}
+
+// Sort the keys: each thread sorts a chunk, after which adjacent chunks
+// are merged pairwise, again in parallel, until one run is left.
+static bool sortKeys(QVector<PacketListSortKey> &keys, const PacketListSortKeyLess &less, const unsigned *rows_generation, unsigned sort_generation, QAtomicInt *cancel)
+{
+    PacketListSortKey *base = keys.data();
+    int num_keys = keys.size();
+    int num_chunks = qBound(1, QThread::idealThreadCount(), qMax(1, num_keys / min_rows_per_sort_thread_));
+    QVector<int> bounds;
+    QList<PacketListSortThread *> threads;
+
+    for (int i = 0; i <= num_chunks; i++) {
+        bounds << (int) ((qint64) num_keys * i / num_chunks);
+    }
+
+    for (int i = 0; i < num_chunks; i++) {
+        threads << new PacketListSortThread(base + bounds[i], NULL, base + bounds[i + 1], less);
+        threads.last()->start();
+    }
+    waitForSortThreads(threads, rows_generation, sort_generation, cancel);
+
+    while (bounds.size() > 2 && !cancel->load()) {
+        QVector<int> merged_bounds;
+        int i;
+
+        for (i = 0; i + 2 < bounds.size(); i += 2) {
+            threads << new PacketListSortThread(base + bounds[i], base + bounds[i + 1], base + bounds[i + 2], less);
+            threads.last()->start();
+            merged_bounds << bounds[i];
+        }
+        // An odd run out is carried over to the next round.
+        for (; i < bounds.size(); i++) {
+            merged_bounds << bounds[i];
+        }
+        waitForSortThreads(threads, rows_generation, sort_generation, cancel);
+        bounds = merged_bounds;
+    }
+
+    return !cancel->load() && *rows_generation == sort_generation;
+}
+
 void PacketListModel::sort(int column, Qt::SortOrder order)
 {
     // packet_list_store.c:packet_list_dissect_and_cache_all
@@ -307,43 +598,102 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     text_sort_column_ = PacketListRecord::textColumn(column);
     sort_order_ = order;
     sort_cap_file_ = cap_file_;
+    sort_column_is_numeric_ = isNumericColumn(sort_column_);
 
     gboolean stop_flag = FALSE;
     QString col_title = get_column_title(column);
-
+    QVector<PacketListSortKey> keys;
+    gint col_fmt = sort_cap_file_->cinfo.columns[column].col_fmt;
+    PacketListSortKeyType key_type = text_sort_column_ >= 0 ? sort_key_string_ : frameDataSortKeyType(col_fmt);
+    // Copies of the column strings, so that the sort doesn't depend on
+    // the records' string pool.
+    GStringChunk *key_pool = NULL;
+    // If the rows are cleared or sorted again while we're processing
+    // events, the keys are stale. Packets that are appended in the
+    // meantime (during a live capture) are left at the end.
+    unsigned sort_generation = ++rows_generation_;
+    int num_rows = physical_rows_.count();
+
+    // Dissection isn't thread safe, so the column strings have to be
+    // extracted here. Parse them into keys while we're at it.
+    keys.reserve(num_rows);
+    if (key_type == sort_key_string_) {
+        key_pool = g_string_chunk_new(1024 * 1024);
+    }
     busy_timer_.start();
     emit pushProgressStatus(tr("Dissecting"), true, true, &stop_flag);
-    int row_num = 0;
-    foreach (PacketListRecord *row, physical_rows_) {
-        row->columnString(sort_cap_file_, column);
-        row_num++;
-        if (busy_timer_.elapsed() > busy_timeout_) {
-            if (stop_flag) {
-                emit popProgressStatus();
-                return;
+    for (int row_num = 0; row_num < num_rows; row_num++) {
+        PacketListRecord *row = physical_rows_[row_num];
+        frame_data *fdata = row->frameData();
+        PacketListSortKey key;
+
+        key.record = row;
+        key.frame_num = fdata->num;
+        key.ref_time = fdata->flags.ref_time ? true : false;
+        nstime_set_zero(&key.ts);
+        key.uint_val = 0;
+        key.str = NULL;
+        key.num = 0.0;
+        key.num_ok = false;
+        if (key_type == sort_key_string_) {
+            const char *str = row->columnCString(sort_cap_file_, column);
+
+            // Equal strings get the same copy, so they compare equal by
+            // pointer.
+            key.str = g_string_chunk_insert_const(key_pool, str ? str : "");
+            if (sort_column_is_numeric_) {
+                key.num = parseNumericColumn(key.str, &key.num_ok);
             }
-            emit updateProgressStatus(row_num * 100 / physical_rows_.count());
+        } else {
+            setFrameDataSortKey(key, sort_cap_file_->epan, fdata, col_fmt);
+        }
+        keys << key;
+
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            emit updateProgressStatus((row_num + 1) * 100 / num_rows);
             // What's the least amount of processing that we can do which will draw
             // the progress indicator?
             wsApp->processEvents(QEventLoop::AllEvents, 1);
             busy_timer_.restart();
+            if (stop_flag || rows_generation_ != sort_generation) {
+                emit popProgressStatus();
+                if (key_pool) {
+                    g_string_chunk_free(key_pool);
+                }
+                return;
+            }
         }
     }
     emit popProgressStatus();
 
-    // XXX Use updateProgress instead. We'd have to switch from std::sort to
-    // something we can interrupt.
+    QAtomicInt cancel(0);
+    PacketListSortKeyLess less(key_type, sort_column_is_numeric_, order, &cancel);
+
     if (!col_title.isEmpty()) {
         QString busy_msg = tr("Sorting \"%1\"").arg(col_title);
         emit pushBusyStatus(busy_msg);
     }
+    bool sorted = sortKeys(keys, less, &rows_generation_, sort_generation, &cancel);
+    if (!col_title.isEmpty()) {
+        emit popBusyStatus();
+    }
+    if (key_pool) {
+        g_string_chunk_free(key_pool);
+    }
+    if (!sorted) {
+        // The model was cleared or sorted again during the sort.
+        return;
+    }
 
-    busy_timer_.restart();
-    sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    // keys covers the rows present when we started.
+    for (int i = 0; i < keys.size(); i++) {
+        physical_rows_[i] = keys[i].record;
+    }
 
     beginResetModel();
     visible_rows_.resize(0);
+    // Rows that were appended while we sorted are picked up below.
+    new_visible_rows_.resize(0);
     number_to_row_.fill(0);
     foreach (PacketListRecord *record, physical_rows_) {
         frame_data *fdata = record->frameData();
@@ -358,10 +708,6 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     }
     endResetModel();
 
-    if (!col_title.isEmpty()) {
-        emit popBusyStatus();
-    }
-
     if (cap_file_->current_frame) {
         emit goToPacket(cap_file_->current_frame->num);
     }
@@ -434,70 +780,11 @@ bool PacketListModel::isNumericColumn(int column)
     return true;
 }
 
-bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
-{
-    int cmp_val = 0;
-
-    // Wherein we try to cram the logic of packet_list_compare_records,
-    // _packet_list_compare_records, and packet_list_compare_custom from
-    // gtk/packet_list_store.c into one function
-
-    if (busy_timer_.elapsed() > busy_timeout_) {
-        // What's the least amount of processing that we can do which will draw
-        // the busy indicator?
-        wsApp->processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers, 1);
-        busy_timer_.restart();
-    }
-    if (sort_column_ < 0) {
-        // No column.
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
-        // Column comes directly from frame data
-        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
-    } else  {
-        if (r1->columnString(sort_cap_file_, sort_column_).constData() == r2->columnString(sort_cap_file_, sort_column_).constData()) {
-            cmp_val = 0;
-        } else if (sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this?
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1->columnString(sort_cap_file_, sort_column_), &ok_r1);
-            double num_r2 = parseNumericColumn(r2->columnString(sort_cap_file_, sort_column_), &ok_r2);
-
-            if (!ok_r1 && !ok_r2) {
-                cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
-                // either r1 is invalid (and sort it before others) or both
-                // r1 and r2 are valid (sort normally)
-                cmp_val = -1;
-            } else if (!ok_r2 || (ok_r1 && num_r1 > num_r2)) {
-                cmp_val = 1;
-            }
-        } else {
-            cmp_val = strcmp(r1->columnString(sort_cap_file_, sort_column_).constData(), r2->columnString(sort_cap_file_, sort_column_).constData());
-        }
-
-        if (cmp_val == 0) {
-            // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-        }
-    }
-
-    if (sort_order_ == Qt::AscendingOrder) {
-        return cmp_val < 0;
-    } else {
-        return cmp_val > 0;
-    }
-}
-
 // Parses a field as a double. Handle values with suffixes ("12ms"), negative
 // values ("-1.23") and fields with multiple occurrences ("1,2"). Marks values
 // that do not contain any numeric value ("Unknown") as invalid.
-double PacketListModel::parseNumericColumn(const QString &val, bool *ok)
+double PacketListModel::parseNumericColumn(const char *strval, bool *ok)
 {
-    QByteArray ba = val.toUtf8();
-    const char *strval = ba.constData();
     gchar *end = NULL;
     double num = g_ascii_strtod(strval, &end);
     *ok = strval != end;
@@ -646,7 +933,7 @@ void PacketListModel::flushVisibleRows()
     gint pos = visible_rows_.count();
 
     if (new_visible_rows_.count() > 0) {
-        beginInsertRows(QModelIndex(), pos, pos + new_visible_rows_.count());
+        beginInsertRows(QModelIndex(), pos, pos + new_visible_rows_.count() - 1);
         foreach (PacketListRecord *record, new_visible_rows_) {
             frame_data *fdata = record->frameData();
 
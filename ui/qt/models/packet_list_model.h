@@ -93,6 +93,7 @@ private:
     capture_file *cap_file_;
     QList<QString> col_names_;
     QVector<PacketListRecord *> physical_rows_;
+    unsigned rows_generation_; // Bumped when physical_rows_ is cleared or re-sorted, not when packets are appended.
     QVector<PacketListRecord *> visible_rows_;
     QVector<PacketListRecord *> new_visible_rows_;
     QVector<int> number_to_row_;
@@ -105,8 +106,7 @@ private:
     static int text_sort_column_;
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
-    static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
-    static double parseNumericColumn(const QString &val, bool *ok);
+    static double parseNumericColumn(const char *strval, bool *ok);
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
@@ -23,21 +23,12 @@
 
 #include <QStringList>
 
-class ColumnTextList : public QList<const char *> {
-public:
-    // Allocate our records using wmem.
-    static void *operator new(size_t size) {
-        return wmem_alloc(wmem_file_scope(), size);
-    }
-
-    static void operator delete(void *) {}
-};
-
 QMap<int, int> PacketListRecord::cinfo_column_;
 unsigned PacketListRecord::col_data_ver_ = 1;
 
 PacketListRecord::PacketListRecord(frame_data *frameData) :
-    col_text_(0),
+    col_text_ids_(NULL),
+    num_col_text_ids_(0),
     fdata_(frameData),
     lines_(1),
     line_count_changed_(false),
@@ -52,23 +43,48 @@ void *PacketListRecord::operator new(size_t size)
     return wmem_alloc(wmem_file_scope(), size);
 }
 
-// We might want to return a const char * instead. This would keep us from
-// creating excessive QByteArrays, e.g. in PacketListModel::recordLessThan.
 const QByteArray PacketListRecord::columnString(capture_file *cap_file, int column, bool colorized)
+{
+    const char *col_str = columnCString(cap_file, column, colorized);
+
+    return col_str ? QByteArray(col_str) : QByteArray();
+}
+
+const char *PacketListRecord::columnCString(capture_file *cap_file, int column, bool colorized)
 {
     // packet_list_store.c:packet_list_get_value
     g_assert(fdata_);
 
     if (!cap_file || column < 0 || column > cap_file->cinfo.num_cols) {
-        return QByteArray();
+        return NULL;
     }
 
     bool dissect_color = colorized && !colorized_;
-    if (!col_text_ || column >= col_text_->size() || !col_text_->at(column) || data_ver_ != col_data_ver_ || dissect_color) {
+    if (!col_text_ids_ || column >= num_col_text_ids_ || data_ver_ != col_data_ver_ || dissect_color ||
+            (col_text_ids_[column] == 0 && !uncached_col_text_.contains(this))) {
         dissect(cap_file, dissect_color);
     }
 
-    return col_text_->value(column, QByteArray());
+    if (!col_text_ids_ || column >= num_col_text_ids_) {
+        return NULL;
+    }
+    if (col_text_ids_[column] != 0) {
+        return (const char *) g_ptr_array_index(string_table_, col_text_ids_[column]);
+    }
+    QList<QByteArray> *uncached_col_text = uncached_col_text_.object(this);
+    if (uncached_col_text && column < uncached_col_text->size()) {
+        return uncached_col_text->at(column).constData();
+    }
+    return NULL;
+}
+
+void PacketListRecord::invalidateAllRecords()
+{
+    col_data_ver_++;
+    // Records check data_ver_ before looking up their string IDs, so none
+    // of the old IDs are used again. Dropping the strings keeps stale text
+    // from using up unique_text_budget_.
+    clearStringPool();
 }
 
 void PacketListRecord::resetColumns(column_info *cinfo)
@@ -103,8 +119,16 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     wtap_rec rec; /* Record metadata */
     Buffer buf;   /* Record data */
 
-    if (!col_text_) col_text_ = new ColumnTextList;
-    gboolean dissect_columns = col_text_->isEmpty() || data_ver_ != col_data_ver_;
+    gboolean dissect_columns = !col_text_ids_ || data_ver_ != col_data_ver_;
+    if (!dissect_columns && !uncached_col_text_.contains(this)) {
+        // Regenerate columns that weren't cached.
+        for (int column = 0; column < num_col_text_ids_; column++) {
+            if (col_text_ids_[column] == 0) {
+                dissect_columns = TRUE;
+                break;
+            }
+        }
+    }
 
     if (!cap_file) {
         return;
@@ -198,12 +222,82 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
 // This assumes only one packet list. We might want to move this to
 // PacketListModel (or replace this with a wmem allocator).
 struct _GStringChunk *PacketListRecord::string_pool_ = g_string_chunk_new(1 * 1024 * 1024);
+struct _GHashTable *PacketListRecord::string_ids_ = g_hash_table_new(g_str_hash, g_str_equal);
+struct _GPtrArray *PacketListRecord::string_table_ = NULL;
+gsize PacketListRecord::interned_bytes_ = 0;
+gsize PacketListRecord::unique_bytes_ = 0;
+QCache<PacketListRecord *, QList<QByteArray> > PacketListRecord::uncached_col_text_(4 * 1024 * 1024);
+
+// Most column strings, including short Info strings, repeat often enough
+// that storing each one once pays off. Longer strings are nearly always
+// unique, so they skip the hash table. Keep up to unique_text_budget_
+// bytes of them; beyond that, the text of the most recently dissected
+// records is kept in uncached_col_text_ and the rest are regenerated by
+// dissecting the packet again when needed.
+static const gsize intern_max_len_ = 64;
+static const gsize unique_text_budget_ = 256 * 1024 * 1024;
+
 void PacketListRecord::clearStringPool()
 {
     g_string_chunk_clear(string_pool_);
+    g_hash_table_remove_all(string_ids_);
+    if (string_table_) {
+        g_ptr_array_set_size(string_table_, 0);
+    } else {
+        string_table_ = g_ptr_array_sized_new(64 * 1024);
+    }
+    // ID 0 means "not cached".
+    g_ptr_array_add(string_table_, NULL);
+    interned_bytes_ = 0;
+    unique_bytes_ = 0;
+    uncached_col_text_.clear();
+}
+
+gsize PacketListRecord::stringPoolSize()
+{
+    gsize size = interned_bytes_ + unique_bytes_ + uncached_col_text_.totalCost();
+
+    if (string_table_) {
+        size += string_table_->len * sizeof(gpointer);
+    }
+    // Approximately: a hash, key and value per hash table entry.
+    size += g_hash_table_size(string_ids_) * (sizeof(guint) + 2 * sizeof(gpointer));
+    return size;
+}
+
+guint32 PacketListRecord::internColumnString(const char *col_str)
+{
+    gpointer id_ptr;
+
+    if (g_hash_table_lookup_extended(string_ids_, col_str, NULL, &id_ptr)) {
+        return GPOINTER_TO_UINT(id_ptr);
+    }
+
+    gchar *str = g_string_chunk_insert(string_pool_, col_str);
+    guint32 id = string_table_->len;
+
+    g_ptr_array_add(string_table_, str);
+    g_hash_table_insert(string_ids_, str, GUINT_TO_POINTER(id));
+    interned_bytes_ += strlen(str) + 1;
+    return id;
+}
+
+guint32 PacketListRecord::addUniqueColumnString(const char *col_str)
+{
+    gsize len = strlen(col_str) + 1;
+
+    if (unique_bytes_ + len > unique_text_budget_) {
+        return 0;
+    }
+
+    gchar *str = g_string_chunk_insert_len(string_pool_, col_str, len - 1);
+    guint32 id = string_table_->len;
+
+    g_ptr_array_add(string_table_, str);
+    unique_bytes_ += len;
+    return id;
 }
 
-//#define MINIMIZE_STRING_COPYING 1
 void PacketListRecord::cacheColumnStrings(column_info *cinfo)
 {
     // packet_list_store.c:packet_list_change_record(PacketList *packet_list, PacketListRecord *record, gint col, column_info *cinfo)
@@ -211,74 +305,21 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         return;
     }
 
-    if (col_text_) {
-        col_text_->clear();
-    } else {
-        col_text_ = new ColumnTextList;
+    if (!string_table_) {
+        clearStringPool();
+    }
+
+    if (!col_text_ids_ || num_col_text_ids_ != cinfo->num_cols) {
+        col_text_ids_ = wmem_alloc0_array(wmem_file_scope(), guint32, cinfo->num_cols);
+        num_col_text_ids_ = cinfo->num_cols;
     }
     lines_ = 1;
     line_count_changed_ = false;
 
+    QList<QByteArray> uncached_col_text;
     for (int column = 0; column < cinfo->num_cols; ++column) {
         int col_lines = 1;
 
-#ifdef MINIMIZE_STRING_COPYING
-        int text_col = cinfo_column_.value(column, -1);
-
-        /* Column based on frame_data or it already contains a value */
-        if (text_col < 0) {
-            col_fill_in_frame_data(fdata_, cinfo, column, FALSE);
-            col_text_->append(cinfo->columns[column].col_data);
-            continue;
-        }
-
-        switch (cinfo->col_fmt[column]) {
-        case COL_PROTOCOL:
-        case COL_INFO:
-        case COL_IF_DIR:
-        case COL_DCE_CALL:
-        case COL_8021Q_VLAN_ID:
-        case COL_EXPERT:
-        case COL_FREQ_CHAN:
-            if (cinfo->columns[column].col_data && cinfo->columns[column].col_data != cinfo->columns[column].col_buf) {
-                /* This is a constant string, so we don't have to copy it */
-                // XXX - ui/gtk/packet_list_store.c uses G_MAXUSHORT. We don't do proper UTF8
-                // truncation in either case.
-                int col_text_len = MIN(qstrlen(cinfo->col_data[column]) + 1, COL_MAX_INFO_LEN);
-                col_text_->append(QByteArray::fromRawData(cinfo->columns[column].col_data, col_text_len));
-                break;
-            }
-            /* !! FALL-THROUGH!! */
-
-        case COL_DEF_SRC:
-        case COL_RES_SRC:        /* COL_DEF_SRC is currently just like COL_RES_SRC */
-        case COL_UNRES_SRC:
-        case COL_DEF_DL_SRC:
-        case COL_RES_DL_SRC:
-        case COL_UNRES_DL_SRC:
-        case COL_DEF_NET_SRC:
-        case COL_RES_NET_SRC:
-        case COL_UNRES_NET_SRC:
-        case COL_DEF_DST:
-        case COL_RES_DST:        /* COL_DEF_DST is currently just like COL_RES_DST */
-        case COL_UNRES_DST:
-        case COL_DEF_DL_DST:
-        case COL_RES_DL_DST:
-        case COL_UNRES_DL_DST:
-        case COL_DEF_NET_DST:
-        case COL_RES_NET_DST:
-        case COL_UNRES_NET_DST:
-        default:
-            if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
-                /* Use the unresolved value in col_expr_val */
-                // XXX Use QContiguousCache?
-                col_text_->append(cinfo->col_expr.col_expr_val[column]);
-            } else {
-                col_text_->append(cinfo->columns[column].col_data);
-            }
-            break;
-        }
-#else // MINIMIZE_STRING_COPYING
         const char *col_str;
         if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
             /* Use the unresolved value in col_expr_val */
@@ -291,12 +332,19 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
             }
             col_str = cinfo->columns[column].col_data;
         }
-        // g_string_chunk_insert_const manages a hash table of pointers to
-        // strings:
-        // https://git.gnome.org/browse/glib/tree/glib/gstringchunk.c
-        // We might be better off adding the equivalent functionality to
-        // wmem_tree.
-        col_text_->append(g_string_chunk_insert_const(string_pool_, col_str));
+
+        if (strlen(col_str) < intern_max_len_) {
+            col_text_ids_[column] = internColumnString(col_str);
+        } else {
+            col_text_ids_[column] = addUniqueColumnString(col_str);
+        }
+        if (col_text_ids_[column] == 0) {
+            while (uncached_col_text.size() < column) {
+                uncached_col_text << QByteArray();
+            }
+            uncached_col_text << QByteArray(col_str);
+        }
+
         for (int i = 0; col_str[i]; i++) {
             if (col_str[i] == '\n') col_lines++;
         }
@@ -304,7 +352,16 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
             lines_ = col_lines;
             line_count_changed_ = true;
         }
-#endif // MINIMIZE_STRING_COPYING
+    }
+
+    if (!uncached_col_text.isEmpty()) {
+        int cost = 0;
+        foreach (const QByteArray &col_text, uncached_col_text) {
+            cost += col_text.size() + 1;
+        }
+        uncached_col_text_.insert(this, new QList<QByteArray>(uncached_col_text), cost);
+    } else {
+        uncached_col_text_.remove(this);
     }
 }
 
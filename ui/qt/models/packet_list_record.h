@@ -20,13 +20,14 @@
 #include <epan/packet.h>
 
 #include <QByteArray>
+#include <QCache>
 #include <QList>
 #include <QVariant>
 
 struct conversation;
 struct _GStringChunk;
-
-class ColumnTextList;
+struct _GHashTable;
+struct _GPtrArray;
 
 class PacketListRecord
 {
@@ -39,6 +40,15 @@ public:
 
     // Return the string value for a column. Data is cached if possible.
     const QByteArray columnString(capture_file *cap_file, int column, bool colorized = false);
+    // Same as columnString, but returns the cached string itself (or NULL).
+    // Equal strings share the same pointer until clearStringPool is called.
+    // Strings of columns that aren't cached (see columnIsCached) are only
+    // valid until another record is dissected.
+    const char *columnCString(capture_file *cap_file, int column, bool colorized = false);
+    bool columnIsCached(int column) const {
+        return col_text_ids_ && data_ver_ == col_data_ver_ &&
+                column >= 0 && column < num_col_text_ids_ && col_text_ids_[column] != 0;
+    }
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
@@ -46,17 +56,22 @@ public:
     struct conversation *conversation() { return conv_; }
 
     int columnTextSize(const char *str);
-    static void invalidateAllRecords() { col_data_ver_++; }
+    // Every record has to be dissected again, so this also empties the
+    // string pool.
+    static void invalidateAllRecords();
     static void resetColumns(column_info *cinfo);
     void resetColorized();
     inline int lineCount() { return lines_; }
     inline int lineCountChanged() { return line_count_changed_; }
 
     static void clearStringPool();
+    // Memory used by the column text of all records, in bytes.
+    static gsize stringPoolSize();
 
 private:
-    /** The column text for some columns */
-    ColumnTextList *col_text_;
+    /** The column text, as IDs into string_table_. 0 means not cached. */
+    guint32 *col_text_ids_;
+    int num_col_text_ids_;
 
     frame_data *fdata_;
     int lines_;
@@ -74,8 +89,21 @@ private:
 
     void dissect(capture_file *cap_file, bool dissect_color = false);
     void cacheColumnStrings(column_info *cinfo);
+    static guint32 internColumnString(const char *col_str);
+    static guint32 addUniqueColumnString(const char *col_str);
 
+    /** Column text shared by all records */
     static struct _GStringChunk *string_pool_;
+    /** Maps interned strings to their IDs */
+    static struct _GHashTable *string_ids_;
+    /** Maps IDs to strings */
+    static struct _GPtrArray *string_table_;
+    static gsize interned_bytes_;
+    static gsize unique_bytes_;
+
+    /** Text of the columns that didn't fit in the string pool, for the
+     * most recently dissected records. The cost is in bytes. */
+    static QCache<PacketListRecord *, QList<QByteArray> > uncached_col_text_;
 
 };
 
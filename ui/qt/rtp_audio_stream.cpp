@@ -225,13 +225,9 @@ void RtpAudioStream::decode()
 
         if (audio_out_rate_ == 0) {
             // Use the first non-zero rate we find. Ajust it to match our audio hardware.
-            QAudioDeviceInfo cur_out_device = QAudioDeviceInfo::defaultOutputDevice();
-            QString cur_out_name = parent()->property("currentOutputDeviceName").toString();
-            foreach (QAudioDeviceInfo out_device, QAudioDeviceInfo::availableDevices(QAudio::AudioOutput)) {
-                if (cur_out_name == out_device.deviceName()) {
-                    cur_out_device = out_device;
-                }
-            }
+            // We might be running on a decoder thread, so use the device our
+            // dialog looked up instead of enumerating devices here.
+            QAudioDeviceInfo cur_out_device = out_device_.isNull() ? QAudioDeviceInfo::defaultOutputDevice() : out_device_;
 
             QAudioFormat format;
             format.setSampleRate(sample_rate);
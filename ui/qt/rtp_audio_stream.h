@@ -20,6 +20,7 @@
 #include <ui/rtp_stream.h>
 
 #include <QAudio>
+#include <QAudioDeviceInfo>
 #include <QColor>
 #include <QMap>
 #include <QObject>
@@ -46,6 +47,11 @@ public:
     //void addRtpStream(const rtpstream_info_t *rtpstream);
     void addRtpPacket(const struct _packet_info *pinfo, const struct _rtp_info *rtp_info);
     void reset(double start_rel_time);
+    /**
+     * @brief Decode and resample the stream into its temporary file and
+     * build its waveform. Touches only this stream, so different streams
+     * may be decoded on different threads.
+     */
     void decode();
 
     double startRelTime() const { return start_rel_time_; }
@@ -127,6 +133,8 @@ public:
 
     void setJitterBufferSize(int jitter_buffer_size) { jitter_buffer_size_ = jitter_buffer_size; }
     void setTimingMode(TimingMode timing_mode) { timing_mode_ = timing_mode; }
+    // Device used to pick the output sample rate when decoding.
+    void setOutputDevice(const QAudioDeviceInfo &out_device) { out_device_ = out_device; }
 
 signals:
     void startedPlaying();
@@ -168,6 +176,7 @@ private:
 
     int jitter_buffer_size_;
     TimingMode timing_mode_;
+    QAudioDeviceInfo out_device_;
 
     void writeSilence(int samples);
     const QString formatDescription(const QAudioFormat & format);
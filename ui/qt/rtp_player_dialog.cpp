@@ -13,6 +13,7 @@
 #ifdef QT_MULTIMEDIA_LIB
 
 #include <epan/dissectors/packet-rtp.h>
+#include <epan/rtp_pt.h>
 
 #include <wsutil/report_message.h>
 #include <wsutil/utf8_entities.h>
@@ -32,6 +33,7 @@
 #endif // QT_MULTIMEDIA_LIB
 
 #include <QPushButton>
+#include <QThread>
 
 #include <ui/qt/utils/stock_icon.h>
 #include "wireshark_application.h"
@@ -86,6 +88,42 @@ enum {
 #ifdef QT_MULTIMEDIA_LIB
 static const double wf_graph_normal_width_ = 0.5;
 static const double wf_graph_selected_width_ = 2.0;
+
+// Takes streams off the dialog's queue and decodes them. Each stream owns
+// its decoders, resamplers and temporary file, so streams can be decoded
+// independently. Results are handed back to the GUI thread one stream at
+// a time.
+class RtpDecodeThread : public QThread
+{
+public:
+    RtpDecodeThread(QObject *dialog, const QList<RtpAudioStream *> &queue,
+                    QAtomicInt &next, QAtomicInt &abort, int generation) :
+        dialog_(dialog),
+        queue_(queue),
+        next_(next),
+        abort_(abort),
+        generation_(generation)
+    {}
+
+protected:
+    virtual void run() {
+        int idx;
+        while (!abort_.load() && (idx = next_.fetchAndAddOrdered(1)) < queue_.size()) {
+            RtpAudioStream *audio_stream = queue_[idx];
+            QObject *stream_obj = audio_stream;
+            audio_stream->decode();
+            QMetaObject::invokeMethod(dialog_, "streamDecoded", Qt::QueuedConnection,
+                                      Q_ARG(QObject *, stream_obj), Q_ARG(int, generation_));
+        }
+    }
+
+private:
+    QObject *dialog_;
+    const QList<RtpAudioStream *> queue_;
+    QAtomicInt &next_;
+    QAtomicInt &abort_;
+    int generation_;
+};
 #endif
 
 RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf) :
@@ -93,6 +131,8 @@ RtpPlayerDialog::RtpPlayerDialog(QWidget &parent, CaptureFile &cf) :
 #ifdef QT_MULTIMEDIA_LIB
     , ui(new Ui::RtpPlayerDialog)
     , start_rel_time_(0.0)
+    , decode_generation_(0)
+    , rescale_pending_(false)
 #endif // QT_MULTIMEDIA_LIB
 {
     ui->setupUi(this);
@@ -184,6 +224,7 @@ QPushButton *RtpPlayerDialog::addPlayerButton(QDialogButtonBox *button_box)
 #ifdef QT_MULTIMEDIA_LIB
 RtpPlayerDialog::~RtpPlayerDialog()
 {
+    cancelDecode();
     delete ui;
 }
 
@@ -214,141 +255,261 @@ void RtpPlayerDialog::retapPackets()
         g_string_free(error_string, TRUE);
         return;
     }
+    cancelDecode();
     cap_file_.retapPackets();
     remove_tap_listener(this);
 
+    // New packets, so nothing we decoded before is valid.
+    decode_key_.clear();
     rescanPackets(true);
 }
 
 void RtpPlayerDialog::rescanPackets(bool rescale_axes)
 {
+    cancelDecode();
+
     int row_count = ui->streamTreeWidget->topLevelItemCount();
-    // Clear existing graphs and reset stream values
+    // Clear existing graphs
     for (int row = 0; row < row_count; row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
-        RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
-        audio_stream->reset(start_rel_time_);
-
         ti->setData(graph_data_col_, Qt::UserRole, QVariant());
     }
     ui->audioPlot->clearGraphs();
+    ui->audioPlot->legend->setVisible(false);
 
-    bool show_legend = false;
     bool relative_timestamps = !ui->todCheckBox->isChecked();
 
     ui->audioPlot->xAxis->setTickLabelType(relative_timestamps ? QCPAxis::ltNumber : QCPAxis::ltDateTime);
 
+    RtpAudioStream::TimingMode timing_mode = RtpAudioStream::JitterBuffer;
+    switch (ui->timingComboBox->currentIndex()) {
+    case RtpAudioStream::RtpTimestamp:
+        timing_mode = RtpAudioStream::RtpTimestamp;
+        break;
+    case RtpAudioStream::Uninterrupted:
+        timing_mode = RtpAudioStream::Uninterrupted;
+        break;
+    default:
+        break;
+    }
+
+    // Switching between relative and absolute time only changes how we
+    // draw the streams.
+    QString decode_key = QString("%1 %2 %3")
+            .arg(ui->jitterSpinBox->value())
+            .arg(timing_mode)
+            .arg(currentOutputDeviceName());
+    if (decode_key == decode_key_) {
+        for (int row = 0; row < row_count; row++) {
+            plotStream(ui->streamTreeWidget->topLevelItem(row), row);
+        }
+        rescale_pending_ = rescale_axes;
+        finishRescan();
+        return;
+    }
+    decode_key_ = decode_key;
+
+    QAudioDeviceInfo cur_out_device = QAudioDeviceInfo::defaultOutputDevice();
+    QString cur_out_name = currentOutputDeviceName();
+    foreach (QAudioDeviceInfo out_device, QAudioDeviceInfo::availableDevices(QAudio::AudioOutput)) {
+        if (cur_out_name == out_device.deviceName()) {
+            cur_out_device = out_device;
+        }
+    }
+
+    // Decode the streams shown in the stream list first.
+    QList<RtpAudioStream *> decode_queue;
+    QList<RtpAudioStream *> hidden_streams;
+    QRect visible_rect = ui->streamTreeWidget->viewport()->rect();
     for (int row = 0; row < row_count; row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
         RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
-        int y_offset = row_count - row - 1;
 
+        audio_stream->reset(start_rel_time_);
         audio_stream->setJitterBufferSize((int) ui->jitterSpinBox->value());
+        audio_stream->setTimingMode(timing_mode);
+        audio_stream->setOutputDevice(cur_out_device);
 
-        RtpAudioStream::TimingMode timing_mode = RtpAudioStream::JitterBuffer;
-        switch (ui->timingComboBox->currentIndex()) {
-        case RtpAudioStream::RtpTimestamp:
-            timing_mode = RtpAudioStream::RtpTimestamp;
-            break;
-        case RtpAudioStream::Uninterrupted:
-            timing_mode = RtpAudioStream::Uninterrupted;
-            break;
-        default:
+        // Don't let a stream play while its audio is being rewritten.
+        disconnect(ui->playButton, SIGNAL(clicked(bool)), audio_stream, SLOT(startPlaying()));
+        decoding_streams_ << audio_stream;
+
+        if (ui->streamTreeWidget->visualItemRect(ti).intersects(visible_rect)) {
+            decode_queue << audio_stream;
+        } else {
+            hidden_streams << audio_stream;
+        }
+    }
+    decode_queue += hidden_streams;
+    rescale_pending_ = rescale_axes;
+
+    if (decode_queue.isEmpty()) {
+        finishRescan();
+        return;
+    }
+
+    // value_string_ext lookups initialize themselves on first use. Do that
+    // here rather than racing on it in the decoder threads.
+    try_val_to_str_ext(0, &rtp_payload_type_short_vals_ext);
+
+    int thread_count = qBound(1, QThread::idealThreadCount(), decode_queue.size());
+    decode_next_.store(0);
+    decode_abort_.store(0);
+    for (int i = 0; i < thread_count; i++) {
+        RtpDecodeThread *decode_thread = new RtpDecodeThread(this, decode_queue, decode_next_, decode_abort_, decode_generation_);
+        decode_threads_ << decode_thread;
+        decode_thread->start();
+    }
+
+    updateWidgets();
+}
+
+void RtpPlayerDialog::streamDecoded(QObject *stream_obj, int generation)
+{
+    RtpAudioStream *audio_stream = qobject_cast<RtpAudioStream *>(stream_obj);
+    if (generation != decode_generation_ || !decoding_streams_.remove(audio_stream)) return;
+
+    for (int row = 0; row < ui->streamTreeWidget->topLevelItemCount(); row++) {
+        QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
+        if (ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>() == audio_stream) {
+            plotStream(ti, row);
             break;
         }
-        audio_stream->setTimingMode(timing_mode);
+    }
+    connect(ui->playButton, SIGNAL(clicked(bool)), audio_stream, SLOT(startPlaying()), Qt::UniqueConnection);
+
+    if (decoding_streams_.isEmpty()) {
+        finishRescan();
+    } else {
+        ui->audioPlot->replot();
+    }
+}
 
-        audio_stream->decode();
-
-        // Waveform
-        QCPGraph *audio_graph = ui->audioPlot->addGraph();
-        QPen wf_pen(audio_stream->color());
-        wf_pen.setWidthF(wf_graph_normal_width_);
-        audio_graph->setPen(wf_pen);
-        wf_pen.setWidthF(wf_graph_selected_width_);
-        audio_graph->setSelectedPen(wf_pen);
-        audio_graph->setSelectable(false);
-        audio_graph->setData(audio_stream->visualTimestamps(relative_timestamps), audio_stream->visualSamples(y_offset));
-        audio_graph->removeFromLegend();
-        ti->setData(graph_data_col_, Qt::UserRole, QVariant::fromValue<QCPGraph *>(audio_graph));
-        RTP_STREAM_DEBUG("Plotting %s, %d samples", ti->text(src_addr_col_).toUtf8().constData(), audio_graph->data()->keys().length());
-
-        QString span_str = QString("%1 - %2 (%3)")
-                .arg(QString::number(audio_stream->startRelTime(), 'g', 3))
-                .arg(QString::number(audio_stream->stopRelTime(), 'g', 3))
-                .arg(QString::number(audio_stream->stopRelTime() - audio_stream->startRelTime(), 'g', 3));
-        ti->setText(time_span_col_, span_str);
-        ti->setText(sample_rate_col_, QString::number(audio_stream->sampleRate()));
-        ti->setText(payload_col_, audio_stream->payloadNames().join(", "));
-
-        if (audio_stream->outOfSequence() > 0) {
-            // Sequence numbers
-            QCPGraph *seq_graph = ui->audioPlot->addGraph();
-            seq_graph->setLineStyle(QCPGraph::lsNone);
-            seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssSquare, tango_aluminium_6, Qt::white, 4)); // Arbitrary
-            seq_graph->setSelectable(false);
-            seq_graph->setData(audio_stream->outOfSequenceTimestamps(relative_timestamps), audio_stream->outOfSequenceSamples(y_offset));
-            if (row < 1) {
-                seq_graph->setName(tr("Out of Sequence"));
-                show_legend = true;
-            } else {
-                seq_graph->removeFromLegend();
-            }
+// Stop the decoder threads. Streams that were not finished are left
+// undecoded and the next rescan decodes everything again.
+void RtpPlayerDialog::cancelDecode()
+{
+    decode_generation_++;
+    if (decode_threads_.isEmpty()) return;
+
+    decode_abort_.store(1);
+    foreach (RtpDecodeThread *decode_thread, decode_threads_) {
+        decode_thread->wait();
+        delete decode_thread;
+    }
+    decode_threads_.clear();
+    if (!decoding_streams_.isEmpty()) {
+        decode_key_.clear();
+    }
+    decoding_streams_.clear();
+}
+
+// Add the graphs for a decoded stream. Returns true if the legend should be shown.
+bool RtpPlayerDialog::plotStream(QTreeWidgetItem *ti, int row)
+{
+    RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
+    int y_offset = ui->streamTreeWidget->topLevelItemCount() - row - 1;
+    bool relative_timestamps = !ui->todCheckBox->isChecked();
+    bool show_legend = false;
+
+    // Waveform
+    QCPGraph *audio_graph = ui->audioPlot->addGraph();
+    QPen wf_pen(audio_stream->color());
+    wf_pen.setWidthF(wf_graph_normal_width_);
+    audio_graph->setPen(wf_pen);
+    wf_pen.setWidthF(wf_graph_selected_width_);
+    audio_graph->setSelectedPen(wf_pen);
+    audio_graph->setSelectable(false);
+    audio_graph->setData(audio_stream->visualTimestamps(relative_timestamps), audio_stream->visualSamples(y_offset));
+    audio_graph->removeFromLegend();
+    ti->setData(graph_data_col_, Qt::UserRole, QVariant::fromValue<QCPGraph *>(audio_graph));
+    RTP_STREAM_DEBUG("Plotting %s, %d samples", ti->text(src_addr_col_).toUtf8().constData(), audio_graph->data()->keys().length());
+
+    QString span_str = QString("%1 - %2 (%3)")
+            .arg(QString::number(audio_stream->startRelTime(), 'g', 3))
+            .arg(QString::number(audio_stream->stopRelTime(), 'g', 3))
+            .arg(QString::number(audio_stream->stopRelTime() - audio_stream->startRelTime(), 'g', 3));
+    ti->setText(time_span_col_, span_str);
+    ti->setText(sample_rate_col_, QString::number(audio_stream->sampleRate()));
+    ti->setText(payload_col_, audio_stream->payloadNames().join(", "));
+
+    if (audio_stream->outOfSequence() > 0) {
+        // Sequence numbers
+        QCPGraph *seq_graph = ui->audioPlot->addGraph();
+        seq_graph->setLineStyle(QCPGraph::lsNone);
+        seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssSquare, tango_aluminium_6, Qt::white, 4)); // Arbitrary
+        seq_graph->setSelectable(false);
+        seq_graph->setData(audio_stream->outOfSequenceTimestamps(relative_timestamps), audio_stream->outOfSequenceSamples(y_offset));
+        if (row < 1) {
+            seq_graph->setName(tr("Out of Sequence"));
+            show_legend = true;
+        } else {
+            seq_graph->removeFromLegend();
         }
+    }
 
-        if (audio_stream->jitterDropped() > 0) {
-            // Jitter drops
-            QCPGraph *seq_graph = ui->audioPlot->addGraph();
-            seq_graph->setLineStyle(QCPGraph::lsNone);
-            seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, tango_scarlet_red_5, Qt::white, 4)); // Arbitrary
-            seq_graph->setSelectable(false);
-            seq_graph->setData(audio_stream->jitterDroppedTimestamps(relative_timestamps), audio_stream->jitterDroppedSamples(y_offset));
-            if (row < 1) {
-                seq_graph->setName(tr("Jitter Drops"));
-                show_legend = true;
-            } else {
-                seq_graph->removeFromLegend();
-            }
+    if (audio_stream->jitterDropped() > 0) {
+        // Jitter drops
+        QCPGraph *seq_graph = ui->audioPlot->addGraph();
+        seq_graph->setLineStyle(QCPGraph::lsNone);
+        seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, tango_scarlet_red_5, Qt::white, 4)); // Arbitrary
+        seq_graph->setSelectable(false);
+        seq_graph->setData(audio_stream->jitterDroppedTimestamps(relative_timestamps), audio_stream->jitterDroppedSamples(y_offset));
+        if (row < 1) {
+            seq_graph->setName(tr("Jitter Drops"));
+            show_legend = true;
+        } else {
+            seq_graph->removeFromLegend();
         }
+    }
 
-        if (audio_stream->wrongTimestamps() > 0) {
-            // Wrong timestamps
-            QCPGraph *seq_graph = ui->audioPlot->addGraph();
-            seq_graph->setLineStyle(QCPGraph::lsNone);
-            seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDiamond, tango_sky_blue_5, Qt::white, 4)); // Arbitrary
-            seq_graph->setSelectable(false);
-            seq_graph->setData(audio_stream->wrongTimestampTimestamps(relative_timestamps), audio_stream->wrongTimestampSamples(y_offset));
-            if (row < 1) {
-                seq_graph->setName(tr("Wrong Timestamps"));
-                show_legend = true;
-            } else {
-                seq_graph->removeFromLegend();
-            }
+    if (audio_stream->wrongTimestamps() > 0) {
+        // Wrong timestamps
+        QCPGraph *seq_graph = ui->audioPlot->addGraph();
+        seq_graph->setLineStyle(QCPGraph::lsNone);
+        seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDiamond, tango_sky_blue_5, Qt::white, 4)); // Arbitrary
+        seq_graph->setSelectable(false);
+        seq_graph->setData(audio_stream->wrongTimestampTimestamps(relative_timestamps), audio_stream->wrongTimestampSamples(y_offset));
+        if (row < 1) {
+            seq_graph->setName(tr("Wrong Timestamps"));
+            show_legend = true;
+        } else {
+            seq_graph->removeFromLegend();
         }
+    }
 
-        if (audio_stream->insertedSilences() > 0) {
-            // Inserted silence
-            QCPGraph *seq_graph = ui->audioPlot->addGraph();
-            seq_graph->setLineStyle(QCPGraph::lsNone);
-            seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, tango_butter_5, Qt::white, 4)); // Arbitrary
-            seq_graph->setSelectable(false);
-            seq_graph->setData(audio_stream->insertedSilenceTimestamps(relative_timestamps), audio_stream->insertedSilenceSamples(y_offset));
-            if (row < 1) {
-                seq_graph->setName(tr("Inserted Silence"));
-                show_legend = true;
-            } else {
-                seq_graph->removeFromLegend();
-            }
+    if (audio_stream->insertedSilences() > 0) {
+        // Inserted silence
+        QCPGraph *seq_graph = ui->audioPlot->addGraph();
+        seq_graph->setLineStyle(QCPGraph::lsNone);
+        seq_graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, tango_butter_5, Qt::white, 4)); // Arbitrary
+        seq_graph->setSelectable(false);
+        seq_graph->setData(audio_stream->insertedSilenceTimestamps(relative_timestamps), audio_stream->insertedSilenceSamples(y_offset));
+        if (row < 1) {
+            seq_graph->setName(tr("Inserted Silence"));
+            show_legend = true;
+        } else {
+            seq_graph->removeFromLegend();
         }
     }
-    ui->audioPlot->legend->setVisible(show_legend);
+    if (show_legend) {
+        ui->audioPlot->legend->setVisible(true);
+    }
+    return show_legend;
+}
+
+void RtpPlayerDialog::finishRescan()
+{
+    // Join the finished decoder threads.
+    cancelDecode();
 
     for (int col = 0; col < ui->streamTreeWidget->columnCount() - 1; col++) {
         ui->streamTreeWidget->resizeColumnToContents(col);
     }
 
     ui->audioPlot->replot();
-    if (rescale_axes) resetXAxis();
+    if (rescale_pending_) resetXAxis();
+    rescale_pending_ = false;
 
     updateWidgets();
 }
@@ -725,6 +886,7 @@ int RtpPlayerDialog::getHoveredPacket()
     if (!ti) return 0;
 
     RtpAudioStream *audio_stream = ti->data(src_addr_col_, Qt::UserRole).value<RtpAudioStream*>();
+    if (decoding_streams_.contains(audio_stream)) return 0;
 
     double ts = ui->audioPlot->xAxis->pixelToCoord(ui->audioPlot->mapFromGlobal(QCursor::pos()).x());
 
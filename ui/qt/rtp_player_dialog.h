@@ -18,7 +18,10 @@
 
 #include "wireshark_dialog.h"
 
+#include <QAtomicInt>
+#include <QList>
 #include <QMap>
+#include <QSet>
 
 namespace Ui {
 class RtpPlayerDialog;
@@ -27,7 +30,9 @@ class RtpPlayerDialog;
 class QCPItemStraightLine;
 class QDialogButtonBox;
 class QMenu;
+class QTreeWidgetItem;
 class RtpAudioStream;
+class RtpDecodeThread;
 
 class RtpPlayerDialog : public WiresharkDialog
 {
@@ -76,9 +81,11 @@ private slots:
      * streams added using ::addRtpStream.
      */
     void retapPackets();
-    /** Clear, decode, and redraw each stream.
+    /** Clear, decode, and redraw each stream. Streams are decoded in the
+     * background and drawn as they finish.
      */
     void rescanPackets(bool rescale_axes = false);
+    void streamDecoded(QObject *stream_obj, int generation);
     void updateWidgets();
     void graphClicked(QMouseEvent *event);
     void updateHintLabel();
@@ -113,6 +120,15 @@ private:
     QCPItemStraightLine *cur_play_pos_;
     QString playback_error_;
 
+    // Decoded audio is kept until one of these settings changes.
+    QString decode_key_;
+    QList<RtpDecodeThread *> decode_threads_;
+    QSet<RtpAudioStream *> decoding_streams_;
+    QAtomicInt decode_next_;
+    QAtomicInt decode_abort_;
+    int decode_generation_;
+    bool rescale_pending_;
+
 //    const QString streamKey(const rtpstream_info_t *rtpstream);
 //    const QString streamKey(const packet_info *pinfo, const struct _rtp_info *rtpinfo);
 
@@ -122,6 +138,9 @@ private:
     static void tapDraw(void *tapinfo_ptr);
 
     void addPacket(packet_info *pinfo, const struct _rtp_info *rtpinfo);
+    void cancelDecode();
+    bool plotStream(QTreeWidgetItem *ti, int row);
+    void finishRescan();
     void zoomXAxis(bool in);
     void panXAxis(int x_pixels);
     double getLowestTimestamp();
@@ -109,6 +109,24 @@ int SequenceDiagram::adjacentPacket(bool next)
         return it.value().value->frame_number;
     }
 
+    if (selected_key_ >= 0) {
+        it = data_->constFind(selected_key_);
+        if (it != data_->constEnd() && it.value().value->frame_number == selected_packet_) {
+            if (next) {
+                ++it;
+            } else if (it != data_->constBegin()) {
+                --it;
+            } else {
+                return adjacent_packet;
+            }
+            if (it != data_->constEnd()) {
+                adjacent_packet = it.value().value->frame_number;
+                selected_key_ = it.value().key;
+            }
+            return adjacent_packet;
+        }
+    }
+
     if (next) {
         for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
             if (it.value().value->frame_number == selected_packet_) {
@@ -140,6 +158,7 @@ int SequenceDiagram::adjacentPacket(bool next)
 void SequenceDiagram::setData(_seq_analysis_info *sainfo)
 {
     data_->clear();
+    frame_keys_.clear();
     sainfo_ = sainfo;
     if (!sainfo) return;
 
@@ -158,6 +177,9 @@ void SequenceDiagram::setData(_seq_analysis_info *sainfo)
             new_data.key = cur_key;
             new_data.value = sai;
             data_->insertMulti(new_data.key, new_data);
+            if (!frame_keys_.contains(sai->frame_number)) {
+                frame_keys_.insert(sai->frame_number, cur_key);
+            }
 
             key_ticks.append(cur_key);
             key_labels.append(sai->time_str);
@@ -191,6 +213,8 @@ void SequenceDiagram::setSelectedPacket(int selected_packet)
     selected_key_ = -1;
     if (selected_packet > 0) {
         selected_packet_ = selected_packet;
+        // draw() only visits the visible rows.
+        selected_key_ = frame_keys_.value(selected_packet_, -1.0);
     } else {
         selected_packet_ = 0;
     }
@@ -239,8 +263,10 @@ void SequenceDiagram::draw(QCPPainter *painter)
     painter->restore();
     fg_pen = mainPen();
 
-    WSCPSeqDataMap::const_iterator it;
-    for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
+    // Only visit the rows in the visible range.
+    WSCPSeqDataMap::const_iterator it = data_->lowerBound(key_axis_->range().lower - 1.0);
+    WSCPSeqDataMap::const_iterator end_it = data_->upperBound(key_axis_->range().upper + 1.0);
+    for (; it != end_it; ++it) {
         double cur_key = it.key();
         seq_analysis_item_t *sai = it.value().value;
         QColor bg_color;
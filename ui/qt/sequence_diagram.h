@@ -16,6 +16,7 @@
 
 #include <epan/address.h>
 
+#include <QHash>
 #include <QObject>
 #include <QMultiMap>
 #include <ui/qt/widgets/qcustomplot.h>
@@ -55,7 +56,7 @@ public:
     struct _seq_analysis_item *itemForPosY(int ypos);
 
     // reimplemented virtual methods:
-    virtual void clearData() { data_->clear(); }
+    virtual void clearData() { data_->clear(); frame_keys_.clear(); }
     virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
 
 public slots:
@@ -72,6 +73,7 @@ private:
     QCPAxis *value_axis_;
     QCPAxis *comment_axis_;
     WSCPSeqDataMap *data_;
+    QHash<guint32, double> frame_keys_; // First key for each frame number
     struct _seq_analysis_info *sainfo_;
     guint32 selected_packet_;
     double selected_key_;
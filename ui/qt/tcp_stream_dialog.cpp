@@ -67,6 +67,12 @@ const double pkt_point_size_ = 3.0;
 // in zoom mode.
 const int min_zoom_pixels_ = 20;
 
+// Base graphs with more points than this are decimated to the visible
+// range. Each level of the decimation index summarizes lod_fanout_ entries
+// of the level below it.
+const int lod_min_points_ = 50000;
+const int lod_fanout_ = 4;
+
 const QString average_throughput_label_ = QObject::tr("Average Throughput (bits/s)");
 const QString round_trip_time_ms_label_ = QObject::tr("Round Trip Time (ms)");
 const QString segment_length_label_ = QObject::tr("Segment Length (B)");
@@ -325,6 +331,7 @@ TCPStreamDialog::TCPStreamDialog(QWidget *parent, capture_file *cf, tcp_graph_ty
     connect(sp, SIGNAL(axisClick(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)),
             this, SLOT(axisClicked(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)));
     connect(sp->yAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(transformYRange(QCPRange)));
+    connect(sp->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisRangeChanged(QCPRange)));
     disconnect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
     this->setResult(QDialog::Accepted);
 }
@@ -496,6 +503,7 @@ void TCPStreamDialog::fillGraph(bool reset_axes, bool set_focus)
 
     base_graph_->setLineStyle(QCPGraph::lsNone);
     tracer_->setGraph(NULL);
+    setBaseGraphData(QVector<double>(), QVector<double>());
 
     // base_graph_ is always visible.
     for (int i = 0; i < sp->graphCount(); i++) {
@@ -593,10 +601,12 @@ void TCPStreamDialog::fillGraph(bool reset_axes, bool set_focus)
             .arg(gchar_free_to_qstring(format_size(pkts_rev, format_size_unit_none|format_size_prefix_si)))
             .arg(gchar_free_to_qstring(format_size(bytes_rev, format_size_unit_bytes|format_size_prefix_si)));
     mouseMoved(NULL);
-    if (reset_axes)
+    if (reset_axes) {
         resetAxes();
-    else
+    } else {
+        decimateBaseGraph(sp->xAxis->range());
         sp->replot();
+    }
     // Throughput and Window Scale graphs can hide base_graph_
     if (base_graph_->visible())
         tracer_->setGraph(base_graph_);
@@ -737,6 +747,128 @@ void TCPStreamDialog::resetAxes()
     sp->replot();
 }
 
+// Set base_graph_'s data. If there are many points and the keys are in
+// order, draw the graph from per-pixel min/max envelopes instead. The
+// envelope of the whole graph has the same bounds as the data itself, so
+// resetAxes() still works.
+void TCPStreamDialog::setBaseGraphData(const QVector<double> &keys, const QVector<double> &values)
+{
+    lod_keys_.clear();
+    lod_values_.clear();
+    lod_min_idx_.clear();
+    lod_max_idx_.clear();
+
+    int num_points = keys.size();
+    bool in_order = num_points >= lod_min_points_;
+    for (int i = 1; in_order && i < num_points; i++) {
+        if (keys[i] < keys[i - 1]) in_order = false;
+    }
+
+    if (!in_order) {
+        base_graph_->setData(keys, values);
+        return;
+    }
+
+    lod_keys_ = keys;
+    lod_values_ = values;
+
+    // Build the index bottom up. Level 0 summarizes the raw points.
+    int run = lod_fanout_;
+    while (run < num_points) {
+        int level = lod_min_idx_.size();
+        int num_runs = (num_points + run - 1) / run;
+        QVector<int> min_idx(num_runs), max_idx(num_runs);
+
+        for (int r = 0; r < num_runs; r++) {
+            int lo_i, hi_i;
+            if (level == 0) {
+                int first = r * run;
+                int last = qMin(first + run, num_points);
+                lo_i = hi_i = first;
+                for (int i = first + 1; i < last; i++) {
+                    if (values[i] < values[lo_i]) lo_i = i;
+                    if (values[i] > values[hi_i]) hi_i = i;
+                }
+            } else {
+                const QVector<int> &prev_min = lod_min_idx_[level - 1];
+                const QVector<int> &prev_max = lod_max_idx_[level - 1];
+                int first = r * lod_fanout_;
+                int last = qMin(first + lod_fanout_, prev_min.size());
+                lo_i = prev_min[first];
+                hi_i = prev_max[first];
+                for (int i = first + 1; i < last; i++) {
+                    if (values[prev_min[i]] < values[lo_i]) lo_i = prev_min[i];
+                    if (values[prev_max[i]] > values[hi_i]) hi_i = prev_max[i];
+                }
+            }
+            min_idx[r] = lo_i;
+            max_idx[r] = hi_i;
+        }
+        lod_min_idx_ << min_idx;
+        lod_max_idx_ << max_idx;
+        run *= lod_fanout_;
+    }
+
+    // Start with the envelope of the whole graph.
+    decimateBaseGraph(QCPRange(keys.first(), keys.last()));
+}
+
+// Replace base_graph_'s data with the points that matter in the visible
+// range: a few min/max pairs per pixel column plus the points just
+// outside the range so that lines run off the edges.
+void TCPStreamDialog::decimateBaseGraph(const QCPRange &range)
+{
+    if (lod_keys_.isEmpty()) return;
+
+    QCustomPlot *sp = ui->streamPlot;
+    int columns = qMax(sp->xAxis->axisRect()->width(), 1);
+
+    int first = (int) (std::lower_bound(lod_keys_.constBegin(), lod_keys_.constEnd(), range.lower) - lod_keys_.constBegin());
+    int last = (int) (std::upper_bound(lod_keys_.constBegin(), lod_keys_.constEnd(), range.upper) - lod_keys_.constBegin());
+    first = qMax(first - 1, 0);
+    last = qMin(last + 1, lod_keys_.size());
+
+    QVector<double> keys, values;
+
+    // Use the coarsest level whose runs are no wider than a pixel column.
+    int level = -1;
+    int run = 1;
+    while (level + 1 < lod_min_idx_.size() && run * lod_fanout_ <= (last - first) / columns) {
+        level++;
+        run *= lod_fanout_;
+    }
+
+    if (level < 0) {
+        keys = lod_keys_.mid(first, last - first);
+        values = lod_values_.mid(first, last - first);
+    } else {
+        const QVector<int> &min_idx = lod_min_idx_[level];
+        const QVector<int> &max_idx = lod_max_idx_[level];
+        int end_run = (last - 1) / run;
+
+        keys << lod_keys_[first];
+        values << lod_values_[first];
+        for (int r = first / run; r <= end_run; r++) {
+            int lo_i = qMin(min_idx[r], max_idx[r]);
+            int hi_i = qMax(min_idx[r], max_idx[r]);
+            if (lo_i > first && lo_i < last - 1) {
+                keys << lod_keys_[lo_i];
+                values << lod_values_[lo_i];
+            }
+            if (hi_i != lo_i && hi_i > first && hi_i < last - 1) {
+                keys << lod_keys_[hi_i];
+                values << lod_values_[hi_i];
+            }
+        }
+        if (last - 1 > first) {
+            keys << lod_keys_[last - 1];
+            values << lod_values_[last - 1];
+        }
+    }
+
+    base_graph_->setData(keys, values);
+}
+
 void TCPStreamDialog::fillStevens()
 {
     QString dlg_title = QString(tr("Sequence Numbers (Stevens)")) + streamDescription();
@@ -759,7 +891,7 @@ void TCPStreamDialog::fillStevens()
         rel_time.append(ts - ts_offset_);
         seq.append(seg->th_seq - seq_offset_);
     }
-    base_graph_->setData(rel_time, seq);
+    setBaseGraphData(rel_time, seq);
 }
 
 void TCPStreamDialog::fillTcptrace()
@@ -853,7 +985,7 @@ void TCPStreamDialog::fillTcptrace()
             rwin.append(ackno + seg->th_win);
         }
     }
-    base_graph_->setData(pkt_time, pkt_seqnums);
+    setBaseGraphData(pkt_time, pkt_seqnums);
     seg_graph_->setDataValueError(sb_time, sb_center, sb_span);
     ack_graph_->setData(ackrwin_time, ack);
     sack_graph_->setDataValueError(sack_time, sack_center, sack_span);
@@ -1282,7 +1414,7 @@ void TCPStreamDialog::fillThroughput()
             r_Xput_times.append(ts);
         }
     }
-    base_graph_->setData(seg_rel_times, seg_lens);
+    setBaseGraphData(seg_rel_times, seg_lens);
     tput_graph_->setData(tput_times, tputs);
     goodput_graph_->setData(gput_times, gputs);
 }
@@ -1482,7 +1614,7 @@ void TCPStreamDialog::fillRoundTripTime()
     }
     // it's possible there's still unacked segs - so be sure to free list!
     rtt_destroy_unack_list(&unack_list);
-    base_graph_->setData(x_vals, rtt);
+    setBaseGraphData(x_vals, rtt);
 }
 
 void TCPStreamDialog::fillWindowScale()
@@ -1535,7 +1667,7 @@ void TCPStreamDialog::fillWindowScale()
             }
         }
     }
-    base_graph_->setData(cwnd_time, cwnd_size);
+    setBaseGraphData(cwnd_time, cwnd_size);
     rwin_graph_->setData(rel_time, win_size);
     sp->yAxis->setLabel(window_size_label_);
 }
@@ -1792,6 +1924,11 @@ void TCPStreamDialog::transformYRange(const QCPRange &y_range1)
     sp->yAxis2->setRangeLower(yp2.y1());
 }
 
+void TCPStreamDialog::xAxisRangeChanged(const QCPRange &x_range)
+{
+    decimateBaseGraph(x_range);
+}
+
 void TCPStreamDialog::on_buttonBox_accepted()
 {
     QString file_name, extension;
@@ -107,6 +107,15 @@ private:
 
     double ma_window_size_;
 
+    // Full-resolution base_graph_ data for large graphs, which are drawn
+    // from min/max envelopes of the visible range. lod_min_idx_[l] and
+    // lod_max_idx_[l] hold the indices of the extreme values in each
+    // run of lod_fanout_^(l+1) points.
+    QVector<double> lod_keys_;
+    QVector<double> lod_values_;
+    QVector<QVector<int> > lod_min_idx_;
+    QVector<QVector<int> > lod_max_idx_;
+
     void findStream();
     void fillGraph(bool reset_axes = true, bool set_focus = true);
     void showWidgetsForGraphType();
@@ -120,6 +129,8 @@ private:
     void fillThroughput();
     void fillRoundTripTime();
     void fillWindowScale();
+    void setBaseGraphData(const QVector<double> &keys, const QVector<double> &values);
+    void decimateBaseGraph(const QCPRange &range);
     QString streamDescription();
     bool compareHeaders(struct segment *seg);
     void toggleTracerStyle(bool force_default = false);
@@ -131,6 +142,7 @@ private slots:
     void mouseMoved(QMouseEvent *event);
     void mouseReleased(QMouseEvent *event);
     void transformYRange(const QCPRange &y_range1);
+    void xAxisRangeChanged(const QCPRange &x_range);
     void on_buttonBox_accepted();
     void on_graphTypeComboBox_currentIndexChanged(int index);
     void on_resetButton_clicked();
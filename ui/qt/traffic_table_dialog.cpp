@@ -23,10 +23,12 @@
 #include <QClipboard>
 #include <QContextMenuEvent>
 #include <QDialogButtonBox>
+#include <QHeaderView>
 #include <QList>
 #include <QMap>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QSet>
 #include <QTabWidget>
 #include <QTreeWidget>
 #include <QTextStream>
@@ -351,6 +353,13 @@ TrafficTableTreeWidget::TrafficTableTreeWidget(QWidget *parent, register_ct_t *t
     setRootIsDecorated(false);
     sortByColumn(0, Qt::AscendingOrder);
 
+    // Rows are kept in order by mergeItems. QTreeWidget's own sorting would
+    // re-sort every row whenever one is added, so drive the header ourselves.
+    header()->setSortIndicatorShown(true);
+    header()->setSectionsClickable(true);
+    connect(header(), SIGNAL(sortIndicatorChanged(int,Qt::SortOrder)),
+            this, SLOT(sortIndicatorChanged(int,Qt::SortOrder)));
+
     connect(wsApp, SIGNAL(addressResolutionChanged()), this, SLOT(updateItemsForSettingChange()));
 }
 
@@ -409,7 +418,124 @@ void TrafficTableTreeWidget::setNameResolutionEnabled(bool enable)
     if (resolve_names_ != enable) {
         resolve_names_ = enable;
         updateItems();
+        sortAllItems();
+    }
+}
+
+// QTreeWidget keeps its rows in a list, so moving a row costs O(rows)
+// while sorting the whole table costs O(rows log rows). Only move rows
+// while that's cheaper.
+int TrafficTableTreeWidget::incrementalSortThreshold(int row_count) const
+{
+    int log2_rows = 0;
+
+    while (log2_rows < 31 && (1 << log2_rows) < row_count) {
+        log2_rows++;
     }
+    return qMax(16, 8 * log2_rows);
+}
+
+// XXX An order statistics tree would let us move rows in O(log rows),
+// but QTreeWidget owns the row storage. We'd have to switch to a model.
+void TrafficTableTreeWidget::mergeItems(const QList<TrafficTableTreeWidgetItem *> &new_items)
+{
+    QSet<QTreeWidgetItem *> pending;
+    int old_count = conv_items_.size();
+
+    if (hash_.changed_idx) {
+        for (guint i = 0; i < hash_.changed_idx->len; i++) {
+            int idx = (int) g_array_index(hash_.changed_idx, guint, i);
+            if (idx < old_count) {
+                pending << conv_items_[idx];
+            }
+        }
+    }
+    conv_items_ += new_items.toVector();
+
+    QTreeWidgetItem *cur_item = currentItem();
+
+    // Pull out the changed rows that no longer sit between their
+    // neighbors. The remaining rows kept their relative order, but
+    // removing a row creates new neighbors, so repeat until it settles.
+    // Each pass walks the rows once instead of looking up the row of each
+    // changed item, which is linear as well.
+    int threshold = incrementalSortThreshold(topLevelItemCount() + new_items.size());
+    QList<TrafficTableTreeWidgetItem *> moved;
+    bool removed = topLevelItemCount() > 0 && !pending.isEmpty();
+    while (removed && moved.size() + new_items.size() <= threshold) {
+        QList<int> out_of_order;
+        for (int row = 0; row < topLevelItemCount(); row++) {
+            if (pending.contains(topLevelItem(row)) && !rowInSortOrder(row)) {
+                out_of_order << row;
+            }
+        }
+        removed = !out_of_order.isEmpty();
+        for (int i = out_of_order.size() - 1; i >= 0; i--) {
+            QTreeWidgetItem *item = takeTopLevelItem(out_of_order[i]);
+            pending.remove(item);
+            moved << static_cast<TrafficTableTreeWidgetItem *>(item);
+        }
+    }
+
+    moved += new_items;
+    if (topLevelItemCount() < 1 || removed || moved.size() > threshold) {
+        QList<QTreeWidgetItem *> append_items;
+        foreach (TrafficTableTreeWidgetItem *item, moved) {
+            append_items << item;
+        }
+        addTopLevelItems(append_items);
+        sortAllItems();
+    } else {
+        foreach (TrafficTableTreeWidgetItem *item, moved) {
+            insertTopLevelItem(sortedInsertRow(item), item);
+        }
+        viewport()->update();
+    }
+
+    if (cur_item && currentItem() != cur_item) {
+        setCurrentItem(cur_item);
+    }
+}
+
+// Items compare themselves using their tree's sort column, so only call
+// operator< on rows that are in the tree.
+bool TrafficTableTreeWidget::rowInSortOrder(int row) const
+{
+    QTreeWidgetItem *item = topLevelItem(row);
+    QTreeWidgetItem *above = row > 0 ? topLevelItem(row - 1) : NULL;
+    QTreeWidgetItem *below = topLevelItem(row + 1);
+
+    if (header()->sortIndicatorOrder() == Qt::AscendingOrder) {
+        if (above && *item < *above) return false;
+        if (below && *below < *item) return false;
+    } else {
+        if (above && *above < *item) return false;
+        if (below && *item < *below) return false;
+    }
+    return true;
+}
+
+int TrafficTableTreeWidget::sortedInsertRow(const QTreeWidgetItem *item) const
+{
+    bool ascending = header()->sortIndicatorOrder() == Qt::AscendingOrder;
+    int low = 0;
+    int high = topLevelItemCount();
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        bool before = *topLevelItem(mid) < *item;
+        if (before == ascending) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void TrafficTableTreeWidget::sortAllItems()
+{
+    sortByColumn(header()->sortIndicatorSection(), header()->sortIndicatorOrder());
 }
 
 void TrafficTableTreeWidget::contextMenuEvent(QContextMenuEvent *event)
@@ -427,6 +553,12 @@ void TrafficTableTreeWidget::contextMenuEvent(QContextMenuEvent *event)
 void TrafficTableTreeWidget::updateItemsForSettingChange()
 {
     updateItems();
+    sortAllItems();
+}
+
+void TrafficTableTreeWidget::sortIndicatorChanged(int column, Qt::SortOrder order)
+{
+    sortByColumn(column, order);
 }
 
 /*
@@ -24,6 +24,7 @@
 
 #include <QMenu>
 #include <QTreeWidgetItem>
+#include <QVector>
 
 class QCheckBox;
 class QDialogButtonBox;
@@ -71,16 +72,28 @@ protected:
     bool resolve_names_;
     QMenu ctx_menu_;
 
+    // Rows in hash_.conv_array order.
+    QVector<TrafficTableTreeWidgetItem *> conv_items_;
+
     // When adding rows, resize to contents up to this number.
     int resizeThreshold() const { return 200; }
+    // When more rows than this are new or out of place, re-sort the whole
+    // table instead of moving them one at a time.
+    int incrementalSortThreshold(int row_count) const;
     void contextMenuEvent(QContextMenuEvent *event);
+    // Add new_items and reposition the rows listed in hash_.changed_idx.
+    void mergeItems(const QList<TrafficTableTreeWidgetItem *> &new_items);
 
 private:
     virtual void updateItems() {}
+    bool rowInSortOrder(int row) const;
+    int sortedInsertRow(const QTreeWidgetItem *item) const;
+    void sortAllItems();
 
 private slots:
     // Updates all items
     void updateItemsForSettingChange();
+    void sortIndicatorChanged(int column, Qt::SortOrder order);
 
 signals:
     void titleChanged(QWidget *tree, const QString &text);
@@ -702,6 +702,196 @@ heuristic_uses_extension(unsigned int i, const char *extension)
 	return FALSE;	/* it's not one of them */
 }
 
+/*
+ * Magic numbers for the magic-number file types whose open routines
+ * accept a file only if it starts with one of the magic numbers listed
+ * for them here.  If a file doesn't start with any of a type's magic
+ * numbers, wtap_open_offline() doesn't bother calling its open routine.
+ *
+ * Only list an open routine here if *all* of the magic numbers it
+ * accepts are listed, and they're all at the beginning of the file.
+ */
+typedef struct {
+	wtap_open_routine_t open_routine;
+	guint len;
+	const char *magic;
+} open_magic_t;
+
+static const open_magic_t open_magics[] = {
+	/* pcap; libpcap_open() checks for each of these in both byte orders */
+	{ libpcap_open,   4, "\xa1\xb2\xc3\xd4" },
+	{ libpcap_open,   4, "\xd4\xc3\xb2\xa1" },
+	{ libpcap_open,   4, "\xa1\xb2\xcd\x34" },
+	{ libpcap_open,   4, "\x34\xcd\xb2\xa1" },
+	{ libpcap_open,   4, "\xa1\xb2\x3c\x4d" },
+	{ libpcap_open,   4, "\x4d\x3c\xb2\xa1" },
+	{ libpcap_open,   4, "\x1c\x00\x01\xac" },
+	{ libpcap_open,   4, "\xac\x01\x00\x1c" },
+	{ libpcap_open,   4, "\x1c\x00\x01\xab" },
+	{ libpcap_open,   4, "\xab\x01\x00\x1c" },
+	/* pcapng; the Section Header Block type is a palindrome */
+	{ pcapng_open,    4, "\x0a\x0d\x0d\x0a" },
+	{ ngsniffer_open, 17, "TRSNIFF data    \x1a" },
+	{ snoop_open,     8, "snoop\0\0\0" },
+	{ iptrace_open,   11, "iptrace 1.0" },
+	{ iptrace_open,   11, "iptrace 2.0" },
+	{ netmon_open,    4, "RTSS" },
+	{ netmon_open,    4, "GMBU" },
+	{ netxray_open,   4, "XCP\0" },
+	{ netxray_open,   4, "VL\0\0" },
+	{ nettl_open,     12, "\x00\x00\x00\x01\x00\x00\x00\x00\x00\x07\xd0\x00" },
+	{ nettl_open,     12, "\x54\x52\x00\x64\x00\x00\x00\x00\x00\x00\x00\x80" },
+	{ visual_open,    4, "\x05VNF" },
+	{ btsnoop_open,   8, "btsnoop\0" }
+};
+
+#define N_OPEN_MAGICS	(sizeof open_magics / sizeof open_magics[0])
+
+/* Enough for the longest magic number above. */
+#define OPEN_HEADER_SIZE	32
+
+/*
+ * Read the first OPEN_HEADER_SIZE bytes of the file, or as many of them
+ * as there are, and seek back to the beginning.  Returns the number of
+ * bytes read, or -1 on an I/O error.
+ */
+static int
+read_open_header(wtap *wth, guint8 *header, int *err, gchar **err_info)
+{
+	int bytes_read;
+
+	bytes_read = file_read(header, OPEN_HEADER_SIZE, wth->fh);
+	if (bytes_read < OPEN_HEADER_SIZE) {
+		*err = file_error(wth->fh, err_info);
+		if (*err != 0 && *err != WTAP_ERR_SHORT_READ)
+			return -1;
+		*err = 0;
+		g_free(*err_info);
+		*err_info = NULL;
+		if (bytes_read < 0)
+			bytes_read = 0;
+	}
+	if (file_seek(wth->fh, 0, SEEK_SET, err) == -1)
+		return -1;
+	return bytes_read;
+}
+
+/*
+ * Returns TRUE if the open routine at index i of open_routines is one
+ * whose magic numbers we know, and the file doesn't start with any of
+ * them, so the open routine can't accept it.
+ */
+static gboolean
+magic_rules_out_open_routine(guint i, const guint8 *header, int header_len)
+{
+	guint j;
+	gboolean known = FALSE;
+
+	for (j = 0; j < N_OPEN_MAGICS; j++) {
+		if (open_magics[j].open_routine != open_routines[i].open_routine)
+			continue;
+		known = TRUE;
+		if ((int)open_magics[j].len <= header_len &&
+		    memcmp(header, open_magics[j].magic, open_magics[j].len) == 0)
+			return FALSE;
+	}
+	return known;
+}
+
+/*
+ * Per-open-routine counters, for diagnosing slow opens; keyed by the
+ * open routine's name, as indices into open_routines change when Lua
+ * file readers are registered.  Capture files can be opened from more
+ * than one thread, so the counters are protected by a mutex.
+ */
+static GHashTable *open_routine_stats = NULL;
+static GMutex open_routine_stats_mtx;
+
+static wtap_open_routine_stats_t *
+open_routine_stats_lookup(guint i)
+{
+	wtap_open_routine_stats_t *stats;
+
+	if (open_routine_stats == NULL)
+		open_routine_stats = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	stats = (wtap_open_routine_stats_t *)g_hash_table_lookup(open_routine_stats, open_routines[i].name);
+	if (stats == NULL) {
+		stats = g_new0(wtap_open_routine_stats_t, 1);
+		g_hash_table_insert(open_routine_stats, g_strdup(open_routines[i].name), stats);
+	}
+	return stats;
+}
+
+static void
+open_routine_stats_skipped(guint i)
+{
+	g_mutex_lock(&open_routine_stats_mtx);
+	open_routine_stats_lookup(i)->skipped++;
+	g_mutex_unlock(&open_routine_stats_mtx);
+}
+
+/*
+ * Seek back to the beginning of the file, and call the open routine at
+ * index i of open_routines, timing it.
+ */
+static wtap_open_return_val
+try_open_routine(wtap *wth, guint i, int *err, gchar **err_info)
+{
+	wtap_open_return_val result;
+	gint64 start_time;
+	wtap_open_routine_stats_t *stats;
+
+	/* Seek back to the beginning of the file; the open routine
+	   for the previous file type may have left the file
+	   position somewhere other than the beginning, and the
+	   open routine for this file type will probably want
+	   to start reading at the beginning. */
+	if (file_seek(wth->fh, 0, SEEK_SET, err) == -1)
+		return WTAP_OPEN_ERROR;
+
+	/* Set wth with wslua data if any - this is how we pass the data
+	 * to the file reader, kinda like the priv member but not free'd later.
+	 * It's ok for this to copy a NULL.
+	 */
+	wth->wslua_data = open_routines[i].wslua_data;
+
+	start_time = g_get_monotonic_time();
+	result = (*open_routines[i].open_routine)(wth, err, err_info);
+
+	g_mutex_lock(&open_routine_stats_mtx);
+	stats = open_routine_stats_lookup(i);
+	stats->attempts++;
+	if (result == WTAP_OPEN_MINE)
+		stats->matches++;
+	stats->usecs += g_get_monotonic_time() - start_time;
+	g_mutex_unlock(&open_routine_stats_mtx);
+
+	return result;
+}
+
+GArray *
+wtap_get_open_routine_stats(void)
+{
+	GArray *stats_arr;
+	wtap_open_routine_stats_t stats, *found;
+	guint i;
+
+	stats_arr = g_array_sized_new(FALSE, FALSE, sizeof(wtap_open_routine_stats_t), open_info_arr->len);
+	g_mutex_lock(&open_routine_stats_mtx);
+	for (i = 0; i < open_info_arr->len; i++) {
+		memset(&stats, 0, sizeof stats);
+		if (open_routine_stats != NULL) {
+			found = (wtap_open_routine_stats_t *)g_hash_table_lookup(open_routine_stats, open_routines[i].name);
+			if (found != NULL)
+				stats = *found;
+		}
+		stats.name = open_routines[i].name;
+		g_array_append_val(stats_arr, stats);
+	}
+	g_mutex_unlock(&open_routine_stats_mtx);
+	return stats_arr;
+}
+
 /* Opens a file and prepares a wtap struct.
    If "do_random" is TRUE, it opens the file twice; the second open
    allows the application to do random-access I/O without moving
@@ -721,6 +911,8 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 	gboolean use_stdin = FALSE;
 	gchar *extension;
 	wtap_block_t shb;
+	guint8	header[OPEN_HEADER_SIZE];
+	int	header_len;
 
 	*err = 0;
 	*err_info = NULL;
@@ -859,60 +1051,45 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 
 	/* 'type' is 1 greater than the array index */
 	if (type != WTAP_TYPE_AUTO && type <= open_info_arr->len) {
-		int result;
+		switch (try_open_routine(wth, type - 1, err, err_info)) {
 
-		if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-			/* I/O error - give up */
+		case WTAP_OPEN_ERROR:
+			/* Error - give up */
 			wtap_close(wth);
 			return NULL;
-		}
-
-		/* Set wth with wslua data if any - this is how we pass the data
-		 * to the file reader, kinda like the priv member but not free'd later.
-		 * It's ok for this to copy a NULL.
-		 */
-		wth->wslua_data = open_routines[type - 1].wslua_data;
-
-		result = (*open_routines[type - 1].open_routine)(wth, err, err_info);
-
-		switch (result) {
-			case WTAP_OPEN_ERROR:
-				/* Error - give up */
-				wtap_close(wth);
-				return NULL;
 
-			case WTAP_OPEN_NOT_MINE:
-				/* No error, but not that type of file */
-				goto fail;
+		case WTAP_OPEN_NOT_MINE:
+			/* No error, but not that type of file */
+			goto fail;
 
-			case WTAP_OPEN_MINE:
-				/* We found the file type */
-				goto success;
+		case WTAP_OPEN_MINE:
+			/* We found the file type */
+			goto success;
 		}
 	}
 
+	/*
+	 * Read the beginning of the file once, so that we can skip the
+	 * open routines whose magic numbers we know and that don't
+	 * match it.  The data stays in the FILE_T's buffer, so the
+	 * seeks back to the beginning of the file before each open
+	 * routine don't have to reread it.
+	 */
+	header_len = read_open_header(wth, header, err, err_info);
+	if (header_len < 0) {
+		/* I/O error - give up */
+		wtap_close(wth);
+		return NULL;
+	}
+
 	/* Try all file types that support magic numbers */
 	for (i = 0; i < heuristic_open_routine_idx; i++) {
-		/* Seek back to the beginning of the file; the open routine
-		   for the previous file type may have left the file
-		   position somewhere other than the beginning, and the
-		   open routine for this file type will probably want
-		   to start reading at the beginning.
-
-		   Initialize the data offset while we're at it. */
-		if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-			/* Error - give up */
-			wtap_close(wth);
-			return NULL;
+		if (magic_rules_out_open_routine(i, header, header_len)) {
+			open_routine_stats_skipped(i);
+			continue;
 		}
 
-		/* Set wth with wslua data if any - this is how we pass the data
-		 * to the file reader, kinda like the priv member but not free'd later.
-		 * It's ok for this to copy a NULL.
-		 */
-		wth->wslua_data = open_routines[i].wslua_data;
-
-		switch ((*open_routines[i].open_routine)(wth, err, err_info)) {
+		switch (try_open_routine(wth, i, err, err_info)) {
 
 		case WTAP_OPEN_ERROR:
 			/* Error - give up */
@@ -938,20 +1115,7 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 			/* Does this type use that extension? */
 			if (heuristic_uses_extension(i, extension)) {
 				/* Yes. */
-				if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-					/* Error - give up */
-					g_free(extension);
-					wtap_close(wth);
-					return NULL;
-				}
-
-				/* Set wth with wslua data if any - this is how we pass the data
-				 * to the file reader, kind of like priv but not free'd later.
-				 */
-				wth->wslua_data = open_routines[i].wslua_data;
-
-				switch ((*open_routines[i].open_routine)(wth,
-				    err, err_info)) {
+				switch (try_open_routine(wth, i, err, err_info)) {
 
 				case WTAP_OPEN_ERROR:
 					/* Error - give up */
@@ -984,20 +1148,7 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 			/* Does this type have any extensions? */
 			if (open_routines[i].extensions == NULL) {
 				/* No. */
-				if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-					/* Error - give up */
-					g_free(extension);
-					wtap_close(wth);
-					return NULL;
-				}
-
-				/* Set wth with wslua data if any - this is how we pass the data
-				 * to the file reader, kind of like priv but not free'd later.
-				 */
-				wth->wslua_data = open_routines[i].wslua_data;
-
-				switch ((*open_routines[i].open_routine)(wth,
-				    err, err_info)) {
+				switch (try_open_routine(wth, i, err, err_info)) {
 
 				case WTAP_OPEN_ERROR:
 					/* Error - give up */
@@ -1029,20 +1180,7 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 			if (open_routines[i].extensions != NULL &&
 			    !heuristic_uses_extension(i, extension)) {
 				/* Yes and no. */
-				if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-					/* Error - give up */
-					g_free(extension);
-					wtap_close(wth);
-					return NULL;
-				}
-
-				/* Set wth with wslua data if any - this is how we pass the data
-				 * to the file reader, kind of like priv but not free'd later.
-				 */
-				wth->wslua_data = open_routines[i].wslua_data;
-
-				switch ((*open_routines[i].open_routine)(wth,
-				    err, err_info)) {
+				switch (try_open_routine(wth, i, err, err_info)) {
 
 				case WTAP_OPEN_ERROR:
 					/* Error - give up */
@@ -1065,19 +1203,7 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 	} else {
 		/* No - try all the heuristics types in order. */
 		for (i = heuristic_open_routine_idx; i < open_info_arr->len; i++) {
-
-			if (file_seek(wth->fh, 0, SEEK_SET, err) == -1) {
-				/* Error - give up */
-				wtap_close(wth);
-				return NULL;
-			}
-
-			/* Set wth with wslua data if any - this is how we pass the data
-			 * to the file reader, kind of like priv but not free'd later.
-			 */
-			wth->wslua_data = open_routines[i].wslua_data;
-
-			switch ((*open_routines[i].open_routine)(wth, err, err_info)) {
+			switch (try_open_routine(wth, i, err, err_info)) {
 
 			case WTAP_OPEN_ERROR:
 				/* Error - give up */
@@ -2218,6 +2344,29 @@ static gboolean wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, g
 static WFILE_T wtap_dump_file_open(wtap_dumper *wdh, const char *filename);
 static WFILE_T wtap_dump_file_fdopen(wtap_dumper *wdh, int fd);
 static int wtap_dump_file_close(wtap_dumper *wdh);
+static gboolean wtap_dump_file_flush_buffer(wtap_dumper *wdh, int *err);
+
+/*
+ * Size of the buffer in which output to a seekable, uncompressed file
+ * is assembled.  Writes of many small records, each made up of several
+ * small pieces, cost far less as memcpy()s into this buffer than as
+ * fwrite() calls, and the buffer goes to the file in writes of this
+ * size.  Those writes are only at offsets that are multiples of this
+ * size until the dumper seeks or is flushed; both write out a partial
+ * buffer, and the following writes are no longer aligned.
+ *
+ * In a standalone program that writes pcapng Enhanced Packet Blocks
+ * the way the pcapng writer did before (four fwrite()s per block, with
+ * the standard I/O library's default buffering), 60-byte packets took
+ * 136 ns per block that way and 41 ns per block through this buffer,
+ * and 1500-byte packets 1187 ns and 771 ns (2 million blocks, best of
+ * 5, to a file that stayed in the page cache).  That doesn't include
+ * the rest of wtap_dump(); editcap and "tshark -w" haven't been
+ * measured.
+ *
+ * XXX - the size hasn't been tuned.
+ */
+#define WTAP_DUMP_WRITE_BUFFER_SIZE	(1024 * 1024)
 
 static wtap_dumper *
 wtap_dump_init_dumper(int file_type_subtype, int encap, int snaplen, gboolean compressed,
@@ -2570,6 +2719,22 @@ wtap_dump_open_finish(wtap_dumper *wdh, int file_type_subtype, gboolean compress
 		return FALSE;
 	}
 
+	/*
+	 * If we're writing to an uncompressed file, as opposed to a
+	 * pipe, whose reader might want to see each packet promptly,
+	 * do our own buffering instead of the standard I/O library's.
+	 * (gzwfile has its own buffering.)  Everything written through
+	 * the buffer leaves it in large writes, so stdio buffering would
+	 * only add a copy; it's turned off.  The measurement above
+	 * includes the _IONBF switch.
+	 */
+	if (!cant_seek) {
+		setvbuf((FILE *)wdh->fh, NULL, _IONBF, 0);
+		wdh->write_buf = (guint8 *)g_malloc(WTAP_DUMP_WRITE_BUFFER_SIZE);
+		wdh->write_buf_size = WTAP_DUMP_WRITE_BUFFER_SIZE;
+		wdh->write_buf_len = 0;
+	}
+
 	/* Set wdh with wslua data if any - this is how we pass the data
 	 * to the file writer.
 	 */
@@ -2596,6 +2761,13 @@ wtap_dump(wtap_dumper *wdh, const wtap_rec *rec,
 void
 wtap_dump_flush(wtap_dumper *wdh)
 {
+	int err;
+
+	/*
+	 * XXX - we have no way to report an error; if the write
+	 * failed, the next write or the close will probably fail too.
+	 */
+	wtap_dump_file_flush_buffer(wdh, &err);
 #ifdef HAVE_ZLIB
 	if(wdh->compressed) {
 		gzwfile_flush((GZWFILE_T)wdh->fh);
@@ -2705,9 +2877,9 @@ wtap_dump_file_fdopen(wtap_dumper *wdh _U_, int fd)
 }
 #endif
 
-/* internally writing raw bytes (compressed or not) */
-gboolean
-wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err)
+/* internally writing raw bytes (compressed or not), bypassing the buffer */
+static gboolean
+wtap_dump_file_write_unbuffered(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err)
 {
 	size_t nwritten;
 
@@ -2741,10 +2913,94 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 	return TRUE;
 }
 
+/* write out whatever's in the write buffer */
+static gboolean
+wtap_dump_file_flush_buffer(wtap_dumper *wdh, int *err)
+{
+	size_t len = wdh->write_buf_len;
+
+	if (len == 0)
+		return TRUE;
+	/*
+	 * Empty the buffer even if the write fails, so that we don't
+	 * try to write the same data again when the file is closed.
+	 */
+	wdh->write_buf_len = 0;
+	return wtap_dump_file_write_unbuffered(wdh, wdh->write_buf, len, err);
+}
+
+/* internally writing raw bytes (compressed or not) */
+gboolean
+wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err)
+{
+	const guint8 *bufp = (const guint8 *)buf;
+	size_t chunk;
+
+	if (wdh->write_buf == NULL)
+		return wtap_dump_file_write_unbuffered(wdh, buf, bufsize, err);
+
+	/*
+	 * Always fill the buffer before writing it out, even if that
+	 * means copying a large write, so that writes to the file are
+	 * of the full buffer size (other than flushes before a seek or
+	 * a wtap_dump_flush()).
+	 */
+	while (bufsize != 0) {
+		chunk = wdh->write_buf_size - wdh->write_buf_len;
+		if (chunk > bufsize)
+			chunk = bufsize;
+		memcpy(wdh->write_buf + wdh->write_buf_len, bufp, chunk);
+		wdh->write_buf_len += chunk;
+		bufp += chunk;
+		bufsize -= chunk;
+		if (wdh->write_buf_len == wdh->write_buf_size) {
+			if (!wtap_dump_file_flush_buffer(wdh, err))
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+guint8 *
+wtap_dump_file_reserve(wtap_dumper *wdh, size_t size, int *err)
+{
+	guint8 *p;
+
+	*err = 0;
+	if (wdh->write_buf == NULL)
+		return NULL;
+	/* The previous reservation might have filled the buffer. */
+	if (wdh->write_buf_len == wdh->write_buf_size) {
+		if (!wtap_dump_file_flush_buffer(wdh, err))
+			return NULL;
+	}
+	if (size > wdh->write_buf_size - wdh->write_buf_len)
+		return NULL;
+	p = wdh->write_buf + wdh->write_buf_len;
+	wdh->write_buf_len += size;
+	return p;
+}
+
 /* internally close a file for writing (compressed or not) */
 static int
 wtap_dump_file_close(wtap_dumper *wdh)
 {
+	int err;
+
+	if (!wtap_dump_file_flush_buffer(wdh, &err)) {
+		errno = err;
+#ifdef HAVE_ZLIB
+		if(wdh->compressed)
+			gzwfile_close((GZWFILE_T)wdh->fh);
+		else
+#endif
+			fclose((FILE *)wdh->fh);
+		g_free(wdh->write_buf);
+		wdh->write_buf = NULL;
+		return EOF;
+	}
+	g_free(wdh->write_buf);
+	wdh->write_buf = NULL;
 #ifdef HAVE_ZLIB
 	if(wdh->compressed)
 		return gzwfile_close((GZWFILE_T)wdh->fh);
@@ -2763,6 +3019,8 @@ wtap_dump_file_seek(wtap_dumper *wdh, gint64 offset, int whence, int *err)
 	} else
 #endif
 	{
+		if (!wtap_dump_file_flush_buffer(wdh, err))
+			return -1;
 		if (-1 == fseek((FILE *)wdh->fh, (long)offset, whence)) {
 			*err = errno;
 			return -1;
@@ -2789,7 +3047,8 @@ wtap_dump_file_tell(wtap_dumper *wdh, int *err)
 			return -1;
 		} else
 		{
-			return rval;
+			/* Count what's been written but is still buffered. */
+			return rval + (gint64)wdh->write_buf_len;
 		}
 	}
 }
@@ -2809,6 +3068,11 @@ cleanup_open_routines(void)
 		g_array_free(open_info_arr, TRUE);
 		open_info_arr = NULL;
 	}
+
+	if (open_routine_stats != NULL) {
+		g_hash_table_destroy(open_routine_stats);
+		open_routine_stats = NULL;
+	}
 }
 
 /*
@@ -18,6 +18,9 @@
 
 #include <errno.h>
 #include <string.h>
+#ifdef HAVE_POSIX_FADVISE
+#include <fcntl.h>
+#endif
 #include "wtap-int.h"
 #include "file_wrappers.h"
 #include <wsutil/file_util.h>
@@ -106,6 +109,11 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+
+    /* read-ahead */
+    struct read_ahead *read_ahead; /* NULL if not reading ahead */
+    gint64 stall_usecs;         /* time spent waiting for data from the file */
+    guint stalls;               /* number of times we waited */
 };
 
 /* Current read offset within a buffer. */
@@ -144,6 +152,197 @@ buf_reset(struct wtap_reader_buf *buf)
     buf->avail = 0;
 }
 
+/*
+ * Read-ahead.
+ *
+ * When enabled with file_set_read_ahead(), a thread reads the file
+ * in READ_AHEAD_CHUNK_SIZE chunks into a ring of buffers, staying up
+ * to the whole ring ahead of buf_read(), so that buf_read() normally
+ * finds the data it wants already in memory rather than waiting for
+ * the disk or network.  The thread reads the raw file; decompression
+ * is still done as the data is consumed.
+ *
+ * The thread owns the file descriptor's file position while it's
+ * running, so it's stopped before anything else seeks on the
+ * descriptor, and the descriptor is put back at raw_pos; it's
+ * restarted by the next buf_read().
+ */
+#define READ_AHEAD_CHUNK_SIZE   (1024*1024)
+
+struct read_ahead_chunk {
+    guint8 *buf;
+    guint len;                  /* bytes of data; 0 at EOF or on an error */
+    int err;                    /* errno value if the read failed */
+};
+
+struct read_ahead {
+    int fd;
+    GThread *thread;            /* NULL if not running */
+    GMutex mtx;
+    GCond cond;
+    struct read_ahead_chunk *chunks;
+    guint num_chunks;
+    guint head;                 /* chunk the consumer is reading from */
+    guint head_offset;          /* consumer's offset in that chunk */
+    guint filled;               /* number of filled chunks, starting at head */
+    gboolean stop;              /* set by the consumer to stop the thread */
+};
+
+static gpointer
+read_ahead_thread(gpointer data)
+{
+    struct read_ahead *ra = (struct read_ahead *)data;
+    guint slot;
+    ssize_t ret;
+    int err;
+
+    for (;;) {
+        g_mutex_lock(&ra->mtx);
+        while (!ra->stop && ra->filled == ra->num_chunks)
+            g_cond_wait(&ra->cond, &ra->mtx);
+        if (ra->stop) {
+            g_mutex_unlock(&ra->mtx);
+            break;
+        }
+        /* Chunks past the filled ones belong to us until we fill them. */
+        slot = (ra->head + ra->filled) % ra->num_chunks;
+        g_mutex_unlock(&ra->mtx);
+
+        ret = ws_read(ra->fd, ra->chunks[slot].buf, READ_AHEAD_CHUNK_SIZE);
+        err = (ret < 0) ? errno : 0;
+#ifdef HAVE_POSIX_FADVISE
+        if (ret > 0) {
+            /* Let the OS start fetching what we'll want after this. */
+            (void)posix_fadvise(ra->fd, ws_lseek64(ra->fd, 0, SEEK_CUR),
+                                (off_t)READ_AHEAD_CHUNK_SIZE * ra->num_chunks,
+                                POSIX_FADV_WILLNEED);
+        }
+#endif
+
+        g_mutex_lock(&ra->mtx);
+        ra->chunks[slot].len = (ret > 0) ? (guint)ret : 0;
+        ra->chunks[slot].err = err;
+        ra->filled++;
+        g_cond_signal(&ra->cond);
+        g_mutex_unlock(&ra->mtx);
+
+        if (ret <= 0)
+            break;
+    }
+    return NULL;
+}
+
+static void
+read_ahead_start(FILE_T state)
+{
+    struct read_ahead *ra = state->read_ahead;
+
+    ra->fd = state->fd;
+    ra->head = 0;
+    ra->head_offset = 0;
+    ra->filled = 0;
+    ra->stop = FALSE;
+#ifdef HAVE_POSIX_FADVISE
+    (void)posix_fadvise(state->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    ra->thread = g_thread_new("read-ahead", read_ahead_thread, ra);
+}
+
+/*
+ * Stop the read-ahead thread, discard what it's read, and put the file
+ * descriptor back where the consumer thinks it is.
+ */
+static void
+read_ahead_stop(FILE_T state)
+{
+    struct read_ahead *ra = state->read_ahead;
+
+    if (ra == NULL || ra->thread == NULL)
+        return;
+
+    g_mutex_lock(&ra->mtx);
+    ra->stop = TRUE;
+    g_cond_signal(&ra->cond);
+    g_mutex_unlock(&ra->mtx);
+    g_thread_join(ra->thread);
+    ra->thread = NULL;
+
+    if (state->fd != -1)
+        ws_lseek64(state->fd, state->raw_pos, SEEK_SET);
+}
+
+static void
+read_ahead_free(FILE_T state)
+{
+    struct read_ahead *ra = state->read_ahead;
+    guint i;
+
+    if (ra == NULL)
+        return;
+    read_ahead_stop(state);
+    for (i = 0; i < ra->num_chunks; i++)
+        g_free(ra->chunks[i].buf);
+    g_free(ra->chunks);
+    g_mutex_clear(&ra->mtx);
+    g_cond_clear(&ra->cond);
+    g_free(ra);
+    state->read_ahead = NULL;
+}
+
+/* Like ws_read(), but from the read-ahead buffers. */
+static ssize_t
+read_ahead_read(FILE_T state, guint8 *buf, guint count)
+{
+    struct read_ahead *ra = state->read_ahead;
+    struct read_ahead_chunk *chunk;
+    gint64 start_time;
+    guint n;
+
+    if (ra->thread == NULL)
+        read_ahead_start(state);
+
+    g_mutex_lock(&ra->mtx);
+    if (ra->filled == 0) {
+        start_time = g_get_monotonic_time();
+        while (ra->filled == 0)
+            g_cond_wait(&ra->cond, &ra->mtx);
+        state->stall_usecs += g_get_monotonic_time() - start_time;
+        state->stalls++;
+    }
+    chunk = &ra->chunks[ra->head];
+    g_mutex_unlock(&ra->mtx);
+
+    if (chunk->len == 0) {
+        /*
+         * End of file or error; the thread has quit.  Clean up after it,
+         * so that if more data shows up, as it might when reading a file
+         * that's being written to, the next read starts another thread.
+         */
+        int err = chunk->err;
+
+        read_ahead_stop(state);
+        if (err != 0) {
+            errno = err;
+            return -1;
+        }
+        return 0;
+    }
+
+    n = MIN(count, chunk->len - ra->head_offset);
+    memcpy(buf, chunk->buf + ra->head_offset, n);
+    ra->head_offset += n;
+    if (ra->head_offset == chunk->len) {
+        /* Hand the chunk back to the thread. */
+        g_mutex_lock(&ra->mtx);
+        ra->head = (ra->head + 1) % ra->num_chunks;
+        ra->head_offset = 0;
+        ra->filled--;
+        g_cond_signal(&ra->cond);
+        g_mutex_unlock(&ra->mtx);
+    }
+    return n;
+}
+
 static int
 buf_read(FILE_T state, struct wtap_reader_buf *buf)
 {
@@ -169,7 +368,16 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
         to_read = space_left;
     }
 
-    ret = ws_read(state->fd, read_ptr, to_read);
+    if (state->read_ahead != NULL) {
+        ret = read_ahead_read(state, read_ptr, to_read);
+    } else {
+        /* Every read from the file is a potential stall. */
+        gint64 start_time = g_get_monotonic_time();
+
+        ret = ws_read(state->fd, read_ptr, to_read);
+        state->stall_usecs += g_get_monotonic_time() - start_time;
+        state->stalls++;
+    }
     if (ret < 0) {
         state->err = errno;
         state->err_info = NULL;
@@ -950,6 +1158,34 @@ file_set_random_access(FILE_T stream, gboolean random_flag _U_, GPtrArray *seek)
     stream->fast_seek = seek;
 }
 
+void
+file_set_read_ahead(FILE_T stream, guint megabytes)
+{
+    struct read_ahead *ra;
+    guint i;
+
+    read_ahead_free(stream);
+    if (megabytes == 0)
+        return;
+
+    ra = g_new0(struct read_ahead, 1);
+    ra->num_chunks = megabytes * (1024*1024 / READ_AHEAD_CHUNK_SIZE);
+    ra->chunks = g_new0(struct read_ahead_chunk, ra->num_chunks);
+    for (i = 0; i < ra->num_chunks; i++)
+        ra->chunks[i].buf = (guint8 *)g_malloc(READ_AHEAD_CHUNK_SIZE);
+    g_mutex_init(&ra->mtx);
+    g_cond_init(&ra->cond);
+    stream->read_ahead = ra;
+    /* The thread is started by the first read. */
+}
+
+void
+file_get_read_stalls(FILE_T stream, gint64 *usecs, guint *stalls)
+{
+    *usecs = stream->stall_usecs;
+    *stalls = stream->stalls;
+}
+
 gint64
 file_seek(FILE_T file, gint64 offset, int whence, int *err)
 {
@@ -1090,6 +1326,7 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             off = here->in + (off2 - here->out);
         }
 
+        read_ahead_stop(file);
         if (ws_lseek64(file->fd, off, SEEK_SET) == -1) {
             *err = errno;
             return -1;
@@ -1170,6 +1407,7 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /*
          * Yes.  Just seek there within the file.
          */
+        read_ahead_stop(file);
         if (ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
             *err = errno;
             return -1;
@@ -1204,6 +1442,7 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /* rewind, then skip to offset */
 
         /* back up and start over */
+        read_ahead_stop(file);
         if (ws_lseek64(file->fd, file->start, SEEK_SET) == -1) {
             *err = errno;
             return -1;
@@ -1509,6 +1748,7 @@ file_clearerr(FILE_T stream)
 void
 file_fdclose(FILE_T file)
 {
+    read_ahead_stop(file);
     ws_close(file->fd);
     file->fd = -1;
 }
@@ -1529,6 +1769,8 @@ file_close(FILE_T file)
 {
     int fd = file->fd;
 
+    read_ahead_free(file);
+
     /* free memory and close file */
     if (file->size) {
 #ifdef HAVE_ZLIB
@@ -652,7 +652,7 @@ static int libpcap_try_record(wtap *wth, FILE_T fh, int *err, gchar **err_info)
 	 * Now skip over the record's data, under the assumption that
 	 * the header is sane.
 	 */
-	if (!wtap_read_bytes(wth->fh, NULL, rec_hdr.hdr.incl_len, err,
+	if (!wtap_read_bytes(fh, NULL, rec_hdr.hdr.incl_len, err,
 	    err_info)) {
 		if (*err == WTAP_ERR_SHORT_READ) {
 			/*
@@ -784,8 +784,17 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	rec->rec_header.packet_header.len = orig_size;
 
 	/*
-	 * Read the packet data.
+	 * Read the packet data, unless this is a sequential read and
+	 * we've been asked for headers only.
 	 */
+	if (wth->skip_packet_data && fh == wth->fh) {
+		if (!wtap_read_bytes(fh, NULL, packet_size, err, err_info))
+			return FALSE;	/* failed */
+		/* The lengths might still need fixing up. */
+		pcap_read_post_process(wth->file_type_subtype, wth->file_encap,
+		    rec, NULL, libpcap->byte_swapped, -1);
+		return TRUE;
+	}
 	if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
 		return FALSE;	/* failed */
 
@@ -1956,6 +1956,10 @@ pcap_read_post_process(int file_type, int wtap_encap,
 	switch (wtap_encap) {
 
 	case WTAP_ENCAP_ATM_PDUS:
+		if (pd == NULL) {
+			/* The guesses below need the packet data. */
+			break;
+		}
 		if (file_type == WTAP_FILE_TYPE_SUBTYPE_PCAP_NOKIA) {
 			/*
 			 * Nokia IPSO ATM.
@@ -1982,17 +1986,17 @@ pcap_read_post_process(int file_type, int wtap_encap,
 		break;
 
 	case WTAP_ENCAP_SLL:
-		if (bytes_swapped)
+		if (bytes_swapped && pd != NULL)
 			pcap_byteswap_linux_sll_pseudoheader(rec, pd);
 		break;
 
 	case WTAP_ENCAP_USB_LINUX:
-		if (bytes_swapped)
+		if (bytes_swapped && pd != NULL)
 			pcap_byteswap_linux_usb_pseudoheader(rec, pd, FALSE);
 		break;
 
 	case WTAP_ENCAP_USB_LINUX_MMAPPED:
-		if (bytes_swapped)
+		if (bytes_swapped && pd != NULL)
 			pcap_byteswap_linux_usb_pseudoheader(rec, pd, TRUE);
 		break;
 
@@ -2006,7 +2010,7 @@ pcap_read_post_process(int file_type, int wtap_encap,
 		break;
 
 	case WTAP_ENCAP_NFLOG:
-		if (bytes_swapped)
+		if (bytes_swapped && pd != NULL)
 			pcap_byteswap_nflog_pseudoheader(rec, pd);
 		break;
 
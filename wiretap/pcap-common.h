@@ -23,6 +23,10 @@ extern int pcap_process_pseudo_header(FILE_T fh, int file_type, int wtap_encap,
     guint packet_size, gboolean check_packet_size,
     wtap_rec *rec, int *err, gchar **err_info);
 
+/*
+ * pd is NULL if the packet data was skipped (see wtap_set_skip_packet_data());
+ * the fixups that don't need it, such as the ERF lengths, are still done.
+ */
 extern void pcap_read_post_process(int file_type, int wtap_encap,
     wtap_rec *rec, guint8 *pd, gboolean bytes_swapped, int fcs_len);
 
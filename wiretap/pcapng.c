@@ -204,6 +204,7 @@ typedef struct {
     gint8 if_fcslen;
     wtap_new_ipv4_callback_t add_new_ipv4;
     wtap_new_ipv6_callback_t add_new_ipv6;
+    gboolean skip_packet_data;   /**< Skip packet data on this read */
 } pcapng_t;
 
 #ifdef HAVE_PLUGINS
@@ -1230,9 +1231,15 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     wblock->rec->ts.nsecs = (int)(((ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second);
 
     /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                packet.cap_len - pseudo_header_len, err, err_info))
-        return FALSE;
+    if (pn->skip_packet_data) {
+        if (!wtap_read_bytes(fh, NULL, packet.cap_len - pseudo_header_len,
+                             err, err_info))
+            return FALSE;
+    } else {
+        if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                    packet.cap_len - pseudo_header_len, err, err_info))
+            return FALSE;
+    }
     block_read += packet.cap_len - pseudo_header_len;
 
     /* jump over potential padding bytes at end of the packet data */
@@ -1369,7 +1376,8 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     }
 
     pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
-                           wblock->rec, ws_buffer_start_ptr(wblock->frame_buffer),
+                           wblock->rec,
+                           pn->skip_packet_data ? NULL : ws_buffer_start_ptr(wblock->frame_buffer),
                            pn->byte_swapped, fcslen);
 
     /*
@@ -1514,9 +1522,14 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *
     memset((void *)&wblock->rec->rec_header.packet_header.pseudo_header, 0, sizeof(union wtap_pseudo_header));
 
     /* "Simple Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                simple_packet.cap_len, err, err_info))
-        return FALSE;
+    if (pn->skip_packet_data) {
+        if (!wtap_read_bytes(fh, NULL, simple_packet.cap_len, err, err_info))
+            return FALSE;
+    } else {
+        if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                    simple_packet.cap_len, err, err_info))
+            return FALSE;
+    }
 
     /* jump over potential padding bytes at end of the packet data */
     if ((simple_packet.cap_len % 4) != 0) {
@@ -1525,7 +1538,8 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *
     }
 
     pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
-                           wblock->rec, ws_buffer_start_ptr(wblock->frame_buffer),
+                           wblock->rec,
+                           pn->skip_packet_data ? NULL : ws_buffer_start_ptr(wblock->frame_buffer),
                            pn->byte_swapped, pn->if_fcslen);
 
     /*
@@ -2477,6 +2491,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
     pn.version_major = -1;
     pn.version_minor = -1;
     pn.interfaces = NULL;
+    pn.skip_packet_data = FALSE;
 
     /* we don't expect any packet blocks yet */
     wblock.frame_buffer = NULL;
@@ -2601,6 +2616,7 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 
     pcapng->add_new_ipv4 = wth->add_new_ipv4;
     pcapng->add_new_ipv6 = wth->add_new_ipv6;
+    pcapng->skip_packet_data = wth->skip_packet_data;
 
     /* read next block */
     while (1) {
@@ -2727,6 +2743,7 @@ pcapng_seek_read(wtap *wth, gint64 seek_off,
 
     wblock.frame_buffer = buf;
     wblock.rec = rec;
+    pcapng->skip_packet_data = FALSE;
 
     /* read the block */
     if (pcapng_read_block(wth, wth->random_fh, pcapng, &wblock, err, err_info) != PCAPNG_BLOCK_OK) {
@@ -2986,6 +3003,7 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     guint32 comment_len = 0, comment_pad_len = 0;
     wtap_block_t int_data;
     wtapng_if_descr_mandatory_t *int_data_mand;
+    guint8 *block;
 
     /* Don't write anything we're not willing to read. */
     if (rec->rec_header.packet_header.caplen > wtap_max_snaplen_for_encap(wdh->encap)) {
@@ -3020,15 +3038,11 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
         options_total_length += 4;
     }
 
-    /* write (enhanced) packet block header */
+    /* fill in the (enhanced) packet block header */
     bh.block_type = BLOCK_TYPE_EPB;
     bh.block_total_length = (guint32)sizeof(bh) + (guint32)sizeof(epb) + phdr_len + rec->rec_header.packet_header.caplen + pad_len + options_total_length + 4;
 
-    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
-        return FALSE;
-    wdh->bytes_dumped += sizeof bh;
-
-    /* write block fixed content */
+    /* fill in the block fixed content */
     if (rec->presence_flags & WTAP_HAS_INTERFACE_ID)
         epb.interface_id        = rec->rec_header.packet_header.interface_id;
     else {
@@ -3060,6 +3074,59 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     epb.captured_len        = rec->rec_header.packet_header.caplen + phdr_len;
     epb.packet_len          = rec->rec_header.packet_header.len + phdr_len;
 
+    /*
+     * If there's no pseudo-header to write, try to assemble the whole
+     * block in the dumper's write buffer, rather than writing it out a
+     * piece at a time; for small packets, the per-write overhead would
+     * otherwise be most of the cost of writing the packet.
+     */
+    if (phdr_len == 0) {
+        block = wtap_dump_file_reserve(wdh, bh.block_total_length, err);
+        if (block != NULL) {
+            memcpy(block, &bh, sizeof bh);
+            block += sizeof bh;
+            memcpy(block, &epb, sizeof epb);
+            block += sizeof epb;
+            memcpy(block, pd, rec->rec_header.packet_header.caplen);
+            block += rec->rec_header.packet_header.caplen;
+            memset(block, 0, pad_len);
+            block += pad_len;
+            if (rec->opt_comment) {
+                option_hdr.type         = OPT_COMMENT;
+                option_hdr.value_length = comment_len;
+                memcpy(block, &option_hdr, 4);
+                block += 4;
+                memcpy(block, rec->opt_comment, comment_len);
+                block += comment_len;
+                memset(block, 0, comment_pad_len);
+                block += comment_pad_len;
+            }
+            if (rec->presence_flags & WTAP_HAS_PACK_FLAGS) {
+                option_hdr.type         = OPT_EPB_FLAGS;
+                option_hdr.value_length = 4;
+                memcpy(block, &option_hdr, 4);
+                block += 4;
+                memcpy(block, &rec->rec_header.packet_header.pack_flags, 4);
+                block += 4;
+            }
+            if (have_options) {
+                memset(block, 0, 4);
+                block += 4;
+            }
+            memcpy(block, &bh.block_total_length, sizeof bh.block_total_length);
+            wdh->bytes_dumped += bh.block_total_length;
+            return TRUE;
+        }
+        if (*err != 0)
+            return FALSE;
+    }
+
+    /* write (enhanced) packet block header */
+    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
+        return FALSE;
+    wdh->bytes_dumped += sizeof bh;
+
+    /* write block fixed content */
     if (!wtap_dump_file_write(wdh, &epb, sizeof epb, err))
         return FALSE;
     wdh->bytes_dumped += sizeof epb;
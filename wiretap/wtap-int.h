@@ -69,6 +69,10 @@ struct wtap {
     wtap_new_ipv4_callback_t    add_new_ipv4;
     wtap_new_ipv6_callback_t    add_new_ipv6;
     GPtrArray                   *fast_seek;
+    gboolean                    skip_packet_data; /**< Sequential reads may skip record data, see wtap_set_skip_packet_data() */
+    gint64                      chunk_end;      /**< Sequential reads stop at this offset; 0 to read to the end of the file */
+    gint64                      read_stall_usecs; /**< Read stall time of the sequential FILE_T, once it's closed */
+    guint                       read_stalls;    /**< Read stall count of the sequential FILE_T, once it's closed */
 };
 
 struct wtap_dumper;
@@ -92,6 +96,10 @@ struct wtap_dumper {
     gboolean                needs_reload;   /* TRUE if the file requires re-loading after saving with wtap */
     gint64                  bytes_dumped;
 
+    guint8                  *write_buf;     /* buffer in which writes are assembled, or NULL */
+    size_t                  write_buf_size; /* size of that buffer */
+    size_t                  write_buf_len;  /* number of bytes in it not yet written */
+
     void                    *priv;          /* this one holds per-file state and is free'd automatically by wtap_dump_close() */
     void                    *wslua_data;    /* this one holds wslua state info and is not free'd */
 
@@ -109,6 +117,19 @@ WS_DLL_PUBLIC gboolean wtap_dump_file_write(wtap_dumper *wdh, const void *buf,
 WS_DLL_PUBLIC gint64 wtap_dump_file_seek(wtap_dumper *wdh, gint64 offset, int whence, int *err);
 WS_DLL_PUBLIC gint64 wtap_dump_file_tell(wtap_dumper *wdh, int *err);
 
+/*
+ * Reserve "size" bytes in the dumper's write buffer, which the caller
+ * must fill in completely before doing anything else with the dumper,
+ * so that a whole block can be assembled in place rather than written
+ * a piece at a time.
+ *
+ * Returns NULL, with *err set to 0, if the dumper isn't buffered or the
+ * bytes don't fit in the buffer without flushing it early; the caller
+ * should then write the block with wtap_dump_file_write().  Returns NULL,
+ * with *err set to an error code, if the write failed.
+ */
+WS_DLL_PUBLIC guint8 *wtap_dump_file_reserve(wtap_dumper *wdh, size_t size, int *err);
+
 
 extern gint wtap_num_file_types;
 
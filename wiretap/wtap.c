@@ -1146,6 +1146,8 @@ wtap_sequential_close(wtap *wth)
 		(*wth->subtype_sequential_close)(wth);
 
 	if (wth->fh != NULL) {
+		/* Keep the stall counts for wtap_get_read_stalls(). */
+		file_get_read_stalls(wth->fh, &wth->read_stall_usecs, &wth->read_stalls);
 		file_close(wth->fh);
 		wth->fh = NULL;
 	}
@@ -1209,6 +1211,48 @@ wtap_cleareof(wtap *wth) {
 	file_clearerr(wth->fh);
 }
 
+wtap *
+wtap_open_chunk(const char *filename, unsigned int type,
+    const wtap_chunk_t *chunk, int *err, gchar **err_info)
+{
+	wtap *wth;
+
+	wth = wtap_open_offline(filename, type, err, err_info, TRUE);
+	if (wth == NULL)
+		return NULL;
+
+	if (file_tell(wth->fh) < chunk->start &&
+	    file_seek(wth->fh, chunk->start, SEEK_SET, err) == -1) {
+		wtap_close(wth);
+		return NULL;
+	}
+	wth->chunk_end = chunk->end;
+	return wth;
+}
+
+void wtap_set_skip_packet_data(wtap *wth, gboolean skip) {
+	if (wth)
+		wth->skip_packet_data = skip;
+}
+
+void wtap_set_read_ahead(wtap *wth, guint megabytes) {
+	if (wth && wth->fh && !wth->ispipe)
+		file_set_read_ahead(wth->fh, megabytes);
+}
+
+void wtap_get_read_stalls(wtap *wth, gint64 *usecs, guint *stalls) {
+	*usecs = wth->read_stall_usecs;
+	*stalls = wth->read_stalls;
+	if (wth->fh != NULL) {
+		gint64 fh_usecs;
+		guint fh_stalls;
+
+		file_get_read_stalls(wth->fh, &fh_usecs, &fh_stalls);
+		*usecs += fh_usecs;
+		*stalls += fh_stalls;
+	}
+}
+
 void wtap_set_cb_new_ipv4(wtap *wth, wtap_new_ipv4_callback_t add_new_ipv4) {
 	if (wth)
 		wth->add_new_ipv4 = add_new_ipv4;
@@ -1237,6 +1281,13 @@ wtap_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 
 	*err = 0;
 	*err_info = NULL;
+
+	/*
+	 * A chunk cursor stops at the end of its chunk.
+	 */
+	if (wth->chunk_end != 0 && file_tell(wth->fh) >= wth->chunk_end)
+		return FALSE;
+
 	if (!wth->subtype_read(wth, err, err_info, data_offset)) {
 		/*
 		 * If we didn't get an error indication, we read
@@ -1252,6 +1303,13 @@ wtap_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 		return FALSE;	/* failure */
 	}
 
+	/*
+	 * Readers that process some blocks internally may have gone
+	 * on to a record that belongs to the next chunk.
+	 */
+	if (wth->chunk_end != 0 && *data_offset >= wth->chunk_end)
+		return FALSE;
+
 	/*
 	 * Is this a packet record?
 	 */
@@ -1533,6 +1533,27 @@ struct open_info {
 };
 WS_DLL_PUBLIC struct open_info *open_routines;
 
+/*
+ * Counters for an open routine, accumulated by wtap_open_offline() to
+ * help find out which readers make opening files slow.
+ */
+typedef struct {
+    const char *name;       /* name of the open routine's open_info */
+    guint       attempts;   /* number of files it was called for */
+    guint       matches;    /* number of those that it accepted */
+    guint       skipped;    /* number of files ruled out by magic number */
+    gint64      usecs;      /* total time spent in it, in microseconds */
+} wtap_open_routine_stats_t;
+
+/**
+ * Get the counters for all registered open routines, in the order in
+ * which wtap_open_offline() tries them; free the array with
+ * g_array_free().  The names are valid as long as the open routines
+ * remain registered.
+ */
+WS_DLL_PUBLIC
+GArray *wtap_get_open_routine_stats(void);
+
 /*
  * Types of comments.
  */
@@ -1608,6 +1629,27 @@ WS_DLL_PUBLIC
 struct wtap* wtap_open_offline(const char *filename, unsigned int type, int *err,
     gchar **err_info, gboolean do_random);
 
+/** A byte range of a capture file that holds whole records */
+typedef struct {
+    gint64  start;      /**< offset of the first record in the range */
+    gint64  end;        /**< offset just past the last record in the range */
+} wtap_chunk_t;
+
+/**
+ * Open an independent cursor on one range of a file, whose offsets are
+ * known record boundaries, such as ones from a wtap_index_t.
+ * wtap_read() returns the records in that range only and then returns
+ * FALSE with *err set to 0.  Data offsets are file offsets, as usual.
+ * The cursor is opened for random access, so wtap_seek_read() may be used.
+ * It only knows the pcapng sections and interfaces described before the
+ * first packet of the file.
+ *
+ * @return The cursor, to be closed with wtap_close(), or NULL on failure.
+ */
+WS_DLL_PUBLIC
+wtap *wtap_open_chunk(const char *filename, unsigned int type,
+    const wtap_chunk_t *chunk, int *err, gchar **err_info);
+
 /**
  * If we were compiled with zlib and we're at EOF, unset EOF so that
  * wtap_read/gzread has a chance to succeed. This is necessary if
@@ -1616,6 +1658,34 @@ struct wtap* wtap_open_offline(const char *filename, unsigned int type, int *err
 WS_DLL_PUBLIC
 void wtap_cleareof(wtap *wth);
 
+/**
+ * Ask sequential reads to return record metadata only.  Readers that know
+ * each record's length from its header (currently pcap and pcapng) then
+ * skip over the record data instead of copying it into the buffer, so
+ * wtap_get_buf_ptr() must not be used and pseudo-header fields derived
+ * from the data are not filled in.  Other readers ignore this.  Random
+ * access reads always return the data.
+ */
+WS_DLL_PUBLIC
+void wtap_set_skip_packet_data(wtap *wth, gboolean skip);
+
+/**
+ * Read the file ahead of sequential reads in a background thread, keeping
+ * up to the given number of megabytes buffered, so that sequential reads
+ * rarely have to wait for the disk or network.  0 turns read-ahead off.
+ * Ignored for pipes.  Random access reads are not affected.
+ */
+WS_DLL_PUBLIC
+void wtap_set_read_ahead(wtap *wth, guint megabytes);
+
+/**
+ * Get the total time, in microseconds, that sequential reads have spent
+ * waiting for data from the file, and the number of times they waited.
+ * Without read-ahead, every read from the file counts as a wait.
+ */
+WS_DLL_PUBLIC
+void wtap_get_read_stalls(wtap *wth, gint64 *usecs, guint *stalls);
+
 /**
  * Set callback functions to add new hostnames. Currently pcapng-only.
  * MUST match add_ipv4_name and add_ipv6_name in addr_resolv.c.
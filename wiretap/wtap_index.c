@@ -0,0 +1,472 @@
+/* wtap_index.c
+ * Routines for reading and writing sidecar packet index files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "wtap-int.h"
+#include "file_wrappers.h"
+#include "wtap_index.h"
+
+#include <wsutil/file_util.h>
+#include <wsutil/crc32.h>
+
+/*
+ * The index starts with this header, followed by num_records
+ * wtap_index_entry_t structures.  Both are written in the host's
+ * byte order, so the magic number also tells us whether the index
+ * was written on a machine with the same byte order.
+ */
+#define WTAP_INDEX_MAGIC    0x57534958  /* "WSIX" */
+#define WTAP_INDEX_VERSION  3
+
+/*
+ * The number of bytes at the start of the capture file that are
+ * checksummed, to catch a file that was rewritten with the same size
+ * within the resolution of its modification time.
+ */
+#define WTAP_INDEX_HEAD_SIZE    65536
+
+/* Header flags */
+#define WTAP_INDEX_TIME_ORDERED 0x00000001  /* every record has a time stamp, none earlier than the one before */
+
+typedef struct {
+    guint32 magic;              /* WTAP_INDEX_MAGIC */
+    guint16 version;            /* WTAP_INDEX_VERSION */
+    guint16 entry_size;         /* sizeof (wtap_index_entry_t) */
+    guint64 file_size;          /* size of the capture file */
+    gint64  file_mtime;         /* modification time of the capture file, seconds */
+    guint32 file_mtime_nsecs;   /* and nanoseconds, if the OS reports them */
+    guint32 file_head_crc;      /* CRC32C of the first WTAP_INDEX_HEAD_SIZE bytes */
+    gint32  file_type_subtype;  /* WTAP_FILE_TYPE_SUBTYPE_ of the capture file */
+    gint32  file_encap;         /* file encapsulation when it was opened */
+    gint32  file_tsprec;        /* file time stamp precision */
+    guint32 num_shbs;           /* Section Header Blocks before the first record */
+    guint32 num_interfaces;     /* Interface Description Blocks before the first record */
+    guint32 num_records;        /* number of entries following the header */
+    guint64 first_offset;       /* offset of the first record */
+    guint64 end_offset;         /* offset just past the last record */
+    guint32 flags;              /* WTAP_INDEX_ header flags */
+    guint32 reserved;
+} wtap_index_header_t;
+
+G_STATIC_ASSERT(sizeof (wtap_index_header_t) == 80);
+G_STATIC_ASSERT(sizeof (wtap_index_entry_t) == 40);
+
+struct wtap_index {
+    GMappedFile              *mapped_file;
+    guint32                   num_records;
+    gboolean                  time_ordered;
+    const wtap_index_entry_t *entries;
+};
+
+struct wtap_index_writer {
+    FILE                *fh;
+    gchar               *capture_name;
+    gchar               *index_name;
+    gchar               *tmp_name;
+    wtap_index_header_t  hdr;
+    gint64               next_offset;   /* where the next record should start */
+    nstime_t             last_ts;       /* time stamp of the previous record */
+    gboolean             failed;
+};
+
+/*
+ * Can this file be indexed at all?  Records in other file types can
+ * depend on state built up while reading the file sequentially, and
+ * seeking in a compressed file without the fast seek points set up
+ * by a sequential read is slow, so we stick to uncompressed pcap and
+ * pcapng files.
+ */
+static gboolean
+wtap_index_file_supported(wtap *wth)
+{
+    if (wth->fh == NULL || file_iscompressed(wth->fh))
+        return FALSE;
+
+    switch (wth->file_type_subtype) {
+
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_AIX:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_SS991029:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_NOKIA:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_SS990417:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAP_SS990915:
+    case WTAP_FILE_TYPE_SUBTYPE_PCAPNG:
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+/*
+ * Fill in the header fields that identify the capture file as it is
+ * now.  Returns FALSE if the file can't be examined.
+ */
+static gboolean
+wtap_index_get_file_id(const char *filename, wtap_index_header_t *hdr)
+{
+    ws_statb64 statb;
+    FILE *fh;
+    guint8 *head;
+    size_t head_len;
+
+    if (ws_stat64(filename, &statb) != 0)
+        return FALSE;
+
+    hdr->file_size = statb.st_size;
+    hdr->file_mtime = statb.st_mtime;
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+    hdr->file_mtime_nsecs = (guint32)statb.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    hdr->file_mtime_nsecs = (guint32)statb.st_mtimespec.tv_nsec;
+#else
+    hdr->file_mtime_nsecs = 0;
+#endif
+
+    fh = ws_fopen(filename, "rb");
+    if (fh == NULL)
+        return FALSE;
+    head = (guint8 *)g_malloc(WTAP_INDEX_HEAD_SIZE);
+    head_len = fread(head, 1, WTAP_INDEX_HEAD_SIZE, fh);
+    if (ferror(fh)) {
+        g_free(head);
+        fclose(fh);
+        return FALSE;
+    }
+    fclose(fh);
+    hdr->file_head_crc = crc32c_calculate_no_swap(head, (int)head_len, CRC32C_PRELOAD);
+    g_free(head);
+    return TRUE;
+}
+
+static gboolean
+wtap_index_same_file(const wtap_index_header_t *hdr1, const wtap_index_header_t *hdr2)
+{
+    return hdr1->file_size == hdr2->file_size &&
+           hdr1->file_mtime == hdr2->file_mtime &&
+           hdr1->file_mtime_nsecs == hdr2->file_mtime_nsecs &&
+           hdr1->file_head_crc == hdr2->file_head_crc;
+}
+
+static guint32
+wtap_index_num_shbs(wtap *wth)
+{
+    return (wth->shb_hdrs != NULL) ? wth->shb_hdrs->len : 0;
+}
+
+static guint32
+wtap_index_num_interfaces(wtap *wth)
+{
+    return (wth->interface_data != NULL) ? wth->interface_data->len : 0;
+}
+
+wtap_index_t *
+wtap_index_open(wtap *wth, const char *filename)
+{
+    gchar *index_name;
+    GMappedFile *mapped_file;
+    const gchar *contents;
+    gsize length;
+    wtap_index_header_t hdr;
+    wtap_index_header_t file_id;
+    wtap_index_t *idx;
+
+    if (!wtap_index_file_supported(wth))
+        return NULL;
+
+    index_name = g_strconcat(filename, WTAP_INDEX_EXTENSION, NULL);
+    mapped_file = g_mapped_file_new(index_name, FALSE, NULL);
+    g_free(index_name);
+    if (mapped_file == NULL)
+        return NULL;
+
+    contents = g_mapped_file_get_contents(mapped_file);
+    length = g_mapped_file_get_length(mapped_file);
+    if (length < sizeof hdr)
+        goto stale;
+    memcpy(&hdr, contents, sizeof hdr);
+
+    if (hdr.magic != WTAP_INDEX_MAGIC ||
+        hdr.version != WTAP_INDEX_VERSION ||
+        hdr.entry_size != sizeof (wtap_index_entry_t) ||
+        (length - sizeof hdr) / sizeof (wtap_index_entry_t) != hdr.num_records ||
+        (length - sizeof hdr) % sizeof (wtap_index_entry_t) != 0)
+        goto stale;
+
+    /*
+     * Make sure the index describes this capture file as it is now,
+     * and as wiretap sees it now.
+     */
+    if (!wtap_index_get_file_id(filename, &file_id) ||
+        !wtap_index_same_file(&hdr, &file_id) ||
+        hdr.file_type_subtype != wth->file_type_subtype ||
+        hdr.file_encap != wth->file_encap ||
+        hdr.file_tsprec != wth->file_tsprec ||
+        hdr.num_shbs != wtap_index_num_shbs(wth) ||
+        hdr.num_interfaces != wtap_index_num_interfaces(wth) ||
+        hdr.first_offset != (guint64)file_tell(wth->fh) ||
+        hdr.end_offset != hdr.file_size)
+        goto stale;
+
+    idx = g_new(wtap_index_t, 1);
+    idx->mapped_file = mapped_file;
+    idx->num_records = hdr.num_records;
+    idx->time_ordered = (hdr.flags & WTAP_INDEX_TIME_ORDERED) != 0;
+    idx->entries = (const wtap_index_entry_t *)(contents + sizeof hdr);
+    return idx;
+
+stale:
+    g_mapped_file_unref(mapped_file);
+    return NULL;
+}
+
+guint32
+wtap_index_get_num_records(wtap_index_t *idx)
+{
+    return idx->num_records;
+}
+
+const wtap_index_entry_t *
+wtap_index_get_entry(wtap_index_t *idx, guint32 n)
+{
+    g_assert(n < idx->num_records);
+    return &idx->entries[n];
+}
+
+gint64
+wtap_index_get_rec(wtap_index_t *idx, guint32 n, wtap_rec *rec)
+{
+    const wtap_index_entry_t *entry = wtap_index_get_entry(idx, n);
+
+    rec->rec_type = REC_TYPE_PACKET;
+    rec->presence_flags = entry->presence_flags;
+    rec->ts.secs = (time_t)entry->secs;
+    rec->ts.nsecs = entry->nsecs;
+    rec->tsprec = entry->tsprec;
+    rec->rec_header.packet_header.caplen = entry->caplen;
+    rec->rec_header.packet_header.len = entry->len;
+    rec->rec_header.packet_header.pkt_encap = entry->pkt_encap;
+    rec->rec_header.packet_header.interface_id = entry->interface_id;
+    rec->rec_header.packet_header.drop_count = 0;
+    rec->rec_header.packet_header.pack_flags = 0;
+    rec->opt_comment = NULL;
+    rec->has_comment_changed = FALSE;
+    return (gint64)entry->offset;
+}
+
+gboolean
+wtap_index_is_time_ordered(wtap_index_t *idx)
+{
+    return idx->time_ordered;
+}
+
+guint32
+wtap_index_find_time(wtap_index_t *idx, const nstime_t *ts)
+{
+    guint32 lo = 0, hi = idx->num_records, mid;
+    const wtap_index_entry_t *entry;
+
+    g_assert(idx->time_ordered);
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        entry = &idx->entries[mid];
+        if (entry->secs < (gint64)ts->secs ||
+            (entry->secs == (gint64)ts->secs && entry->nsecs < ts->nsecs))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void
+wtap_index_close(wtap_index_t *idx)
+{
+    if (idx == NULL)
+        return;
+    g_mapped_file_unref(idx->mapped_file);
+    g_free(idx);
+}
+
+wtap_index_writer_t *
+wtap_index_writer_new(wtap *wth, const char *filename)
+{
+    wtap_index_header_t file_id;
+    wtap_index_writer_t *writer;
+
+    if (!wtap_index_file_supported(wth))
+        return NULL;
+    memset(&file_id, 0, sizeof file_id);
+    if (!wtap_index_get_file_id(filename, &file_id))
+        return NULL;
+
+    writer = g_new0(wtap_index_writer_t, 1);
+    writer->capture_name = g_strdup(filename);
+    writer->index_name = g_strconcat(filename, WTAP_INDEX_EXTENSION, NULL);
+    writer->tmp_name = g_strconcat(writer->index_name, ".tmp", NULL);
+    writer->fh = ws_fopen(writer->tmp_name, "wb");
+    if (writer->fh == NULL) {
+        g_free(writer->tmp_name);
+        g_free(writer->index_name);
+        g_free(writer->capture_name);
+        g_free(writer);
+        return NULL;
+    }
+
+    writer->hdr.magic = WTAP_INDEX_MAGIC;
+    writer->hdr.version = WTAP_INDEX_VERSION;
+    writer->hdr.entry_size = sizeof (wtap_index_entry_t);
+    writer->hdr.file_size = file_id.file_size;
+    writer->hdr.file_mtime = file_id.file_mtime;
+    writer->hdr.file_mtime_nsecs = file_id.file_mtime_nsecs;
+    writer->hdr.file_head_crc = file_id.file_head_crc;
+    writer->hdr.file_type_subtype = wth->file_type_subtype;
+    writer->hdr.file_encap = wth->file_encap;
+    writer->hdr.file_tsprec = wth->file_tsprec;
+    writer->hdr.num_shbs = wtap_index_num_shbs(wth);
+    writer->hdr.num_interfaces = wtap_index_num_interfaces(wth);
+    writer->next_offset = file_tell(wth->fh);
+    writer->hdr.first_offset = writer->next_offset;
+    writer->hdr.flags = WTAP_INDEX_TIME_ORDERED;   /* until we see otherwise */
+
+    /* Leave room for the header; it's filled in when we're done. */
+    if (fwrite(&writer->hdr, sizeof writer->hdr, 1, writer->fh) != 1)
+        writer->failed = TRUE;
+    return writer;
+}
+
+void
+wtap_index_writer_add(wtap_index_writer_t *writer, wtap *wth,
+    gint64 data_offset)
+{
+    const wtap_rec *rec = &wth->rec;
+    wtap_index_entry_t entry;
+
+    if (writer->failed)
+        return;
+
+    /*
+     * Anything between the end of the previous record and the start of
+     * this one is a block wiretap handled internally, and we can't
+     * reproduce what it did without reading the file; the same goes
+     * for interfaces described after the first record, and for
+     * records that aren't packets.
+     */
+    if (data_offset != writer->next_offset ||
+        rec->rec_type != REC_TYPE_PACKET ||
+        wtap_index_num_interfaces(wth) != writer->hdr.num_interfaces ||
+        wtap_index_num_shbs(wth) != writer->hdr.num_shbs ||
+        rec->rec_header.packet_header.pkt_encap < G_MININT16 ||
+        rec->rec_header.packet_header.pkt_encap > G_MAXINT16 ||
+        writer->hdr.num_records == G_MAXUINT32) {
+        writer->failed = TRUE;
+        return;
+    }
+
+    memset(&entry, 0, sizeof entry);
+    entry.offset = data_offset;
+    entry.secs = rec->ts.secs;
+    entry.nsecs = rec->ts.nsecs;
+    entry.caplen = rec->rec_header.packet_header.caplen;
+    entry.len = rec->rec_header.packet_header.len;
+    entry.interface_id = rec->rec_header.packet_header.interface_id;
+    entry.pkt_encap = (gint16)rec->rec_header.packet_header.pkt_encap;
+    entry.tsprec = (guint16)rec->tsprec;
+    entry.presence_flags = (guint16)rec->presence_flags;
+    if (rec->opt_comment != NULL)
+        entry.flags |= WTAP_INDEX_ENTRY_HAS_COMMENT;
+
+    if (!(rec->presence_flags & WTAP_HAS_TS) ||
+        (writer->hdr.num_records != 0 &&
+         nstime_cmp(&rec->ts, &writer->last_ts) < 0))
+        writer->hdr.flags &= ~WTAP_INDEX_TIME_ORDERED;
+    writer->last_ts = rec->ts;
+
+    if (fwrite(&entry, sizeof entry, 1, writer->fh) != 1) {
+        writer->failed = TRUE;
+        return;
+    }
+    writer->hdr.num_records++;
+    writer->next_offset = file_tell(wth->fh);
+}
+
+gboolean
+wtap_index_writer_finish(wtap_index_writer_t *writer)
+{
+    wtap_index_header_t file_id;
+
+    writer->hdr.end_offset = writer->next_offset;
+
+    /*
+     * Only keep the index if the records run right up to the end of
+     * the file, and the file hasn't changed underneath us.
+     */
+    if (writer->failed || ferror(writer->fh) ||
+        writer->hdr.end_offset != writer->hdr.file_size)
+        goto fail;
+    if (!wtap_index_get_file_id(writer->capture_name, &file_id) ||
+        !wtap_index_same_file(&writer->hdr, &file_id))
+        goto fail;
+
+    if (fseek(writer->fh, 0, SEEK_SET) != 0 ||
+        fwrite(&writer->hdr, sizeof writer->hdr, 1, writer->fh) != 1 ||
+        fclose(writer->fh) != 0) {
+        writer->fh = NULL;
+        goto fail;
+    }
+    writer->fh = NULL;
+
+    /* rename() won't replace an existing file on Windows. */
+    ws_unlink(writer->index_name);
+    if (ws_rename(writer->tmp_name, writer->index_name) != 0)
+        goto fail;
+
+    g_free(writer->tmp_name);
+    g_free(writer->index_name);
+    g_free(writer->capture_name);
+    g_free(writer);
+    return TRUE;
+
+fail:
+    wtap_index_writer_abort(writer);
+    return FALSE;
+}
+
+void
+wtap_index_writer_abort(wtap_index_writer_t *writer)
+{
+    if (writer == NULL)
+        return;
+    if (writer->fh != NULL)
+        fclose(writer->fh);
+    ws_unlink(writer->tmp_name);
+    g_free(writer->tmp_name);
+    g_free(writer->index_name);
+    g_free(writer->capture_name);
+    g_free(writer);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
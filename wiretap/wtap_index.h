@@ -0,0 +1,155 @@
+/* wtap_index.h
+ * Definitions for sidecar packet index files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WTAP_INDEX_H__
+#define __WTAP_INDEX_H__
+
+#include "wiretap/wtap.h"
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A packet index is a file stored next to a capture file, with the
+ * capture file's name and WTAP_INDEX_EXTENSION appended, that records
+ * the offset, lengths, time stamp and interface of every record in
+ * the capture file.  A program that has to run through a capture file
+ * only to find out where the records are, and not to look at their
+ * contents, can get that from the index instead.
+ *
+ * The index is a cache: it is never an error for it to be missing,
+ * and it is silently ignored if the capture file has changed since
+ * the index was written.
+ *
+ * Only uncompressed pcap and pcapng files in which every block after
+ * the leading Section Header and Interface Description Blocks is a
+ * packet record are indexed.  Other blocks, such as Name Resolution
+ * or Decryption Secrets Blocks, carry state that is only picked up by
+ * reading the file sequentially, so a file containing them can't be
+ * handled without a sequential read.
+ *
+ * The index is written in the host's byte order and is mapped into
+ * memory when read; an index written on a machine with a different
+ * byte order is treated as stale.
+ */
+#define WTAP_INDEX_EXTENSION    ".wsidx"
+
+/** One record in a packet index */
+typedef struct {
+    guint64 offset;             /**< offset of the record in the capture file */
+    gint64  secs;               /**< time stamp, seconds */
+    gint32  nsecs;              /**< time stamp, nanoseconds */
+    guint32 caplen;             /**< data length in the file */
+    guint32 len;                /**< data length on the wire */
+    guint32 interface_id;       /**< identifier of the interface */
+    gint16  pkt_encap;          /**< WTAP_ENCAP_ value for this packet */
+    guint16 tsprec;             /**< WTAP_TSPREC_ value for this packet */
+    guint16 presence_flags;     /**< WTAP_HAS_ flags for this packet */
+    guint8  flags;              /**< WTAP_INDEX_ENTRY_ flags */
+    guint8  reserved;
+} wtap_index_entry_t;
+
+#define WTAP_INDEX_ENTRY_HAS_COMMENT    0x01    /**< packet has a comment */
+
+typedef struct wtap_index wtap_index_t;
+typedef struct wtap_index_writer wtap_index_writer_t;
+
+/**
+ * Open the index for a capture file that has been opened with
+ * wtap_open_offline(), and check that it's up to date.
+ *
+ * @param wth The capture file, as opened by wtap_open_offline().
+ * @param filename The name of the capture file.
+ * @return The index, or NULL if there is no usable index for the file.
+ */
+WS_DLL_PUBLIC
+wtap_index_t *wtap_index_open(wtap *wth, const char *filename);
+
+/** Return the number of records in the index. */
+WS_DLL_PUBLIC
+guint32 wtap_index_get_num_records(wtap_index_t *idx);
+
+/** Return the n'th record in the index, counting from 0. */
+WS_DLL_PUBLIC
+const wtap_index_entry_t *wtap_index_get_entry(wtap_index_t *idx, guint32 n);
+
+/**
+ * Fill in the header of a wtap_rec from the n'th record in the index,
+ * counting from 0, as wtap_read() would have filled it in, without
+ * the packet data, pseudo-header or comment.
+ *
+ * @return The offset of the record in the capture file.
+ */
+WS_DLL_PUBLIC
+gint64 wtap_index_get_rec(wtap_index_t *idx, guint32 n, wtap_rec *rec);
+
+/**
+ * Return TRUE if every record in the index has a time stamp, and no
+ * record's time stamp is earlier than that of the record before it,
+ * so that wtap_index_find_time() can be used.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_index_is_time_ordered(wtap_index_t *idx);
+
+/**
+ * Find, with a binary search, the first record in a time-ordered index
+ * whose time stamp is at or after ts.
+ *
+ * @return The number of the record, counting from 0, or the number of
+ * records in the index if every record is earlier than ts.
+ */
+WS_DLL_PUBLIC
+guint32 wtap_index_find_time(wtap_index_t *idx, const nstime_t *ts);
+
+/** Unmap and free an index. */
+WS_DLL_PUBLIC
+void wtap_index_close(wtap_index_t *idx);
+
+/**
+ * Start writing an index for a capture file that has been opened with
+ * wtap_open_offline() and not yet read from.
+ *
+ * @param wth The capture file, as opened by wtap_open_offline().
+ * @param filename The name of the capture file.
+ * @return The writer, or NULL if the file can't be indexed or the index
+ * can't be created.
+ */
+WS_DLL_PUBLIC
+wtap_index_writer_t *wtap_index_writer_new(wtap *wth, const char *filename);
+
+/**
+ * Add the record most recently returned by wtap_read() to the index.
+ * If the record can't be indexed, the writer is marked as failed, and
+ * wtap_index_writer_finish() will discard the index.
+ */
+WS_DLL_PUBLIC
+void wtap_index_writer_add(wtap_index_writer_t *writer, wtap *wth,
+    gint64 data_offset);
+
+/**
+ * Finish writing an index after wtap_read() has reached the end of the
+ * capture file without an error, and free the writer.
+ *
+ * @return TRUE if the index was written, FALSE otherwise.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_index_writer_finish(wtap_index_writer_t *writer);
+
+/** Discard a partially-written index and free the writer. */
+WS_DLL_PUBLIC
+void wtap_index_writer_abort(wtap_index_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WTAP_INDEX_H__ */
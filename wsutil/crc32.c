@@ -17,6 +17,7 @@
 
 #include <glib.h>
 #include <wsutil/crc32.h>
+#include "crc32_int.h"
 
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
@@ -365,28 +366,73 @@ crc32_ccitt_table_lookup (guchar pos)
 	return crc32_ccitt_table[pos];
 }
 
+#ifdef HAVE_SSE4_2
+static gboolean
+crc32c_use_sse42(void)
+{
+	static int use_sse42 = -1;
+
+	if (use_sse42 == -1)
+		use_sse42 = ws_crc32c_sse42_supported() ? 1 : 0;
+
+	return use_sse42;
+}
+#endif
+
+#ifdef HAVE_PCLMUL
+static gboolean
+crc32_use_pclmul(void)
+{
+	static int use_pclmul = -1;
+
+	if (use_pclmul == -1)
+		use_pclmul = ws_crc32_pclmul_supported() ? 1 : 0;
+
+	return use_pclmul;
+}
+#endif
+
 guint32
-crc32c_calculate(const void *buf, int len, guint32 crc)
+ws_crc32c_portable(const guint8 *buf, size_t len, guint32 crc)
 {
-	const guint8 *p = (const guint8 *)buf;
-	crc = CRC32C_SWAP(crc);
 	while (len-- > 0) {
-		CRC32C(crc, *p++);
+		CRC32C(crc, *buf++);
 	}
-	return CRC32C_SWAP(crc);
+
+	return crc;
 }
 
 guint32
-crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+ws_crc32_ccitt_portable(const guint8 *buf, size_t len, guint32 crc)
 {
-	const guint8 *p = (const guint8 *)buf;
 	while (len-- > 0) {
-		CRC32C(crc, *p++);
+		CRC32_ACCUMULATE(crc, *buf++, crc32_ccitt_table);
 	}
 
 	return crc;
 }
 
+guint32
+crc32c_calculate(const void *buf, int len, guint32 crc)
+{
+	crc = CRC32C_SWAP(crc);
+	crc = crc32c_calculate_no_swap(buf, len, crc);
+	return CRC32C_SWAP(crc);
+}
+
+guint32
+crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+{
+	const guint8 *p = (const guint8 *)buf;
+
+#ifdef HAVE_SSE4_2
+	if (len >= 8 && crc32c_use_sse42())
+		return ws_crc32c_sse42(p, len, crc);
+#endif
+
+	return len > 0 ? ws_crc32c_portable(p, len, crc) : crc;
+}
+
 guint32
 crc32_ccitt(const guint8 *buf, guint len)
 {
@@ -396,11 +442,18 @@ crc32_ccitt(const guint8 *buf, guint len)
 guint32
 crc32_ccitt_seed(const guint8 *buf, guint len, guint32 seed)
 {
-	guint i;
+	guint i = 0;
 	guint32 crc32 = seed;
 
-	for (i = 0; i < len; i++)
-		CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
+#ifdef HAVE_PCLMUL
+	if (len >= 64 && crc32_use_pclmul()) {
+		/* Do the whole 16-byte blocks, and the rest below */
+		i = len & ~15U;
+		crc32 = ws_crc32_pclmul(buf, i, crc32);
+	}
+#endif
+
+	crc32 = ws_crc32_ccitt_portable(buf + i, len - i, crc32);
 
 	return ( ~crc32 );
 }
@@ -0,0 +1,35 @@
+/* crc32_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __CRC32_INT_H__
+#define __CRC32_INT_H__
+
+#include "ws_symbol_export.h"
+
+/*
+ * The CRC32C and CRC-32 kernels work on the CRC register, neither
+ * inverting it on the way in nor on the way out.  They're exported so
+ * that tvbtest can check each of them, not just the one picked at run
+ * time.
+ */
+WS_DLL_PUBLIC guint32 ws_crc32c_portable(const guint8 *buf, size_t len, guint32 crc);
+WS_DLL_PUBLIC guint32 ws_crc32_ccitt_portable(const guint8 *buf, size_t len, guint32 crc);
+
+#ifdef HAVE_SSE4_2
+WS_DLL_PUBLIC gboolean ws_crc32c_sse42_supported(void);
+WS_DLL_PUBLIC guint32 ws_crc32c_sse42(const guint8 *buf, size_t len, guint32 crc);
+#endif
+
+#ifdef HAVE_PCLMUL
+WS_DLL_PUBLIC gboolean ws_crc32_pclmul_supported(void);
+/* len must be at least 64 and a multiple of 16 */
+WS_DLL_PUBLIC guint32 ws_crc32_pclmul(const guint8 *buf, size_t len, guint32 crc);
+#endif
+
+#endif /* __CRC32_INT_H__ */
@@ -0,0 +1,134 @@
+/* crc32_pclmul.c
+ * CRC-32 (the Ethernet CRC) using carry-less multiplication
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_PCLMUL
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#include "crc32_int.h"
+
+#define cast_m128i(p) ((const __m128i *) (const void *) (p))
+
+gboolean
+ws_crc32_pclmul_supported(void)
+{
+    return (ws_cpuid_sse42() && ws_cpuid_pclmul()) ? TRUE : FALSE;
+}
+
+/*
+ * This folds 64 bytes at a time into four 128-bit accumulators, folds
+ * those into one, and then reduces that to 32 bits with a Barrett
+ * reduction, as described in Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction" white paper.  The constants
+ * are the bit-reflected ones from that paper for the CRC-32 polynomial
+ * 0x04C11DB7.
+ *
+ * As with the table-driven code in crc32.c, crc is the CRC register,
+ * neither inverted on the way in nor on the way out.
+ */
+guint32
+ws_crc32_pclmul(const guint8 *buf, size_t len, guint32 crc)
+{
+    const __m128i k1k2 = _mm_set_epi64x(G_GINT64_CONSTANT(0x01c6e41596), G_GINT64_CONSTANT(0x0154442bd4));
+    const __m128i k3k4 = _mm_set_epi64x(G_GINT64_CONSTANT(0x00ccaa009e), G_GINT64_CONSTANT(0x01751997d0));
+    const __m128i k5k0 = _mm_set_epi64x(0, G_GINT64_CONSTANT(0x0163cd6124));
+    const __m128i poly = _mm_set_epi64x(G_GINT64_CONSTANT(0x01f7011641), G_GINT64_CONSTANT(0x01db710641));
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128(cast_m128i(buf + 0x00));
+    x2 = _mm_loadu_si128(cast_m128i(buf + 0x10));
+    x3 = _mm_loadu_si128(cast_m128i(buf + 0x20));
+    x4 = _mm_loadu_si128(cast_m128i(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    len -= 64;
+
+    /* Fold 64 bytes at a time */
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(cast_m128i(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(cast_m128i(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(cast_m128i(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(cast_m128i(buf + 0x30)));
+
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four accumulators into one */
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Fold in what's left, 16 bytes at a time */
+    while (len >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(cast_m128i(buf))), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 bits to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (guint32)_mm_extract_epi32(x1, 1);
+}
+
+#endif /* HAVE_PCLMUL */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
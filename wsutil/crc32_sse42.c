@@ -0,0 +1,79 @@
+/* crc32_sse42.c
+ * CRC32C using the SSE4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <string.h>
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <nmmintrin.h>
+#include "crc32_int.h"
+
+gboolean
+ws_crc32c_sse42_supported(void)
+{
+    return ws_cpuid_sse42() ? TRUE : FALSE;
+}
+
+/*
+ * The crc32 instruction computes the reflected CRC with the Castagnoli
+ * polynomial, i.e. it does the same thing as the CRC32C() table lookup
+ * in crc32.c, without inverting the value before or after.
+ */
+guint32
+ws_crc32c_sse42(const guint8 *buf, size_t len, guint32 crc)
+{
+    const guint8 *p = buf;
+    const guint8 *end = buf + len;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    guint64 crc64 = crc;
+
+    while (end - p >= 8) {
+        guint64 word;
+
+        memcpy(&word, p, sizeof word);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+    }
+    crc = (guint32)crc64;
+#else
+    while (end - p >= 4) {
+        guint32 word;
+
+        memcpy(&word, p, sizeof word);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+    }
+#endif
+    while (p < end)
+        crc = _mm_crc32_u8(crc, *p++);
+
+    return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
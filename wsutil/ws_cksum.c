@@ -0,0 +1,91 @@
+/* ws_cksum.c
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+#include "ws_cksum.h"
+#include "ws_cksum_int.h"
+
+/*
+ * 2^16 and 2^32 are 1 modulo 65535, so adding the buffer up as 32-bit
+ * words gives a sum that folds to the same 16-bit value as adding it up
+ * as 16-bit words (RFC 1071, section 2(B)).  The 32-bit words are added
+ * into two 64-bit sums, which can't overflow for buffers smaller than
+ * 64 GiB, so, unlike adding 64-bit words with end-around carries, there
+ * is no carry to wait for between one addition and the next; that matters
+ * most for short packets, which never reach the vectorized versions.
+ */
+guint16
+ws_cksum_sum16_portable(const guint8 *buf, size_t len)
+{
+    guint64 sum = 0, sum2 = 0;
+    guint64 word64;
+    guint16 word16;
+
+    while (len >= 16) {
+        memcpy(&word64, buf, sizeof word64);
+        sum += (guint32)word64;
+        sum2 += word64 >> 32;
+        memcpy(&word64, buf + 8, sizeof word64);
+        sum += (guint32)word64;
+        sum2 += word64 >> 32;
+        buf += 16;
+        len -= 16;
+    }
+    sum += sum2;
+    while (len >= 2) {
+        memcpy(&word16, buf, sizeof word16);
+        sum += word16;
+        buf += 2;
+        len -= 2;
+    }
+
+    return ws_cksum_fold(sum);
+}
+
+#ifdef HAVE_AVX2
+static gboolean
+ws_cksum_use_avx2(void)
+{
+    static int use_avx2 = -1;
+
+    if (use_avx2 == -1)
+        use_avx2 = ws_cksum_avx2_supported() ? 1 : 0;
+
+    return use_avx2;
+}
+#endif
+
+guint16
+ws_cksum_sum16(const void *buf, size_t len)
+{
+#ifdef HAVE_AVX2
+    if (len >= 64 && ws_cksum_use_avx2())
+        return ws_cksum_sum16_avx2((const guint8 *)buf, len);
+#endif
+
+    return ws_cksum_sum16_portable((const guint8 *)buf, len);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,24 @@
+/* ws_cksum.h
+ * Vectorized ones'-complement sums, for the Internet checksum.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_CKSUM_H__
+#define __WS_CKSUM_H__
+
+#include "ws_symbol_export.h"
+
+/** Add up the first len bytes of buf as 16-bit words in host byte order,
+ * in ones'-complement arithmetic, as the Internet checksum (RFC 1071)
+ * does.  buf needn't be aligned; if len is odd, the last byte is not
+ * added.  Returns the sum folded to 16 bits, which is 0 only if every
+ * word is 0.
+ */
+WS_DLL_PUBLIC guint16 ws_cksum_sum16(const void *buf, size_t len);
+
+#endif /* __WS_CKSUM_H__ */
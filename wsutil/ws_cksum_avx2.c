@@ -0,0 +1,82 @@
+/* ws_cksum_avx2.c
+ * AVX2 version of ws_cksum_sum16()
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <immintrin.h>
+#include "ws_cksum.h"
+#include "ws_cksum_int.h"
+
+#define cast_m256i(p) ((const __m256i *) (const void *) (p))
+
+/*
+ * Each 32-byte block adds two 16-bit words to each 32-bit lane, so this
+ * many blocks can be added up before a lane could overflow.
+ */
+#define MAX_BLOCKS_PER_PASS 32768
+
+gboolean
+ws_cksum_avx2_supported(void)
+{
+    return ws_cpuid_avx2() ? TRUE : FALSE;
+}
+
+guint16
+ws_cksum_sum16_avx2(const guint8 *buf, size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    guint64 sum = 0;
+
+    while (len >= 32) {
+        __m256i acc = zero;
+        size_t blocks = len / 32;
+        guint32 lanes[8];
+        int i;
+
+        if (blocks > MAX_BLOCKS_PER_PASS)
+            blocks = MAX_BLOCKS_PER_PASS;
+        len -= blocks * 32;
+
+        /* Widen the 16-bit words to 32 bits and add them up */
+        while (blocks-- != 0) {
+            __m256i chunk = _mm256_loadu_si256(cast_m256i(buf));
+
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(chunk, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(chunk, zero));
+            buf += 32;
+        }
+
+        _mm256_storeu_si256((__m256i *)(void *)lanes, acc);
+        for (i = 0; i < 8; i++)
+            sum += lanes[i];
+    }
+
+    return ws_cksum_fold(sum + ws_cksum_sum16_portable(buf, len));
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
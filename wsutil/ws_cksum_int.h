@@ -0,0 +1,35 @@
+/* ws_cksum_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_CKSUM_INT_H__
+#define __WS_CKSUM_INT_H__
+
+#include "ws_symbol_export.h"
+
+/*
+ * Fold a ones'-complement sum to 16 bits with end-around carries.  This
+ * never turns a non-zero sum into 0.
+ */
+static inline guint16
+ws_cksum_fold(guint64 sum)
+{
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (guint16)sum;
+}
+
+/* Exported so that tvbtest can check each kernel */
+WS_DLL_PUBLIC guint16 ws_cksum_sum16_portable(const guint8 *buf, size_t len);
+
+#ifdef HAVE_AVX2
+WS_DLL_PUBLIC gboolean ws_cksum_avx2_supported(void);
+WS_DLL_PUBLIC guint16 ws_cksum_sum16_avx2(const guint8 *buf, size_t len);
+#endif
+
+#endif /* __WS_CKSUM_INT_H__ */
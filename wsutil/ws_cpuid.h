@@ -89,7 +89,7 @@ ws_cpuid(guint32 *CPUInfo _U_, int selector _U_)
 }
 #endif
 
-static int
+static inline int
 ws_cpuid_sse42(void)
 {
 	guint32 CPUInfo[4];
@@ -100,3 +100,71 @@ ws_cpuid_sse42(void)
 	/* in ECX bit 20 toggled on */
 	return (CPUInfo[2] & (1 << 20));
 }
+
+static inline int
+ws_cpuid_pclmul(void)
+{
+	guint32 CPUInfo[4];
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return 0;
+
+	/* in ECX bit 1 toggled on */
+	return (CPUInfo[2] & (1 << 1));
+}
+
+/*
+ * Read an extended control register; only meaningful if the OSXSAVE
+ * bit is set in cpuid leaf 1.  Returns 0 if we can't read it.
+ */
+#if defined(_MSC_VER) && (_MSC_FULL_VER >= 160040219) && (defined(_M_IX86) || defined(_M_X64))
+#include <immintrin.h>
+static inline guint64
+ws_xgetbv(guint32 xcr)
+{
+	return _xgetbv(xcr);
+}
+#elif defined(__GNUC__) && defined(__x86_64__)
+static inline guint64
+ws_xgetbv(guint32 xcr)
+{
+	guint32 eax, edx;
+
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" /* xgetbv */
+						: "=a" (eax), "=d" (edx)
+						: "c" (xcr));
+	return ((guint64)edx << 32) | eax;
+}
+#else
+static inline guint64
+ws_xgetbv(guint32 xcr _U_)
+{
+	return 0;
+}
+#endif
+
+static inline int
+ws_cpuid_avx2(void)
+{
+	guint32 CPUInfo[4];
+
+	if (!ws_cpuid(CPUInfo, 0) || CPUInfo[0] < 7)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return 0;
+
+	/* in ECX bit 27 (OSXSAVE) and bit 28 (AVX) toggled on */
+	if ((CPUInfo[2] & ((1 << 27) | (1 << 28))) != ((1 << 27) | (1 << 28)))
+		return 0;
+
+	/* the OS saves the XMM and YMM state (XCR0 bits 1 and 2) */
+	if ((ws_xgetbv(0) & 0x6) != 0x6)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 7))
+		return 0;
+
+	/* in EBX bit 5 toggled on */
+	return (CPUInfo[1] & (1 << 5));
+}
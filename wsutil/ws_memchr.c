@@ -0,0 +1,234 @@
+/* ws_memchr.c
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+#include "ws_memchr.h"
+#include "ws_memchr_int.h"
+#include "bits_ctz.h"
+
+#if defined(WS_MEMCHR_SSE2)
+#include <emmintrin.h>
+#elif defined(WS_MEMCHR_NEON)
+#include <arm_neon.h>
+#endif
+
+const guint8 *
+ws_memchr2_portable(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *haystack_end = haystack + haystacklen;
+
+    while (haystack < haystack_end) {
+        if (*haystack == c1 || *haystack == c2)
+            return haystack;
+        haystack++;
+    }
+
+    return NULL;
+}
+
+const guint8 *
+ws_memchr_pair_portable(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *haystack_end = haystack + haystacklen;
+    const guint8 *p = haystack;
+
+    if (haystacklen < 2)
+        return NULL;
+
+    /* memchr() is vectorized by most C libraries; let it do the work. */
+    while ((p = (const guint8 *)memchr(p, c1, haystack_end - p - 1)) != NULL) {
+        if (p[1] == c2)
+            return p;
+        p++;
+        if (haystack_end - p < 2)
+            break;
+    }
+
+    return NULL;
+}
+
+#ifdef WS_MEMCHR_SSE2
+#define cast_m128i(p) ((const __m128i *) (const void *) (p))
+
+const guint8 *
+ws_memchr2_sse2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const __m128i v1 = _mm_set1_epi8((char)c1);
+    const __m128i v2 = _mm_set1_epi8((char)c2);
+
+    while (haystack_end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(cast_m128i(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, v1),
+                                                  _mm_cmpeq_epi8(chunk, v2)));
+        if (mask)
+            return p + ws_ctz(mask);
+        p += 16;
+    }
+
+    return ws_memchr2_portable(p, haystack_end - p, c1, c2);
+}
+
+const guint8 *
+ws_memchr_pair_sse2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const __m128i v1 = _mm_set1_epi8((char)c1);
+    const __m128i v2 = _mm_set1_epi8((char)c2);
+
+    /* Each iteration looks at 16 candidate positions, i.e. 17 bytes. */
+    while (haystack_end - p >= 17) {
+        __m128i first = _mm_loadu_si128(cast_m128i(p));
+        __m128i second = _mm_loadu_si128(cast_m128i(p + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, v1),
+                                                   _mm_cmpeq_epi8(second, v2)));
+        if (mask)
+            return p + ws_ctz(mask);
+        p += 16;
+    }
+
+    return ws_memchr_pair_portable(p, haystack_end - p, c1, c2);
+}
+#endif /* WS_MEMCHR_SSE2 */
+
+#ifdef WS_MEMCHR_NEON
+/*
+ * NEON has no movemask; test the whole vector for a match and let the
+ * scalar code find its position within those 16 bytes.
+ */
+const guint8 *
+ws_memchr2_neon(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const uint8x16_t v1 = vdupq_n_u8(c1);
+    const uint8x16_t v2 = vdupq_n_u8(c2);
+
+    while (haystack_end - p >= 16) {
+        uint8x16_t chunk = vld1q_u8(p);
+        uint8x16_t eq = vorrq_u8(vceqq_u8(chunk, v1), vceqq_u8(chunk, v2));
+        if (vmaxvq_u8(eq))
+            return ws_memchr2_portable(p, 16, c1, c2);
+        p += 16;
+    }
+
+    return ws_memchr2_portable(p, haystack_end - p, c1, c2);
+}
+
+const guint8 *
+ws_memchr_pair_neon(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const uint8x16_t v1 = vdupq_n_u8(c1);
+    const uint8x16_t v2 = vdupq_n_u8(c2);
+
+    while (haystack_end - p >= 17) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(p), v1),
+                                 vceqq_u8(vld1q_u8(p + 1), v2));
+        if (vmaxvq_u8(eq))
+            return ws_memchr_pair_portable(p, 17, c1, c2);
+        p += 16;
+    }
+
+    return ws_memchr_pair_portable(p, haystack_end - p, c1, c2);
+}
+#endif /* WS_MEMCHR_NEON */
+
+#ifdef HAVE_AVX2
+static gboolean
+ws_memchr_use_avx2(void)
+{
+    static int use_avx2 = -1;
+
+    if (use_avx2 == -1)
+        use_avx2 = ws_memchr_avx2_supported() ? 1 : 0;
+
+    return use_avx2;
+}
+#endif
+
+const guint8 *
+ws_memchr2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+#ifdef HAVE_AVX2
+    if (haystacklen >= 32 && ws_memchr_use_avx2())
+        return ws_memchr2_avx2(haystack, haystacklen, c1, c2);
+#endif
+
+#if defined(WS_MEMCHR_SSE2)
+    if (haystacklen >= 16)
+        return ws_memchr2_sse2(haystack, haystacklen, c1, c2);
+#elif defined(WS_MEMCHR_NEON)
+    if (haystacklen >= 16)
+        return ws_memchr2_neon(haystack, haystacklen, c1, c2);
+#endif
+
+    return ws_memchr2_portable(haystack, haystacklen, c1, c2);
+}
+
+const guint8 *
+ws_memchr_pair(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *haystack_end = haystack + haystacklen;
+    int misses;
+
+    /*
+     * When the first byte is rare, the C library's memchr() finds it
+     * faster than the pair kernels, which compare both bytes everywhere.
+     * Only switch to them once the first byte has turned up a few times
+     * without the second one after it.
+     */
+    for (misses = 0; misses < 4; misses++) {
+        if (haystack_end - haystack < 2)
+            return NULL;
+        haystack = (const guint8 *)memchr(haystack, c1, haystack_end - haystack - 1);
+        if (haystack == NULL)
+            return NULL;
+        if (haystack[1] == c2)
+            return haystack;
+        haystack++;
+    }
+    haystacklen = haystack_end - haystack;
+
+#ifdef HAVE_AVX2
+    if (haystacklen >= 33 && ws_memchr_use_avx2())
+        return ws_memchr_pair_avx2(haystack, haystacklen, c1, c2);
+#endif
+
+#if defined(WS_MEMCHR_SSE2)
+    if (haystacklen >= 17)
+        return ws_memchr_pair_sse2(haystack, haystacklen, c1, c2);
+#elif defined(WS_MEMCHR_NEON)
+    if (haystacklen >= 17)
+        return ws_memchr_pair_neon(haystack, haystacklen, c1, c2);
+#endif
+
+    return ws_memchr_pair_portable(haystack, haystacklen, c1, c2);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
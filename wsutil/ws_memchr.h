@@ -0,0 +1,29 @@
+/* ws_memchr.h
+ * Vectorized searches for one of two bytes, or for a pair of bytes,
+ * in a buffer.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMCHR_H__
+#define __WS_MEMCHR_H__
+
+#include "ws_symbol_export.h"
+
+/** Find the first occurrence of either c1 or c2 in the first haystacklen
+ * bytes of haystack.  Returns a pointer to the matching byte, or NULL if
+ * neither byte was found.
+ */
+WS_DLL_PUBLIC const guint8 *ws_memchr2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+
+/** Find the first occurrence of the byte c1 immediately followed by the
+ * byte c2 in the first haystacklen bytes of haystack.  Returns a pointer
+ * to the c1 byte, or NULL if the pair was not found.
+ */
+WS_DLL_PUBLIC const guint8 *ws_memchr_pair(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+
+#endif /* __WS_MEMCHR_H__ */
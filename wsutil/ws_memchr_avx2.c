@@ -0,0 +1,86 @@
+/* ws_memchr_avx2.c
+ * AVX2 versions of ws_memchr2() and ws_memchr_pair()
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <immintrin.h>
+#include "ws_memchr.h"
+#include "ws_memchr_int.h"
+#include "bits_ctz.h"
+
+#define cast_m256i(p) ((const __m256i *) (const void *) (p))
+
+gboolean
+ws_memchr_avx2_supported(void)
+{
+    return ws_cpuid_avx2() ? TRUE : FALSE;
+}
+
+const guint8 *
+ws_memchr2_avx2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const __m256i v1 = _mm256_set1_epi8((char)c1);
+    const __m256i v2 = _mm256_set1_epi8((char)c2);
+
+    while (haystack_end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(cast_m256i(p));
+        guint32 mask = (guint32)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, v1),
+                                                                     _mm256_cmpeq_epi8(chunk, v2)));
+        if (mask)
+            return p + ws_ctz(mask);
+        p += 32;
+    }
+
+    return ws_memchr2_portable(p, haystack_end - p, c1, c2);
+}
+
+const guint8 *
+ws_memchr_pair_avx2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2)
+{
+    const guint8 *p = haystack;
+    const guint8 *haystack_end = haystack + haystacklen;
+    const __m256i v1 = _mm256_set1_epi8((char)c1);
+    const __m256i v2 = _mm256_set1_epi8((char)c2);
+
+    /* Each iteration looks at 32 candidate positions, i.e. 33 bytes. */
+    while (haystack_end - p >= 33) {
+        __m256i first = _mm256_loadu_si256(cast_m256i(p));
+        __m256i second = _mm256_loadu_si256(cast_m256i(p + 1));
+        guint32 mask = (guint32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, v1),
+                                                                      _mm256_cmpeq_epi8(second, v2)));
+        if (mask)
+            return p + ws_ctz(mask);
+        p += 32;
+    }
+
+    return ws_memchr_pair_portable(p, haystack_end - p, c1, c2);
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
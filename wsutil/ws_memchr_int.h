@@ -0,0 +1,47 @@
+/* ws_memchr_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMCHR_INT_H__
+#define __WS_MEMCHR_INT_H__
+
+#include "ws_symbol_export.h"
+
+/*
+ * SSE2 is part of the x86-64 baseline and NEON is part of the AArch64
+ * baseline, so those kernels can be used unconditionally; AVX2 has to
+ * be checked for at run time.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WS_MEMCHR_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define WS_MEMCHR_NEON
+#endif
+
+/* The kernels are exported so that tvbtest can check each of them, not
+ * just the ones ws_memchr2() and ws_memchr_pair() pick. */
+WS_DLL_PUBLIC const guint8 *ws_memchr2_portable(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+WS_DLL_PUBLIC const guint8 *ws_memchr_pair_portable(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+
+#ifdef WS_MEMCHR_SSE2
+WS_DLL_PUBLIC const guint8 *ws_memchr2_sse2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+WS_DLL_PUBLIC const guint8 *ws_memchr_pair_sse2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+#endif
+
+#ifdef WS_MEMCHR_NEON
+WS_DLL_PUBLIC const guint8 *ws_memchr2_neon(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+WS_DLL_PUBLIC const guint8 *ws_memchr_pair_neon(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+#endif
+
+#ifdef HAVE_AVX2
+WS_DLL_PUBLIC gboolean ws_memchr_avx2_supported(void);
+WS_DLL_PUBLIC const guint8 *ws_memchr2_avx2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+WS_DLL_PUBLIC const guint8 *ws_memchr_pair_avx2(const guint8* haystack, size_t haystacklen, guint8 c1, guint8 c2);
+#endif
+
+#endif /* __WS_MEMCHR_INT_H__ */
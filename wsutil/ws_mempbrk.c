@@ -22,17 +22,25 @@
 #endif
 #endif
 
+#include <string.h>
+
 #include <glib.h>
 #include "ws_symbol_export.h"
 #include "ws_mempbrk.h"
 #include "ws_mempbrk_int.h"
+#include "ws_memchr.h"
 
 void
 ws_mempbrk_compile(ws_mempbrk_pattern* pattern, const gchar *needles)
 {
     const gchar *n = needles;
+
+    pattern->num_needles = 0;
     while (*n) {
         pattern->patt[(int)*n] = 1;
+        if (pattern->num_needles < G_N_ELEMENTS(pattern->needles))
+            pattern->needles[pattern->num_needles] = *n;
+        pattern->num_needles++;
         n++;
     }
 
@@ -63,6 +71,23 @@ ws_mempbrk_portable_exec(const guint8* haystack, size_t haystacklen, const ws_me
 WS_DLL_PUBLIC const guint8 *
 ws_mempbrk_exec(const guint8* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, guchar *found_needle)
 {
+    const guint8 *result;
+
+    /*
+     * Patterns with one or two needles, such as "\r\n", are common and
+     * are handled faster by memchr() and ws_memchr2() than by the
+     * general scan below.
+     */
+    if (pattern->num_needles == 1 || pattern->num_needles == 2) {
+        if (pattern->num_needles == 1)
+            result = (const guint8 *)memchr(haystack, pattern->needles[0], haystacklen);
+        else
+            result = ws_memchr2(haystack, haystacklen, pattern->needles[0], pattern->needles[1]);
+        if (result && found_needle)
+            *found_needle = *result;
+        return result;
+    }
+
 #ifdef HAVE_SSE4_2
     if (haystacklen >= 16 && pattern->use_sse42)
         return ws_mempbrk_sse42_exec(haystack, haystacklen, pattern, found_needle);